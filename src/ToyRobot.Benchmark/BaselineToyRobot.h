@@ -0,0 +1,215 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include "FacingDirection.h"
+#include "Logger.h"
+
+/// <summary>
+/// ToyRobot as it was before RobotBase: a concrete class without virtual functions, 8 bit coordinates on a 5x5 board
+/// and the log messages written by the robot itself. Kept as the baseline of the dispatch benchmarks.
+/// PLACE and REPORT also take the 64 bit coordinates of the current commanders. PLACE narrows them as the old int arguments were.
+/// </summary>
+class BaselineToyRobot
+{
+public:
+	explicit BaselineToyRobot(LoggerBase& logger)
+		: m_logger(logger)
+	{}
+
+	bool TryPlace(int64_t x, int64_t y, FacingDirection facingDirection)
+	{
+		return TryPlace(static_cast<uint8_t>(x), static_cast<uint8_t>(y), facingDirection);
+	}
+
+	bool TryPlace(uint8_t x, uint8_t y, FacingDirection facingDirection)
+	{
+		if (m_placed)
+		{
+			m_logger.Warn("Robot is already placed. Ignoring the command");
+			return false;
+		}
+
+		if (x > m_xmax)
+		{
+			m_logger.Error("Invalid x coordinate. X should be in between 0-" + std::to_string(m_xmax));
+			return false;
+		}
+
+		if (y > m_ymax)
+		{
+			m_logger.Error("Invalid y coordinate. Y should be in between 0-" + std::to_string(m_ymax));
+			return false;
+		}
+
+		m_x = x;
+		m_y = y;
+		m_facingDirection = facingDirection;
+		m_placed = true;
+
+		return true;
+	}
+
+	bool TryMove()
+	{
+		if (!m_placed)
+		{
+			m_logger.Error("Robot is not placed. Please place the robot before moving.");
+			return false;
+		}
+
+		switch (m_facingDirection)
+		{
+		case fdNORTH:
+			if (m_y + 1 > m_ymax)
+			{
+				m_logger.Warn("Robot going to move over the north edge. Command is ignored for safety.");
+				return false;
+			}
+			m_y++;
+			return true;
+		case fdSOUTH:
+			if (m_y - 1 < 0)
+			{
+				m_logger.Warn("Robot going to move over the south edge. Command is ignored for safety.");
+				return false;
+			}
+			m_y--;
+			return true;
+		case fdEAST:
+			if (m_x + 1 > m_xmax)
+			{
+				m_logger.Warn("Robot going to move over the east edge. Command is ignored for safety.");
+				return false;
+			}
+			m_x++;
+			return true;
+		case fdWEST:
+			if (m_x - 1 < 0)
+			{
+				m_logger.Warn("Robot going to move over the west edge. Command is ignored for safety.");
+				return false;
+			}
+			m_x--;
+			return true;
+		case fdUNKNOWN:
+		default:
+			m_logger.Error("Robot is facing an unknown direction.");
+			return false;
+		}
+	}
+
+	bool TryTurnLeft()
+	{
+		if (!m_placed)
+		{
+			m_logger.Error("Robot is not placed.");
+			return false;
+		}
+
+		switch (m_facingDirection)
+		{
+		case fdNORTH:
+			m_facingDirection = fdWEST;
+			m_logger.Info("Robot is now facing WEST");
+			return true;
+		case fdSOUTH:
+			m_facingDirection = fdEAST;
+			m_logger.Info("Robot is now facing EAST");
+			return true;
+		case fdEAST:
+			m_facingDirection = fdNORTH;
+			m_logger.Info("Robot is now facing NORTH");
+			return true;
+		case fdWEST:
+			m_facingDirection = fdSOUTH;
+			m_logger.Info("Robot is now facing SOUTH");
+			return true;
+		case fdUNKNOWN:
+		default:
+			m_logger.Error("Robot is now facing an unknown direction.");
+			return false;
+		}
+	}
+
+	bool TryTurnRight()
+	{
+		if (!m_placed)
+		{
+			m_logger.Error("Robot is not placed.");
+			return false;
+		}
+
+		switch (m_facingDirection)
+		{
+		case fdNORTH:
+			m_facingDirection = fdEAST;
+			m_logger.Info("Robot is now facing EAST");
+			return true;
+		case fdSOUTH:
+			m_facingDirection = fdWEST;
+			m_logger.Info("Robot is now facing WEST");
+			return true;
+		case fdEAST:
+			m_facingDirection = fdSOUTH;
+			m_logger.Info("Robot is now facing SOUTH");
+			return true;
+		case fdWEST:
+			m_facingDirection = fdNORTH;
+			m_logger.Info("Robot is now facing NORTH");
+			return true;
+		case fdUNKNOWN:
+		default:
+			m_logger.Error("Robot is now facing an unknown direction.");
+			return false;
+		}
+	}
+
+	void Report(uint8_t& x, uint8_t& y, FacingDirection& facingDirection)
+	{
+		x = m_x;
+		y = m_y;
+		facingDirection = m_facingDirection;
+	}
+
+	void ReportPosition(uint64_t& x, uint64_t& y, FacingDirection& facingDirection)
+	{
+		uint8_t x8;
+		uint8_t y8;
+		Report(x8, y8, facingDirection);
+		x = x8;
+		y = y8;
+	}
+
+private:
+	uint8_t m_x = 0;
+	uint8_t m_y = 0;
+
+	const uint8_t m_xmax = 5;
+	const uint8_t m_ymax = 5;
+
+	FacingDirection m_facingDirection = fdUNKNOWN;
+	bool m_placed = false;
+
+	LoggerBase& m_logger;
+};
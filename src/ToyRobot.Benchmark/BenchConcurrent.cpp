@@ -0,0 +1,140 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmarks.h"
+#include "ConcurrentToyRobot.h"
+#include <mutex>
+#include <thread>
+
+namespace
+{
+	class NullLogger : public LoggerBase
+	{
+	protected:
+		void Print(std::string_view /*msgType*/, std::string_view /*msg*/, std::string_view /*end*/) override
+		{
+		}
+	};
+
+	const uint64_t BoardSize = 999;
+	const size_t OperationsPerThread = 1 << 16;
+
+	/// <summary>
+	/// ToyRobot behind a mutex, the straightforward way of sharing it.
+	/// </summary>
+	class MutexToyRobot
+	{
+	public:
+		explicit MutexToyRobot(LoggerBase& logger)
+			: m_robot(logger, RuntimeBoard(BoardSize, BoardSize))
+		{}
+
+		RobotResult Place(int64_t x, int64_t y, FacingDirection facingDirection)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_robot.Place(x, y, facingDirection);
+		}
+
+		RobotResult Move()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_robot.Move();
+		}
+
+		RobotResult TurnLeft(FacingDirection& facingDirection)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			const auto result = m_robot.TurnLeft();
+			facingDirection = m_robot.SaveState().facingDirection;
+			return result;
+		}
+
+		void ReportPosition(uint64_t& x, uint64_t& y, FacingDirection& facingDirection)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_robot.ReportPosition(x, y, facingDirection);
+		}
+
+	private:
+		std::mutex m_mutex;
+		RuntimeToyRobot m_robot;
+	};
+
+	/// <summary>
+	/// Every thread walks the robot around a unit square and reports it, all on the same shared robot.
+	/// </summary>
+	template <typename TRobot>
+	uint64_t RunShared(TRobot& robot, size_t threadCount)
+	{
+		std::vector<std::thread> threads;
+		for (size_t idx = 0; idx < threadCount; idx++)
+		{
+			threads.emplace_back([&robot]() {
+				uint64_t sum = 0;
+				for (size_t op = 0; op < OperationsPerThread; op += 4)
+				{
+					uint64_t x;
+					uint64_t y;
+					FacingDirection facingDirection;
+					sum += robot.Move();
+					sum += robot.TurnLeft(facingDirection);
+					sum += robot.Move();
+					robot.ReportPosition(x, y, facingDirection);
+					sum += x + y;
+				}
+				DoNotOptimize(sum);
+			});
+		}
+
+		for (auto& thread : threads)
+			thread.join();
+
+		return threadCount * OperationsPerThread;
+	}
+}
+
+void RunConcurrentBenchmarks(BenchmarkRunner& runner)
+{
+	NullLogger logger;
+	const size_t threadCounts[] = { 1, 2, 4, 8 };
+
+	for (const auto threadCount : threadCounts)
+	{
+		const auto suffix = "/threads=" + std::to_string(threadCount);
+
+		if (runner.IsSelected("concurrent/cas_word" + suffix))
+		{
+			RuntimeConcurrentToyRobot robot(logger, RuntimeBoard(BoardSize, BoardSize));
+			robot.Place(BoardSize / 2, BoardSize / 2, fdNORTH);
+			runner.Run("concurrent/cas_word" + suffix, [&]() {
+				return RunShared(robot, threadCount);
+			});
+		}
+
+		if (runner.IsSelected("concurrent/mutex" + suffix))
+		{
+			MutexToyRobot robot(logger);
+			robot.Place(BoardSize / 2, BoardSize / 2, fdNORTH);
+			runner.Run("concurrent/mutex" + suffix, [&]() {
+				return RunShared(robot, threadCount);
+			});
+		}
+	}
+}
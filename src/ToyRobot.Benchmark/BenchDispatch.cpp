@@ -0,0 +1,104 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmarks.h"
+#include "BaselineToyRobot.h"
+#include "Commander.h"
+#include "ToyRobot.h"
+#include <iterator>
+
+namespace
+{
+	class NullLogger : public LoggerBase
+	{
+	protected:
+		void Print(std::string_view /*msgType*/, std::string_view /*msg*/, std::string_view /*end*/) override
+		{
+		}
+	};
+
+	const size_t Iterations = 1 << 16;
+
+	/// <summary>
+	/// A PLACE followed by laps around a square, so that every command succeeds, and a REPORT after every lap.
+	/// </summary>
+	const std::string_view s_place = "PLACE 1,2,NORTH";
+	const std::string_view s_lap[] = { "MOVE", "RIGHT", "MOVE", "RIGHT", "MOVE", "RIGHT", "MOVE", "RIGHT", "REPORT" };
+
+	/// <summary>
+	/// Commander reading the given number of lines of the script, without a prompt.
+	/// </summary>
+	class LapCommander : public CommanderBase
+	{
+	public:
+		LapCommander(RobotRef robot, LoggerBase& logger, size_t lines)
+			: CommanderBase(robot, logger),
+			m_lines(lines)
+		{}
+
+	protected:
+		bool TryReadLine(std::string_view& input) override
+		{
+			if (m_next == m_lines)
+				return false;
+
+			input = m_next == 0 ? s_place : s_lap[(m_next - 1) % std::size(s_lap)];
+			m_next++;
+			return true;
+		}
+
+		bool ShowsPrompt() const override { return false; }
+
+	private:
+		size_t m_lines;
+		size_t m_next = 0;
+	};
+
+	template <typename TRobot, typename TCommanderRobot>
+	void RunLaps(BenchmarkRunner& runner, const std::string& name, LogLevel level)
+	{
+		runner.Run(name, [&]() {
+			NullLogger logger;
+			logger.SetLevel(level);
+			TRobot robot(logger);
+			LapCommander commander(static_cast<TCommanderRobot&>(robot), logger, Iterations);
+			commander.Launch();
+
+			return static_cast<uint64_t>(Iterations);
+		});
+	}
+}
+
+void RunDispatchBenchmarks(BenchmarkRunner& runner)
+{
+	for (const auto level : { llINFO, llWARN })
+	{
+		const std::string suffix = level == llINFO ? "/info" : "/warn";
+
+		// The default robot called directly, as the commanders drive it.
+		RunLaps<ToyRobot, ToyRobot>(runner, "dispatch/commander/toy_robot" + suffix, level);
+
+		// The same robot through the RobotBase virtuals.
+		RunLaps<ToyRobot, RobotBase>(runner, "dispatch/commander/robot_base" + suffix, level);
+
+		// The robot before RobotBase, without any virtual functions.
+		RunLaps<BaselineToyRobot, BaselineToyRobot>(runner, "dispatch/commander/baseline_robot" + suffix, level);
+	}
+}
@@ -0,0 +1,116 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmarks.h"
+#include "Commander.h"
+#include "PipelinedCommander.h"
+#include "ToyRobot.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	/// <summary>
+	/// Script of the given number of lines: mostly MOVE and turns, a PLACE every 1000 lines, a REPORT every 250
+	/// and an invalid line every 500, so that every logging path is taken.
+	/// </summary>
+	void WriteScript(const fs::path& path, uint64_t lines)
+	{
+		static const char* const commands[] = { "MOVE", "MOVE", "MOVE", "LEFT", "RIGHT", "MOVE", "MOVE", "RIGHT" };
+
+		std::mt19937 random(31);
+		std::ofstream file(path, std::ios::binary);
+		for (uint64_t idx = 0; idx < lines; idx++)
+		{
+			if (idx % 1000 == 0)
+				file << "PLACE " << random() % 6 << "," << random() % 6 << ",NORTH\n";
+			else if (idx % 500 == 0)
+				file << "JUMP\n";
+			else if (idx % 250 == 0)
+				file << "REPORT\n";
+			else
+				file << commands[random() % 8] << "\n";
+		}
+	}
+
+	std::string PowerOfTenName(uint64_t lines)
+	{
+		auto exponent = 0;
+		for (; lines >= 10; lines /= 10)
+			exponent++;
+
+		return "10^" + std::to_string(exponent);
+	}
+}
+
+void RunEndToEndBenchmarks(BenchmarkRunner& runner, uint64_t maxLines)
+{
+	const auto scriptPath = fs::temp_directory_path() / "toyrobot_bench_e2e.txt";
+	const auto outputPath = fs::temp_directory_path() / "toyrobot_bench_e2e.out";
+
+	for (uint64_t lines = 1000; lines <= maxLines; lines *= 10)
+	{
+		const auto size = PowerOfTenName(lines);
+		const auto infoName = "end_to_end/file_commander/" + size;
+		const auto warnName = "end_to_end/file_commander_warn/" + size;
+		const auto pipelinedName = "end_to_end/pipelined/" + size;
+		if (!runner.IsSelected(infoName) && !runner.IsSelected(warnName) && !runner.IsSelected(pipelinedName))
+			continue;
+
+		WriteScript(scriptPath, lines);
+
+		// The same path as "toyrobot.exe commands.txt output.txt": mapped input, output file written in the background.
+		const std::pair<std::string, LogLevel> variants[] = { { infoName, llINFO }, { warnName, llWARN } };
+		for (const auto& variant : variants)
+		{
+			runner.Run(variant.first, [&]() {
+				{
+					fs::remove(outputPath);
+					FileLogger logger(outputPath.string());
+					logger.SetLevel(variant.second);
+					ToyRobot robot(logger);
+					FileCommander commander(scriptPath.string(), robot, logger);
+					commander.Launch();
+				}
+
+				return lines;
+			});
+		}
+
+		// "toyrobot.exe --pipeline commands.txt output.txt": reader, parser, executor and writer threads.
+		runner.Run(pipelinedName, [&]() {
+			{
+				fs::remove(outputPath);
+				FileLogger logger(outputPath.string());
+				ToyRobot robot(logger);
+				PipelinedCommander commander(scriptPath.string(), robot, logger);
+				commander.Launch();
+			}
+
+			return lines;
+		});
+	}
+
+	fs::remove(scriptPath);
+	fs::remove(outputPath);
+}
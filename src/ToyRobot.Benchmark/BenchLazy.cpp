@@ -0,0 +1,91 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmarks.h"
+#include "CommandProgram.h"
+#include <random>
+
+namespace
+{
+	class NullLogger : public LoggerBase
+	{
+	protected:
+		void Print(std::string_view /*msgType*/, std::string_view /*msg*/, std::string_view /*end*/) override
+		{
+		}
+	};
+
+	/// <summary>
+	/// Planner style script: long runs of MOVE and of LEFT/RIGHT pairs, with a REPORT now and then.
+	/// </summary>
+	CommandProgram MakeRunProgram(size_t runs, size_t runLength)
+	{
+		std::mt19937 random(13);
+		std::uniform_int_distribution<int> kind(0, 3);
+
+		CommandProgram program;
+		program.CompileLine("PLACE 0,0,NORTH");
+		for (size_t run = 0; run < runs; run++)
+		{
+			switch (kind(random))
+			{
+			case 0:
+				program.CompileLine("REPORT");
+				break;
+			case 1:
+				for (size_t idx = 0; idx < runLength; idx++)
+					program.CompileLine(idx % 2 == 0 ? "LEFT" : "RIGHT");
+				program.CompileLine("RIGHT");
+				break;
+			default:
+				for (size_t idx = 0; idx < runLength; idx++)
+					program.CompileLine("MOVE");
+				break;
+			}
+		}
+
+		return program;
+	}
+}
+
+void RunLazyBenchmarks(BenchmarkRunner& runner)
+{
+	const auto program = MakeRunProgram(1024, 1000);
+
+	for (const auto lazy : { false, true })
+	{
+		for (const auto level : { llERROR, llNONE })
+		{
+			const std::string name = std::string(lazy ? "runs/lazy" : "runs/stepwise") + (level == llNONE ? "_quiet" : "_errors");
+			runner.Run(name, [&]() {
+				NullLogger logger;
+				logger.SetLevel(level);
+				ToyRobot robot(logger);
+				ProgramRunner programRunner(robot, logger);
+				if (lazy)
+					programRunner.RunLazy(program);
+				else
+					programRunner.Run(program);
+
+				return static_cast<uint64_t>(program.CommandCount());
+			});
+		}
+	}
+}
@@ -0,0 +1,85 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmarks.h"
+#include "LockstepRunner.h"
+#include <random>
+
+namespace
+{
+	/// <summary>
+	/// Random programs of the given lengths, each after a leading PLACE.
+	/// </summary>
+	std::vector<CommandProgram> MakeRandomPrograms(const std::vector<size_t>& lengths)
+	{
+		static const char* const lines[] = { "MOVE", "MOVE", "LEFT", "RIGHT", "REPORT", "PLACE 2,2,NORTH" };
+
+		std::mt19937 random(5);
+		std::uniform_int_distribution<size_t> line(0, 5);
+
+		std::vector<CommandProgram> programs(lengths.size());
+		for (size_t program = 0; program < programs.size(); program++)
+		{
+			programs[program].CompileLine("PLACE 0,0,NORTH");
+			for (size_t idx = 0; idx < lengths[program]; idx++)
+				programs[program].CompileLine(lines[line(random)]);
+		}
+
+		return programs;
+	}
+}
+
+void RunLockstepBenchmarks(BenchmarkRunner& runner)
+{
+	// Programs of equal length, and one long program among many short ones.
+	std::vector<size_t> mixed(4096, 4);
+	mixed[0] = 65536;
+
+	const std::pair<const char*, std::vector<size_t>> sets[] = {
+		{ "uniform", std::vector<size_t>(4096, 256) }, { "mixed", mixed }
+	};
+
+	const std::pair<SimdLevel, const char*> levels[] = {
+		{ slSCALAR, "lockstep/scalar" }, { slSSE41, "lockstep/sse41" }, { slAVX2, "lockstep/avx2" }
+	};
+
+	for (const auto& set : sets)
+	{
+		const auto programs = MakeRandomPrograms(set.second);
+
+		uint64_t commands = 0;
+		for (const auto length : set.second)
+			commands += length + 1;
+
+		for (const auto& level : levels)
+		{
+			LockstepRunner lockstep(level.first);
+			if (lockstep.Level() != level.first)
+				continue;
+
+			runner.Run(std::string(level.second) + "/" + set.first, [&]() {
+				std::vector<std::vector<std::string>> reports;
+				lockstep.Run(programs, reports);
+				DoNotOptimize(reports.size());
+				return commands;
+			});
+		}
+	}
+}
@@ -0,0 +1,103 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmarks.h"
+#include "Logger.h"
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	const size_t Records = 1 << 16;
+
+	/// <summary>
+	/// Stream buffer accepting and dropping everything, so that the console logger can be timed without a terminal.
+	/// </summary>
+	class NullStreamBuffer : public std::streambuf
+	{
+	protected:
+		int_type overflow(int_type c) override { return c; }
+		std::streamsize xsputn(const char* /*s*/, std::streamsize count) override { return count; }
+	};
+
+	/// <summary>
+	/// Log a mix of the messages of a robot run: mostly turns, some warnings and a report now and then.
+	/// </summary>
+	uint64_t LogRecords(LoggerBase& logger)
+	{
+		for (size_t idx = 0; idx < Records; idx++)
+		{
+			if (idx % 16 == 0)
+				logger.Output("Output: 1,2,NORTH");
+			else if (idx % 4 == 0)
+				logger.Warn("Robot going to move over the north edge. Command is ignored for safety.");
+			else
+				logger.Info("Robot is now facing EAST");
+		}
+
+		return Records;
+	}
+}
+
+void RunLoggerBenchmarks(BenchmarkRunner& runner)
+{
+	if (runner.IsSelected("logging/console"))
+	{
+		NullStreamBuffer nullBuffer;
+		const auto previous = std::cout.rdbuf(&nullBuffer);
+
+		ConsoleLogger logger;
+		runner.Run("logging/console/info", [&]() {
+			return LogRecords(logger);
+		});
+
+		logger.SetLevel(llNONE);
+		runner.Run("logging/console/level_none", [&]() {
+			return LogRecords(logger);
+		});
+
+		std::cout.rdbuf(previous);
+	}
+
+	if (runner.IsSelected("logging/file"))
+	{
+		const auto path = fs::temp_directory_path() / "toyrobot_bench_log.txt";
+
+		// The logger is destroyed in the body, so the time includes writing every record to the file.
+		const std::pair<const char*, FileLoggerOptions> variants[] = {
+			{ "logging/file/flush_100ms", FileLoggerOptions() },
+			{ "logging/file/flush_1024_records", { fpEVERY_N_RECORDS, 1024, 100, 8192, qfBLOCK } },
+			{ "logging/file/drop_when_full", { fpEVERY_T_MILLISECONDS, 1024, 100, 8192, qfDROP } }
+		};
+
+		for (const auto& variant : variants)
+		{
+			runner.Run(variant.first, [&]() {
+				fs::remove(path);
+				FileLogger logger(path.string(), variant.second);
+				return LogRecords(logger);
+			});
+		}
+
+		fs::remove(path);
+	}
+}
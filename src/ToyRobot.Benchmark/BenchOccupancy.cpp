@@ -0,0 +1,130 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmarks.h"
+#include "ToyRobot.h"
+#include <random>
+
+namespace
+{
+	class NullLogger : public LoggerBase
+	{
+	protected:
+		void Print(std::string_view /*msgType*/, std::string_view /*msg*/, std::string_view /*end*/) override
+		{
+		}
+	};
+
+	const uint64_t MaxCoordinate = 9999;
+	const size_t RobotCount = 1000000;
+
+	struct RobotStep
+	{
+		uint32_t robot;
+		uint8_t command;
+	};
+
+	/// <summary>
+	/// Random MOVE, LEFT and RIGHT commands of random robots, so that every step touches a cold cache line.
+	/// </summary>
+	std::vector<RobotStep> MakeRandomSteps(size_t count)
+	{
+		std::mt19937 random(11);
+		std::uniform_int_distribution<uint32_t> robot(0, RobotCount - 1);
+		std::uniform_int_distribution<int> command(cmdMOVE, cmdTURN_RIGHT);
+
+		std::vector<RobotStep> steps(count);
+		for (auto& step : steps)
+			step = { robot(random), static_cast<uint8_t>(command(random)) };
+
+		return steps;
+	}
+
+	/// <summary>
+	/// Place every robot on a random free cell.
+	/// </summary>
+	template <typename TRobot, typename TIndex>
+	std::vector<TRobot> PlaceRobots(LoggerBase& logger, TIndex& index)
+	{
+		std::mt19937 random(3);
+		std::uniform_int_distribution<int64_t> coordinate(0, MaxCoordinate);
+		const RuntimeBoard board(MaxCoordinate, MaxCoordinate);
+
+		std::vector<TRobot> robots;
+		robots.reserve(RobotCount);
+		for (size_t idx = 0; idx < RobotCount; idx++)
+		{
+			robots.emplace_back(logger, board, SharedOccupancy<TIndex>(index));
+			while (robots.back().Place(coordinate(random), coordinate(random), fdNORTH) != rrSUCCESS)
+				;
+		}
+
+		return robots;
+	}
+
+	template <typename TRobot>
+	uint64_t Replay(std::vector<TRobot>& robots, const std::vector<RobotStep>& steps)
+	{
+		uint64_t failures = 0;
+		for (const auto& step : steps)
+		{
+			auto& robot = robots[step.robot];
+
+			RobotResult result;
+			switch (step.command)
+			{
+			case cmdMOVE: result = robot.Move(); break;
+			case cmdTURN_LEFT: result = robot.TurnLeft(); break;
+			default: result = robot.TurnRight(); break;
+			}
+			failures += result != rrSUCCESS;
+		}
+
+		DoNotOptimize(failures);
+		return steps.size();
+	}
+}
+
+void RunOccupancyBenchmarks(BenchmarkRunner& runner)
+{
+	const auto steps = MakeRandomSteps(1 << 20);
+	NullLogger logger;
+
+	if (runner.IsSelected("occupancy/dense_bitset"))
+	{
+		DenseOccupancy index(MaxCoordinate, MaxCoordinate);
+		auto robots = PlaceRobots<DenseSharedToyRobot>(logger, index);
+
+		runner.Run("occupancy/dense_bitset", [&]() {
+			return Replay(robots, steps);
+		});
+	}
+
+	if (runner.IsSelected("occupancy/sparse_hash"))
+	{
+		SparseOccupancy index;
+		index.Reserve(RobotCount);
+		auto robots = PlaceRobots<SparseSharedToyRobot>(logger, index);
+
+		runner.Run("occupancy/sparse_hash", [&]() {
+			return Replay(robots, steps);
+		});
+	}
+}
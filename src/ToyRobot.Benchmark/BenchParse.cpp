@@ -0,0 +1,151 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmarks.h"
+#include "Commander.h"
+#include "ToyRobot.h"
+
+namespace
+{
+	class NullLogger : public LoggerBase
+	{
+	protected:
+		void Print(std::string_view /*msgType*/, std::string_view /*msg*/, std::string_view /*end*/) override
+		{
+		}
+	};
+
+	const size_t Iterations = 1 << 16;
+
+	/// <summary>
+	/// Commander reading the same line over and over, so that GetCommand can be timed on its own.
+	/// </summary>
+	class RepeatCommander : public CommanderBase
+	{
+	public:
+		RepeatCommander(RobotRef robot, LoggerBase& logger, std::string_view line)
+			: CommanderBase(robot, logger),
+			m_line(line)
+		{}
+
+		using CommanderBase::GetCommand;
+
+	protected:
+		bool TryReadLine(std::string_view& input) override
+		{
+			input = m_line;
+			return true;
+		}
+
+	private:
+		std::string_view m_line;
+	};
+}
+
+void RunParseBenchmarks(BenchmarkRunner& runner)
+{
+	NullLogger logger;
+	ToyRobot robot(logger);
+
+	const std::pair<const char*, std::string_view> commands[] = {
+		{ "place", "PLACE 1,2,NORTH" },
+		{ "move", "MOVE" },
+		{ "left", "LEFT" },
+		{ "right", "RIGHT" },
+		{ "report", "REPORT" },
+		{ "exit", "EXIT" },
+		{ "lower_case", "move" },
+		{ "unknown", "JUMP 3" }
+	};
+
+	for (const auto& command : commands)
+	{
+		RepeatCommander commander(robot, logger, command.second);
+		runner.Run(std::string("parse/get_command/") + command.first, [&]() {
+			uint64_t sum = 0;
+			std::string_view args;
+			for (size_t idx = 0; idx < Iterations; idx++)
+				sum += commander.GetCommand(args) + args.size();
+
+			DoNotOptimize(sum);
+			return static_cast<uint64_t>(Iterations);
+		});
+	}
+
+	struct SplitCase
+	{
+		const char* name;
+		std::string_view text;
+		char delimiter;
+	};
+
+	const SplitCase splits[] = {
+		{ "place_args", "1,2,NORTH", ',' },
+		{ "spaces", "  PLACE   1,2,NORTH  ", ' ' },
+		{ "too_many", "1,2,3,4,5,6,7,8", ',' }
+	};
+
+	for (const auto& split : splits)
+	{
+		runner.Run(std::string("parse/split/") + split.name, [&]() {
+			uint64_t sum = 0;
+			std::string_view tokens[3];
+			for (size_t idx = 0; idx < Iterations; idx++)
+				sum += CommanderBase::Split(split.text, split.delimiter, tokens, 3) + tokens[0].size();
+
+			DoNotOptimize(sum);
+			return static_cast<uint64_t>(Iterations);
+		});
+	}
+
+	const std::pair<const char*, std::string_view> integers[] = {
+		{ "digit", "4" },
+		{ "plus_sign", "+42" },
+		{ "large", "9223372036854775807" },
+		{ "out_of_range", "99999999999999999999" },
+		{ "invalid", "4x" }
+	};
+
+	for (const auto& integer : integers)
+	{
+		runner.Run(std::string("parse/try_parse_int/") + integer.first, [&]() {
+			uint64_t sum = 0;
+			for (size_t idx = 0; idx < Iterations; idx++)
+			{
+				int64_t value = 0;
+				sum += CommanderBase::TryParseInt(integer.second, value) + static_cast<uint64_t>(value);
+			}
+
+			DoNotOptimize(sum);
+			return static_cast<uint64_t>(Iterations);
+		});
+	}
+
+	runner.Run("parse/try_parse_place", [&]() {
+		uint64_t sum = 0;
+		PlaceArgs place;
+		std::string error;
+		for (size_t idx = 0; idx < Iterations; idx++)
+			sum += CommanderBase::TryParsePlace(" 1,2,NORTH", place, error) + place.facingDirection;
+
+		DoNotOptimize(sum);
+		return static_cast<uint64_t>(Iterations);
+	});
+}
@@ -0,0 +1,113 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmarks.h"
+#include "RobotFleet.h"
+#include "SwitchToyRobot.h"
+#include "ToyRobot.h"
+#include <random>
+
+namespace
+{
+	class NullLogger : public LoggerBase
+	{
+	protected:
+		void Print(std::string_view /*msgType*/, std::string_view /*msg*/, std::string_view /*end*/) override
+		{
+		}
+	};
+
+	/// <summary>
+	/// Random MOVE, LEFT and RIGHT commands, so that the facing direction is not predictable.
+	/// </summary>
+	std::vector<uint8_t> MakeRandomSteps(size_t count)
+	{
+		std::mt19937 random(42);
+		std::uniform_int_distribution<int> command(cmdMOVE, cmdTURN_RIGHT);
+
+		std::vector<uint8_t> steps(count);
+		for (auto& step : steps)
+			step = static_cast<uint8_t>(command(random));
+
+		return steps;
+	}
+
+	template <typename TRobot>
+	uint64_t Replay(TRobot& robot, const std::vector<uint8_t>& steps)
+	{
+		uint64_t failures = 0;
+		for (const auto step : steps)
+		{
+			RobotResult result;
+			switch (step)
+			{
+			case cmdMOVE: result = robot.Move(); break;
+			case cmdTURN_LEFT: result = robot.TurnLeft(); break;
+			default: result = robot.TurnRight(); break;
+			}
+			failures += result != rrSUCCESS;
+		}
+
+		DoNotOptimize(failures);
+		return steps.size();
+	}
+}
+
+void RunTransitionBenchmarks(BenchmarkRunner& runner)
+{
+	const auto steps = MakeRandomSteps(1 << 20);
+
+	runner.Run("transitions/switch", [&]() {
+		SwitchToyRobot robot;
+		robot.Place(2, 2, fdNORTH);
+		return Replay(robot, steps);
+	});
+
+	runner.Run("transitions/table", [&]() {
+		NullLogger logger;
+		ToyRobot robot(logger);
+		robot.Place(2, 2, fdNORTH);
+		return Replay(robot, steps);
+	});
+
+	runner.Run("transitions/table_runtime_board", [&]() {
+		NullLogger logger;
+		RuntimeToyRobot robot(logger, RuntimeBoard(DefaultBoard::MaxX(), DefaultBoard::MaxY()));
+		robot.Place(2, 2, fdNORTH);
+		return Replay(robot, steps);
+	});
+
+	const size_t fleetSize = 1 << 16;
+	const size_t fleetSteps = steps.size() / fleetSize;
+	RobotFleet fleet(fleetSize);
+	{
+		std::vector<uint8_t> xs(fleetSize, 2), ys(fleetSize, 2), facingDirections(fleetSize, fdNORTH), results(fleetSize);
+		fleet.Place(xs.data(), ys.data(), facingDirections.data(), results.data());
+	}
+
+	runner.Run("transitions/fleet_step", [&]() {
+		std::vector<uint8_t> results(fleetSize);
+		for (size_t step = 0; step < fleetSteps; step++)
+			fleet.Step(steps.data() + step * fleetSize, results.data());
+
+		DoNotOptimize(results[0]);
+		return static_cast<uint64_t>(fleetSteps * fleetSize);
+	});
+}
@@ -0,0 +1,131 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmarks.h"
+#include "LineScanner.h"
+#include "ToyRobot.h"
+#include "TrbFile.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	class NullLogger : public LoggerBase
+	{
+	protected:
+		void Print(std::string_view /*msgType*/, std::string_view /*msg*/, std::string_view /*end*/) override
+		{
+		}
+	};
+
+	const size_t ScriptCommands = 1000000;
+
+	/// <summary>
+	/// Replay style script: mostly MOVE and turns, with a PLACE or REPORT now and then.
+	/// </summary>
+	void WriteScript(const fs::path& path)
+	{
+		static const char* const lines[] = { "MOVE", "MOVE", "MOVE", "LEFT", "RIGHT", "MOVE", "MOVE", "RIGHT" };
+
+		std::mt19937 random(29);
+		std::ofstream file(path, std::ios::binary);
+		for (size_t idx = 0; idx < ScriptCommands; idx++)
+		{
+			if (idx % 1000 == 0)
+				file << "PLACE " << random() % 6 << "," << random() % 6 << ",NORTH\n";
+			else if (idx % 250 == 0)
+				file << "REPORT\n";
+			else
+				file << lines[random() % 8] << "\n";
+		}
+	}
+}
+
+void RunTrbBenchmarks(BenchmarkRunner& runner)
+{
+	if (!runner.IsSelected("formats/"))
+		return;
+
+	const auto textPath = fs::temp_directory_path() / "toyrobot_bench_script.txt";
+	const auto trbPath = fs::temp_directory_path() / "toyrobot_bench_script.trb";
+	WriteScript(textPath);
+
+	TrbConversion conversion;
+	std::string error;
+	if (!TryConvertToTrb(textPath.string(), trbPath.string(), 5, 5, conversion, error))
+		return;
+
+	runner.Run("formats/text_parse", [&]() {
+		MappedFile file;
+		file.TryOpen(textPath.string());
+		LineScanner scanner(file.Data(), file.Data() + file.Size());
+
+		uint64_t sum = 0;
+		std::string_view line;
+		std::string_view args;
+		while (scanner.TryNextLine(line))
+			sum += CommanderBase::ParseCommand(line, args);
+
+		DoNotOptimize(sum);
+		return static_cast<uint64_t>(ScriptCommands);
+	});
+
+	runner.Run("formats/trb_decode", [&]() {
+		MappedFile file;
+		file.TryOpen(trbPath.string());
+		TrbReader reader;
+		TrbHeader header;
+		reader.TryOpen(file.Data(), file.Data() + file.Size(), header);
+
+		uint64_t sum = 0;
+		PlaceArgs place;
+		std::string_view args;
+		bool placeIsValid;
+		while (!reader.AtEnd())
+			sum += reader.Next(place, args, placeIsValid);
+
+		DoNotOptimize(sum);
+		return static_cast<uint64_t>(ScriptCommands);
+	});
+
+	runner.Run("formats/text_commander", [&]() {
+		NullLogger logger;
+		logger.SetLevel(llNONE);
+		ToyRobot robot(logger);
+		FileCommander commander(textPath.string(), robot, logger);
+		commander.Launch();
+		return static_cast<uint64_t>(ScriptCommands);
+	});
+
+	runner.Run("formats/trb_commander", [&]() {
+		NullLogger logger;
+		logger.SetLevel(llNONE);
+		ToyRobot robot(logger);
+		TrbCommander commander(trbPath.string(), robot, logger);
+		commander.Launch();
+		return static_cast<uint64_t>(ScriptCommands);
+	});
+
+	fs::remove(textPath);
+	fs::remove(trbPath);
+}
@@ -0,0 +1,46 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Benchmark.h"
+#include <iomanip>
+
+void BenchmarkRunner::PrintTable(std::ostream& out) const
+{
+	out << std::left << std::setw(40) << "Benchmark" << std::right << std::setw(16) << "Operations" << std::setw(12) << "ns/op" << "\n";
+	for (const auto& result : m_results)
+	{
+		out << std::left << std::setw(40) << result.name
+			<< std::right << std::setw(16) << result.operations
+			<< std::setw(12) << std::fixed << std::setprecision(3) << result.NanosecondsPerOperation() << "\n";
+	}
+}
+
+void BenchmarkRunner::PrintJson(std::ostream& out) const
+{
+	out << "{\n  \"benchmarks\": [";
+	for (size_t idx = 0; idx < m_results.size(); idx++)
+	{
+		const auto& result = m_results[idx];
+		out << (idx == 0 ? "\n" : ",\n")
+			<< "    { \"name\": \"" << result.name << "\", \"operations\": " << result.operations
+			<< ", \"seconds\": " << result.seconds << ", \"ns_per_op\": " << result.NanosecondsPerOperation() << " }";
+	}
+	out << "\n  ]\n}\n";
+}
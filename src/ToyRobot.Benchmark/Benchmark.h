@@ -0,0 +1,107 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Keep the compiler from optimising away a value that is only computed for the benchmark.
+/// </summary>
+inline volatile uint64_t g_benchmarkSink = 0;
+
+inline void DoNotOptimize(uint64_t value)
+{
+	g_benchmarkSink = value;
+}
+
+struct BenchmarkResult
+{
+	std::string name;
+	uint64_t operations;
+	double seconds;
+
+	double NanosecondsPerOperation() const { return operations == 0 ? 0 : seconds * 1e9 / operations; }
+};
+
+/// <summary>
+/// Minimal benchmark harness. Each benchmark is repeated until it has run for the minimum time,
+/// then the average time per operation is reported.
+/// </summary>
+class BenchmarkRunner
+{
+public:
+	/// <summary>
+	/// Create a runner.
+	/// </summary>
+	/// <param name="filter">Only benchmarks with this text in their name are run. Empty runs all</param>
+	/// <param name="minSeconds">Minimum time spent in each benchmark</param>
+	BenchmarkRunner(std::string filter, double minSeconds)
+		: m_filter(std::move(filter)),
+		m_minSeconds(minSeconds)
+	{}
+
+	/// <summary>
+	/// Whether the benchmark passes the filter. Lets expensive setup be skipped for filtered out benchmarks.
+	/// </summary>
+	bool IsSelected(const std::string& name) const
+	{
+		return m_filter.empty() || name.find(m_filter) != std::string::npos;
+	}
+
+	/// <summary>
+	/// Run a benchmark.
+	/// </summary>
+	/// <param name="name">Name of the benchmark</param>
+	/// <param name="body">Callable doing one iteration. Returns the number of operations it did</param>
+	template <typename TBody>
+	void Run(const std::string& name, TBody&& body)
+	{
+		if (!IsSelected(name))
+			return;
+
+		// Warm up caches and branch predictors once before measuring.
+		DoNotOptimize(body());
+
+		BenchmarkResult result{ name, 0, 0 };
+		const auto start = std::chrono::steady_clock::now();
+		do
+		{
+			result.operations += body();
+			result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		} while (result.seconds < m_minSeconds);
+
+		m_results.push_back(result);
+	}
+
+	void PrintTable(std::ostream& out) const;
+	void PrintJson(std::ostream& out) const;
+
+	const std::vector<BenchmarkResult>& Results() const { return m_results; }
+
+private:
+	std::string m_filter;
+	double m_minSeconds;
+	std::vector<BenchmarkResult> m_results;
+};
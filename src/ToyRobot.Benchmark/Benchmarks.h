@@ -0,0 +1,74 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "Benchmark.h"
+
+/// <summary>
+/// ToyRobot state machine: switch baseline against the transition tables, and the fleet engine.
+/// </summary>
+void RunTransitionBenchmarks(BenchmarkRunner& runner);
+
+/// <summary>
+/// Lockstep execution of many small programs, per SIMD level supported by the CPU.
+/// </summary>
+void RunLockstepBenchmarks(BenchmarkRunner& runner);
+
+
+/// <summary>
+/// Collision checks of 10^6 robots sharing a 10^4 x 10^4 board, with the bitset and the hash set index.
+/// </summary>
+void RunOccupancyBenchmarks(BenchmarkRunner& runner);
+
+/// <summary>
+/// Compiled programs with long runs of MOVE and turn commands, run step by step and lazily.
+/// </summary>
+void RunLazyBenchmarks(BenchmarkRunner& runner);
+
+/// <summary>
+/// Reading a 10^6 command script from the text file and from the binary (.trb) file.
+/// </summary>
+void RunTrbBenchmarks(BenchmarkRunner& runner);
+
+/// <summary>
+/// Threads sharing one robot: the packed word updated by compare and swap against a ToyRobot behind a mutex.
+/// </summary>
+void RunConcurrentBenchmarks(BenchmarkRunner& runner);
+
+/// <summary>
+/// Parsing of single lines: GetCommand per command type, Split, TryParseInt and TryParsePlace.
+/// </summary>
+void RunParseBenchmarks(BenchmarkRunner& runner);
+
+/// <summary>
+/// Commands through CommanderBase: the default ToyRobot called directly and through RobotBase, and the robot before RobotBase.
+/// </summary>
+void RunDispatchBenchmarks(BenchmarkRunner& runner);
+
+/// <summary>
+/// Records per second of the console logger, writing to a discarding stream, and of the file logger.
+/// </summary>
+void RunLoggerBenchmarks(BenchmarkRunner& runner);
+
+/// <summary>
+/// FileCommander::Launch on generated scripts of 10^3 lines up to maxLines, logging to an output file.
+/// </summary>
+void RunEndToEndBenchmarks(BenchmarkRunner& runner, uint64_t maxLines);
@@ -0,0 +1,129 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "FacingDirection.h"
+#include "RobotResult.h"
+
+/// <summary>
+/// The switch based state machine that ToyRobot used before the transition tables.
+/// Kept as the baseline of the transition benchmarks.
+/// </summary>
+class SwitchToyRobot
+{
+public:
+	RobotResult Place(uint8_t x, uint8_t y, FacingDirection facingDirection)
+	{
+		if (m_placed)
+			return rrALREADY_PLACED;
+
+		if (x > m_xmax)
+			return rrINVALID_X;
+
+		if (y > m_ymax)
+			return rrINVALID_Y;
+
+		m_x = x;
+		m_y = y;
+		m_facingDirection = facingDirection;
+		m_placed = true;
+
+		return rrSUCCESS;
+	}
+
+	RobotResult Move()
+	{
+		if (!m_placed)
+			return rrNOT_PLACED;
+
+		switch (m_facingDirection)
+		{
+		case fdNORTH:
+			if (m_y + 1 > m_ymax)
+				return rrNORTH_EDGE;
+			m_y++;
+			return rrSUCCESS;
+		case fdSOUTH:
+			if (m_y - 1 < 0)
+				return rrSOUTH_EDGE;
+			m_y--;
+			return rrSUCCESS;
+		case fdEAST:
+			if (m_x + 1 > m_xmax)
+				return rrEAST_EDGE;
+			m_x++;
+			return rrSUCCESS;
+		case fdWEST:
+			if (m_x - 1 < 0)
+				return rrWEST_EDGE;
+			m_x--;
+			return rrSUCCESS;
+		case fdUNKNOWN:
+		default:
+			return rrUNKNOWN_DIRECTION;
+		}
+	}
+
+	RobotResult TurnLeft()
+	{
+		if (!m_placed)
+			return rrNOT_PLACED;
+
+		switch (m_facingDirection)
+		{
+		case fdNORTH: m_facingDirection = fdWEST; return rrSUCCESS;
+		case fdSOUTH: m_facingDirection = fdEAST; return rrSUCCESS;
+		case fdEAST: m_facingDirection = fdNORTH; return rrSUCCESS;
+		case fdWEST: m_facingDirection = fdSOUTH; return rrSUCCESS;
+		case fdUNKNOWN:
+		default:
+			return rrUNKNOWN_DIRECTION;
+		}
+	}
+
+	RobotResult TurnRight()
+	{
+		if (!m_placed)
+			return rrNOT_PLACED;
+
+		switch (m_facingDirection)
+		{
+		case fdNORTH: m_facingDirection = fdEAST; return rrSUCCESS;
+		case fdSOUTH: m_facingDirection = fdWEST; return rrSUCCESS;
+		case fdEAST: m_facingDirection = fdSOUTH; return rrSUCCESS;
+		case fdWEST: m_facingDirection = fdNORTH; return rrSUCCESS;
+		case fdUNKNOWN:
+		default:
+			return rrUNKNOWN_DIRECTION;
+		}
+	}
+
+private:
+	uint8_t m_x = 0;
+	uint8_t m_y = 0;
+
+	const uint8_t m_xmax = 5;
+	const uint8_t m_ymax = 5;
+
+	FacingDirection m_facingDirection = fdUNKNOWN;
+	bool m_placed = false;
+};
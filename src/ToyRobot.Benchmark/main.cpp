@@ -0,0 +1,68 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <iostream>
+#include <string>
+#include "Benchmarks.h"
+
+int main(int argc, char* argv[])
+{
+	std::string filter;
+	double minSeconds = 0.5;
+	bool json = false;
+	uint64_t maxLines = 1000000;
+
+	for (int idx = 1; idx < argc; idx++)
+	{
+		const std::string arg = argv[idx];
+		if (arg.rfind("--filter=", 0) == 0)
+			filter = arg.substr(9);
+		else if (arg.rfind("--min-time=", 0) == 0)
+			minSeconds = std::stod(arg.substr(11));
+		else if (arg == "--json")
+			json = true;
+		else if (arg.rfind("--max-lines=", 0) == 0)
+			maxLines = std::stoull(arg.substr(12));
+		else
+		{
+			std::cerr << "Usage: ToyRobot.Benchmark [--filter=text] [--min-time=seconds] [--max-lines=N] [--json]" << std::endl;
+			return 1;
+		}
+	}
+
+	BenchmarkRunner runner(filter, minSeconds);
+	RunTransitionBenchmarks(runner);
+	RunLockstepBenchmarks(runner);
+	RunOccupancyBenchmarks(runner);
+	RunLazyBenchmarks(runner);
+	RunTrbBenchmarks(runner);
+	RunConcurrentBenchmarks(runner);
+	RunParseBenchmarks(runner);
+	RunDispatchBenchmarks(runner);
+	RunLoggerBenchmarks(runner);
+	RunEndToEndBenchmarks(runner, maxLines);
+
+	if (json)
+		runner.PrintJson(std::cout);
+	else
+		runner.PrintTable(std::cout);
+
+	return 0;
+}
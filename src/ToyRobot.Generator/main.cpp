@@ -0,0 +1,177 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "WorkloadGenerator.h"
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace
+{
+	const char* const Usage =
+		"Usage: ToyRobot.Generator [--lines=N] [--seed=S] [--board=XxY] [--mix=move=60,left=10,right=10,report=5,place=5,unknown=0]\n"
+		"                          [--edge-rate=R] [--invalid-rate=R] [--no-initial-place] [--output=path] [--quiet]";
+
+	bool TryParseUnsigned(const std::string& value, uint64_t& result)
+	{
+		try
+		{
+			size_t used;
+			result = std::stoull(value, &used);
+			return used == value.size() && value[0] != '-';
+		}
+		catch (const std::exception&)
+		{
+			return false;
+		}
+	}
+
+	bool TryParseRate(const std::string& value, double& result)
+	{
+		try
+		{
+			size_t used;
+			result = std::stod(value, &used);
+			return used == value.size() && result >= 0 && result <= 1;
+		}
+		catch (const std::exception&)
+		{
+			return false;
+		}
+	}
+
+	bool TryParseBoard(const std::string& value, uint64_t& maxX, uint64_t& maxY)
+	{
+		const auto separator = value.find_first_of("xX");
+		return separator != std::string::npos
+			&& TryParseUnsigned(value.substr(0, separator), maxX)
+			&& TryParseUnsigned(value.substr(separator + 1), maxY)
+			&& maxX >= 1 && maxY >= 1 && maxX < UINT64_MAX && maxY < UINT64_MAX;
+	}
+
+	std::string ValueOf(const std::string& arg)
+	{
+		return arg.substr(arg.find('=') + 1);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	WorkloadOptions options;
+	uint64_t lines = 1000000;
+	std::string outputPath;
+	auto quiet = false;
+
+	for (int idx = 1; idx < argc; idx++)
+	{
+		const std::string arg = argv[idx];
+		std::string error;
+		auto valid = true;
+		if (arg.rfind("--lines=", 0) == 0)
+			valid = TryParseUnsigned(ValueOf(arg), lines);
+		else if (arg.rfind("--seed=", 0) == 0)
+			valid = TryParseUnsigned(ValueOf(arg), options.seed);
+		else if (arg.rfind("--board=", 0) == 0)
+			valid = TryParseBoard(ValueOf(arg), options.maxX, options.maxY);
+		else if (arg.rfind("--mix=", 0) == 0)
+			valid = TryParseWorkloadMix(ValueOf(arg), options.weights, error);
+		else if (arg.rfind("--edge-rate=", 0) == 0)
+			valid = TryParseRate(ValueOf(arg), options.edgeRate);
+		else if (arg.rfind("--invalid-rate=", 0) == 0)
+			valid = TryParseRate(ValueOf(arg), options.invalidPlaceRate);
+		else if (arg == "--no-initial-place")
+			options.initialPlace = false;
+		else if (arg.rfind("--output=", 0) == 0)
+			outputPath = ValueOf(arg);
+		else if (arg == "--quiet")
+			quiet = true;
+		else
+			valid = false;
+
+		if (!valid)
+		{
+			if (!error.empty())
+				std::cerr << error << std::endl;
+			std::cerr << Usage << std::endl;
+			return 1;
+		}
+	}
+
+	FILE* output = stdout;
+	if (!outputPath.empty())
+	{
+		output = std::fopen(outputPath.c_str(), "wb");
+		if (output == nullptr)
+		{
+			std::cerr << "Unable to create the output file: " << outputPath << std::endl;
+			return 1;
+		}
+	}
+#if defined(_WIN32)
+	else
+	{
+		// Keep the line endings as they are generated.
+		_setmode(_fileno(stdout), _O_BINARY);
+	}
+#endif
+
+	WorkloadGenerator generator(options);
+	std::vector<char> buffer(1 << 20);
+	uint64_t bytes = 0;
+	const auto start = std::chrono::steady_clock::now();
+	const auto totalLines = lines;
+	while (lines > 0)
+	{
+		const auto size = generator.Fill(buffer.data(), buffer.size(), lines);
+		if (std::fwrite(buffer.data(), 1, size, output) != size)
+		{
+			// The reader of the pipe went away, or the disk is full.
+			std::cerr << "Unable to write the output." << std::endl;
+			return 1;
+		}
+
+		bytes += size;
+	}
+
+	if (output != stdout)
+		std::fclose(output);
+	else
+		std::fflush(output);
+
+	if (!quiet)
+	{
+		static const char* const names[wlCOUNT] = { "MOVE", "LEFT", "RIGHT", "REPORT", "PLACE", "unknown" };
+		const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cerr << "Generated " << totalLines << " lines, " << bytes << " bytes in " << seconds << " s ("
+			<< (seconds > 0 ? bytes / seconds / 1e6 : 0) << " MB/s).";
+		for (auto kind = 0; kind < wlCOUNT; kind++)
+			std::cerr << " " << names[kind] << ": " << generator.Counts()[kind];
+		std::cerr << std::endl;
+	}
+
+	return 0;
+}
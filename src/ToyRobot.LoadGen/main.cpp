@@ -0,0 +1,419 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "RobotServer.h"
+
+#if defined(__linux__)
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+	struct LoadOptions
+	{
+		std::string address;
+		size_t sessions = 10000;
+		size_t rounds = 100;
+		size_t batch = 9;
+		size_t maxConnecting = 512;
+	};
+
+	/// <summary>
+	/// One client session. Every round sends a batch of commands ending with REPORT and waits for its output.
+	/// </summary>
+	struct Client
+	{
+		int socket = -1;
+		bool connected = false;
+		size_t round = 0;
+		std::string pending;
+		size_t pendingSent = 0;
+		std::string line;
+		std::chrono::steady_clock::time_point sentAt;
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	class LoadGenerator
+	{
+	public:
+		LoadGenerator(const LoadOptions& options, const ServerAddress& address)
+			: m_options(options),
+			m_address(address),
+			m_epoll(epoll_create1(EPOLL_CLOEXEC)),
+			m_clients(options.sessions)
+		{
+			static const char* const commands[] = { "MOVE", "RIGHT", "MOVE", "LEFT", "MOVE", "LEFT", "MOVE", "RIGHT" };
+			for (size_t idx = 0; idx < options.batch; idx++)
+				m_round.append(commands[idx % 8]).append("\n");
+			m_round.append("REPORT\n");
+
+			m_latencies.reserve(options.sessions * options.rounds);
+		}
+
+		~LoadGenerator()
+		{
+			for (auto& client : m_clients)
+			{
+				if (client.socket >= 0)
+					close(client.socket);
+			}
+			close(m_epoll);
+		}
+
+		/// <summary>
+		/// Open every session, with at most maxConnecting connections in progress at a time.
+		/// </summary>
+		bool Connect()
+		{
+			size_t next = 0;
+			size_t connecting = 0;
+			size_t connected = 0;
+			std::vector<epoll_event> events(256);
+			while (connected < m_clients.size())
+			{
+				while (next < m_clients.size() && connecting < m_options.maxConnecting)
+				{
+					if (!StartConnect(m_clients[next]))
+						return false;
+					next++;
+					connecting++;
+				}
+
+				const auto count = epoll_wait(m_epoll, events.data(), static_cast<int>(events.size()), 10000);
+				if (count <= 0)
+				{
+					std::cerr << "Connecting timed out with " << connected << " sessions connected." << std::endl;
+					return false;
+				}
+
+				for (int idx = 0; idx < count; idx++)
+				{
+					auto& client = *static_cast<Client*>(events[idx].data.ptr);
+					int error = 0;
+					socklen_t length = sizeof(error);
+					getsockopt(client.socket, SOL_SOCKET, SO_ERROR, &error, &length);
+					if (error == EAGAIN || error == ECONNREFUSED)
+					{
+						// The listen backlog was full, try again.
+						close(client.socket);
+						if (!StartConnect(client))
+							return false;
+						continue;
+					}
+
+					if (error != 0)
+					{
+						std::cerr << "Connection failed: " << std::strerror(error) << std::endl;
+						return false;
+					}
+
+					client.connected = true;
+					Watch(client, 0);
+					connecting--;
+					connected++;
+				}
+			}
+
+			return true;
+		}
+
+		/// <summary>
+		/// Run the rounds of every session at once.
+		/// </summary>
+		bool Run()
+		{
+			for (auto& client : m_clients)
+			{
+				client.pending = "PLACE 0,0,NORTH\n" + m_round;
+				if (!Send(client))
+					return false;
+			}
+
+			size_t done = 0;
+			std::vector<epoll_event> events(256);
+			std::vector<char> buffer(64 * 1024);
+			while (done < m_clients.size())
+			{
+				const auto count = epoll_wait(m_epoll, events.data(), static_cast<int>(events.size()), 10000);
+				if (count <= 0)
+				{
+					std::cerr << "Timed out with " << done << " sessions done." << std::endl;
+					return false;
+				}
+
+				for (int idx = 0; idx < count; idx++)
+				{
+					auto& client = *static_cast<Client*>(events[idx].data.ptr);
+					if ((events[idx].events & EPOLLOUT) != 0 && !Send(client))
+						return false;
+
+					if ((events[idx].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) == 0)
+						continue;
+
+					const auto received = read(client.socket, buffer.data(), buffer.size());
+					if (received <= 0)
+					{
+						if (received < 0 && errno == EAGAIN)
+							continue;
+
+						std::cerr << "Session closed by the server." << std::endl;
+						return false;
+					}
+
+					m_bytesIn += static_cast<uint64_t>(received);
+					if (ReceiveLines(client, buffer.data(), buffer.data() + received))
+					{
+						close(client.socket);
+						client.socket = -1;
+						done++;
+					}
+					else if (!Send(client))
+					{
+						return false;
+					}
+				}
+			}
+
+			return true;
+		}
+
+		const std::vector<uint32_t>& Latencies() const { return m_latencies; }
+		uint64_t CommandCount() const { return m_options.sessions * (1 + m_options.rounds * (m_options.batch + 1)); }
+		uint64_t BytesIn() const { return m_bytesIn; }
+
+	private:
+		bool StartConnect(Client& client)
+		{
+			client.socket = socket(m_address.family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+			if (client.socket < 0)
+			{
+				std::cerr << "Unable to create a socket: " << std::strerror(errno) << std::endl;
+				return false;
+			}
+
+			if (m_address.family != AF_UNIX)
+			{
+				const int noDelay = 1;
+				setsockopt(client.socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+			}
+
+			if (connect(client.socket, reinterpret_cast<const sockaddr*>(m_address.storage), m_address.length) != 0
+				&& errno != EINPROGRESS && errno != EAGAIN)
+			{
+				std::cerr << "Unable to connect: " << std::strerror(errno) << std::endl;
+				return false;
+			}
+
+			epoll_event event{};
+			event.events = EPOLLOUT;
+			event.data.ptr = &client;
+			return epoll_ctl(m_epoll, EPOLL_CTL_ADD, client.socket, &event) == 0;
+		}
+
+		void Watch(Client& client, uint32_t events)
+		{
+			epoll_event event{};
+			event.events = events;
+			event.data.ptr = &client;
+			epoll_ctl(m_epoll, EPOLL_CTL_MOD, client.socket, &event);
+		}
+
+		bool Send(Client& client)
+		{
+			if (client.pending.empty())
+				return true;
+
+			if (client.pendingSent == 0)
+				client.sentAt = Clock::now();
+
+			while (client.pendingSent < client.pending.size())
+			{
+				const auto sent = send(client.socket, client.pending.data() + client.pendingSent,
+					client.pending.size() - client.pendingSent, MSG_NOSIGNAL);
+				if (sent < 0)
+				{
+					if (errno == EAGAIN)
+					{
+						Watch(client, EPOLLIN | EPOLLOUT);
+						return true;
+					}
+
+					std::cerr << "Send failed: " << std::strerror(errno) << std::endl;
+					return false;
+				}
+
+				client.pendingSent += static_cast<size_t>(sent);
+			}
+
+			client.pending.clear();
+			client.pendingSent = 0;
+			Watch(client, EPOLLIN);
+			return true;
+		}
+
+		/// <summary>
+		/// Scan the received lines for the REPORT output, which completes the round.
+		/// </summary>
+		/// <returns>[true] The session did all of its rounds. [false] More rounds to go.</returns>
+		bool ReceiveLines(Client& client, const char* begin, const char* end)
+		{
+			for (auto position = begin; position != end; position++)
+			{
+				if (*position != '\n')
+				{
+					client.line.push_back(*position);
+					continue;
+				}
+
+				const auto isOutput = client.line.find("Output:") != std::string::npos;
+				client.line.clear();
+				if (!isOutput)
+					continue;
+
+				m_latencies.push_back(static_cast<uint32_t>(
+					std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - client.sentAt).count()));
+
+				if (++client.round == m_options.rounds)
+					return true;
+
+				client.pending = m_round;
+			}
+
+			return false;
+		}
+
+		LoadOptions m_options;
+		ServerAddress m_address;
+		int m_epoll;
+		std::vector<Client> m_clients;
+		std::string m_round;
+		std::vector<uint32_t> m_latencies;
+		uint64_t m_bytesIn = 0;
+	};
+
+	bool TryParseCount(const std::string& arg, size_t& value)
+	{
+		try
+		{
+			value = std::stoul(arg.substr(arg.find('=') + 1));
+			return value > 0;
+		}
+		catch (const std::exception&)
+		{
+			return false;
+		}
+	}
+
+	double Percentile(const std::vector<uint32_t>& sorted, double percentile)
+	{
+		const auto index = static_cast<size_t>(percentile / 100 * (sorted.size() - 1));
+		return sorted[index] / 1000.0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	LoadOptions options;
+	for (int idx = 1; idx < argc; idx++)
+	{
+		const std::string arg = argv[idx];
+		auto valid = true;
+		if (arg.rfind("--connect=", 0) == 0)
+			options.address = arg.substr(10);
+		else if (arg.rfind("--sessions=", 0) == 0)
+			valid = TryParseCount(arg, options.sessions);
+		else if (arg.rfind("--rounds=", 0) == 0)
+			valid = TryParseCount(arg, options.rounds);
+		else if (arg.rfind("--batch=", 0) == 0)
+			valid = TryParseCount(arg, options.batch);
+		else if (arg.rfind("--max-connecting=", 0) == 0)
+			valid = TryParseCount(arg, options.maxConnecting);
+		else
+			valid = false;
+
+		if (!valid)
+		{
+			std::cerr << "Usage: ToyRobot.LoadGen --connect=tcp:host:port|unix:path [--sessions=N] [--rounds=N] [--batch=N] [--max-connecting=N]" << std::endl;
+			return 1;
+		}
+	}
+
+	ServerAddress address;
+	std::string error;
+	if (!TryResolveServerAddress(options.address, address, error))
+	{
+		std::cerr << error << std::endl;
+		return 1;
+	}
+
+	// Every session holds a socket.
+	rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+	{
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+
+	LoadGenerator generator(options, address);
+
+	const auto connectStart = Clock::now();
+	if (!generator.Connect())
+		return 1;
+	const auto connectSeconds = std::chrono::duration<double>(Clock::now() - connectStart).count();
+
+	const auto runStart = Clock::now();
+	if (!generator.Run())
+		return 1;
+	const auto runSeconds = std::chrono::duration<double>(Clock::now() - runStart).count();
+
+	auto latencies = generator.Latencies();
+	std::sort(latencies.begin(), latencies.end());
+
+	std::cout << options.sessions << " sessions connected in " << connectSeconds << " s." << std::endl;
+	std::cout << latencies.size() << " rounds of " << options.batch + 1 << " commands in " << runSeconds << " s: "
+		<< generator.CommandCount() / runSeconds << " commands/s, " << latencies.size() / runSeconds << " rounds/s, "
+		<< generator.BytesIn() / runSeconds / 1e6 << " MB/s received." << std::endl;
+	std::cout << "Round latency (us): p50 " << Percentile(latencies, 50) << ", p90 " << Percentile(latencies, 90)
+		<< ", p99 " << Percentile(latencies, 99) << ", p99.9 " << Percentile(latencies, 99.9)
+		<< ", max " << latencies.back() / 1000.0 << std::endl;
+	return 0;
+}
+
+#else
+
+int main()
+{
+	std::cerr << "The load generator is only supported on Linux." << std::endl;
+	return 1;
+}
+
+#endif
@@ -0,0 +1,379 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "CommandProgram.h"
+#include "ConcurrentToyRobot.h"
+#include "LockstepRunner.h"
+#include "RobotTransition.h"
+#include "TestUtils.h"
+#include "TrbFile.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// A script with blocks, and the same script with every block written out.
+/// </summary>
+struct BlockScript
+{
+	std::vector<std::string> lines;
+	std::vector<std::string> expanded;
+};
+
+static const char* const s_commands[] = {
+	"MOVE", "MOVE", "LEFT", "RIGHT", "REPORT", "PLACE 0,0,NORTH", "PLACE 4,3,WEST", "PLACE 2,2,unknown", "PLACE 9,1,EAST", "JUMP", "PLACE 1,x,EAST"
+};
+
+static void AppendStatements(std::mt19937& random, int depth, BlockScript& script, std::vector<std::vector<std::string>>& macros)
+{
+	const auto count = 1 + random() % 4;
+	for (size_t statement = 0; statement < count; statement++)
+	{
+		const auto kind = random() % 8;
+		if (kind == 0 && depth < 3)
+		{
+			const auto repeat = random() % 5;
+			script.lines.push_back("  REPEAT " + std::to_string(repeat) + " {");
+
+			BlockScript body;
+			AppendStatements(random, depth + 1, body, macros);
+			script.lines.insert(script.lines.end(), body.lines.begin(), body.lines.end());
+			script.lines.push_back("}");
+			for (size_t idx = 0; idx < repeat; idx++)
+				script.expanded.insert(script.expanded.end(), body.expanded.begin(), body.expanded.end());
+		}
+		else if (kind == 1 && !macros.empty())
+		{
+			const auto macro = random() % macros.size();
+			script.lines.push_back("CALL m" + std::to_string(macro));
+			script.expanded.insert(script.expanded.end(), macros[macro].begin(), macros[macro].end());
+		}
+		else
+		{
+			const auto line = s_commands[random() % (sizeof(s_commands) / sizeof(s_commands[0]))];
+			script.lines.push_back(line);
+			script.expanded.push_back(line);
+		}
+	}
+}
+
+/// <summary>
+/// Random script of macros, nested REPEAT blocks and plain commands.
+/// </summary>
+static BlockScript MakeBlockScript(unsigned seed)
+{
+	std::mt19937 random(seed);
+	std::vector<std::vector<std::string>> macros;
+	BlockScript script;
+	for (int part = 0; part < 12; part++)
+	{
+		if (random() % 3 == 0)
+		{
+			BlockScript body;
+			AppendStatements(random, 1, body, macros);
+			script.lines.push_back("DEFINE m" + std::to_string(macros.size()) + " {");
+			script.lines.insert(script.lines.end(), body.lines.begin(), body.lines.end());
+			script.lines.push_back("}");
+			macros.push_back(body.expanded);
+		}
+		else
+		{
+			AppendStatements(random, 0, script, macros);
+		}
+	}
+
+	return script;
+}
+
+static std::vector<std::string> RunCompiled(const std::vector<std::string>& lines, LogLevel level, bool lazy)
+{
+	CommandProgram program;
+	for (const auto& line : lines)
+		program.CompileLine(line);
+	program.Finish();
+
+	RecordingLogger logger;
+	logger.SetLevel(level);
+	ToyRobot robot(logger);
+	ProgramRunner runner(robot, logger);
+	if (lazy)
+		runner.RunLazy(program);
+	else
+		runner.Run(program);
+
+	return logger.messages;
+}
+
+template <typename TRobot, typename... TArgs>
+static std::vector<std::string> LaunchScript(const std::vector<std::string>& lines, LogLevel level, TArgs&&... args)
+{
+	RecordingLogger logger;
+	logger.SetLevel(level);
+	TRobot robot(logger, std::forward<TArgs>(args)...);
+	StatementRunner<TRobot> statementRunner(robot);
+	ScriptCommander commander(robot, logger, lines);
+	commander.SetStatementRunner(&statementRunner);
+	commander.Launch();
+
+	std::vector<std::string> messages;
+	for (const auto& message : logger.messages)
+	{
+		if (message.find("Please enter command") == std::string::npos)
+			messages.push_back(message);
+	}
+
+	return messages;
+}
+
+TEST(TestCommandBlocks, TestMatchesExpandedScript)
+{
+	for (unsigned seed = 0; seed < 40; seed++)
+	{
+		const auto script = MakeBlockScript(seed);
+		for (const auto level : { llINFO, llWARN, llERROR, llNONE })
+		{
+			const auto expected = RunCompiled(script.expanded, level, false);
+			EXPECT_EQ(RunCompiled(script.lines, level, false), expected) << seed << " " << level;
+			EXPECT_EQ(RunCompiled(script.lines, level, true), expected) << seed << " " << level;
+			EXPECT_EQ(LaunchScript<ToyRobot>(script.lines, level), LaunchScript<ToyRobot>(script.expanded, level)) << seed << " " << level;
+		}
+
+		// Other boards run every block command by command.
+		const RuntimeBoard board(6, 3);
+		EXPECT_EQ(LaunchScript<RuntimeToyRobot>(script.lines, llINFO, board), LaunchScript<RuntimeToyRobot>(script.expanded, llINFO, board)) << seed;
+	}
+}
+
+TEST(TestCommandBlocks, TestEffectMatchesRobot)
+{
+	const auto script = MakeBlockScript(7);
+
+	CommandProgram program;
+	program.CompileLine("DEFINE body {");
+	for (const auto& line : script.expanded)
+		program.CompileLine(line);
+	program.CompileLine("}");
+
+	CommandProgram flat;
+	for (const auto& line : script.expanded)
+		flat.CompileLine(line);
+
+	ASSERT_EQ(program.Blocks().size(), 1u);
+	const auto& effect = program.Blocks()[0].powers[0];
+	for (size_t state = 0; state < RobotTransition::StateCount; state++)
+	{
+		const auto from = static_cast<RobotTransition::State>(state);
+		RecordingLogger logger;
+		ToyRobot robot(logger);
+		robot.TryRestoreState(RobotTransition::Decode(from));
+		ProgramRunner runner(robot, logger);
+		runner.Run(flat);
+
+		uint8_t levels = 0;
+		for (const auto& message : logger.messages)
+		{
+			if (message.rfind("INFO - Output: ", 0) == 0)
+				levels |= elOUTPUT;
+			else if (message.rfind("INFO", 0) == 0)
+				levels |= elINFO;
+			else if (message.rfind("WARN", 0) == 0)
+				levels |= elWARN;
+			else
+				levels |= elERROR;
+		}
+
+		EXPECT_EQ(effect.Levels(from), levels) << state;
+		EXPECT_EQ(effect.Transition().Apply(from), RobotTransition::Encode(robot.SaveState())) << state;
+	}
+}
+
+TEST(TestCommandBlocks, TestSilentRepeatIsSkipped)
+{
+	// Far too many iterations to run one by one. Turns only log at INFO, so at WARN they are skipped.
+	const std::vector<std::string> lines = {
+		"PLACE 0,0,NORTH", "DEFINE spin {", "REPEAT 1000000000000 {", "LEFT", "}", "RIGHT", "}", "REPEAT 18446744073709551615 {", "CALL spin", "}", "REPORT"
+	};
+
+	EXPECT_EQ(RunCompiled(lines, llWARN, false), std::vector<std::string>({ "INFO - Output: 0,0,WEST" }));
+	EXPECT_EQ(LaunchScript<ToyRobot>(lines, llWARN), std::vector<std::string>({ "INFO - Output: 0,0,WEST" }));
+
+	// Without any level enabled a walk skips the moves against the edge as well.
+	const std::vector<std::string> walk = { "PLACE 0,0,NORTH", "REPEAT 1000000000000 {", "MOVE", "}", "REPORT" };
+	EXPECT_EQ(RunCompiled(walk, llNONE, true), std::vector<std::string>({ "INFO - Output: 0,5,NORTH" }));
+
+	CommandProgram program;
+	for (const auto& line : walk)
+		program.CompileLine(line);
+
+	// Powers up to the highest bit of the count, 2^39.
+	ASSERT_EQ(program.Blocks().size(), 1u);
+	EXPECT_EQ(program.Blocks()[0].powers.size(), 40u);
+	EXPECT_EQ(program.RepeatEffect(0, 1000000000000), program.Blocks()[0].powers[0].Then(program.RepeatEffect(0, 999999999999)));
+}
+
+TEST(TestCommandBlocks, TestBlockErrors)
+{
+	const std::vector<std::string> lines = {
+		"CALL missing",
+		"}",
+		"DEFINE {",
+		"MOVE",
+		"}",
+		"REPEAT -1 {",
+		"MOVE",
+		"}",
+		"REPEAT 2",
+		"CALL",
+		"DEFINE turn {",
+		"DEFINE inner {",
+		"LEFT",
+		"}",
+		"CALL turn",
+		"}",
+		"PLACE 0,0,NORTH",
+		"CALL turn",
+		"CALL inner",
+		"REPEAT 2 {",
+		"RIGHT",
+		"EXIT",
+		"REPORT"
+	};
+
+	const std::vector<std::string> expected = {
+		"ERROR - Unknown macro: missing",
+		"ERROR - Unexpected }. There is no open block to close.",
+		"ERROR - Invalid arguments for define command. Command expects a name and an opening brace in the form of (define name {)",
+		"ERROR - Invalid arguments for repeat command. Command expects a count and an opening brace in the form of (repeat n {)",
+		"ERROR - Invalid arguments for repeat command. Command expects a count and an opening brace in the form of (repeat n {)",
+		"ERROR - Invalid number of arguments for call command. Command expects 1 argument in the form of (call name)",
+		"ERROR - Unknown macro: turn",
+		"INFO - Robot is now facing WEST",
+		"ERROR - A block is not closed. Expected } before the end of the script."
+	};
+
+	EXPECT_EQ(RunCompiled(lines, llINFO, false), expected);
+
+	auto launched = LaunchScript<ToyRobot>(lines, llINFO);
+	ASSERT_EQ(launched.size(), expected.size() + 2);
+	EXPECT_EQ(std::vector<std::string>(launched.begin() + 1, launched.end() - 1), expected);
+
+	// Every macro call adds a level, the chain stops at the deepest nesting the runner allows.
+	CommandProgram program;
+	program.CompileText("DEFINE m0 {\nMOVE\n}\n");
+	for (size_t idx = 1; idx <= CommandProgram::MaxBlockDepth; idx++)
+		program.CompileText("DEFINE m" + std::to_string(idx) + " {\nCALL m" + std::to_string(idx - 1) + "\n}\n");
+
+	ASSERT_EQ(program.Messages().size(), 1u);
+	EXPECT_EQ(program.Messages()[0], "Blocks are nested too deeply.");
+	EXPECT_EQ(program.Blocks().back().depth, 1u);
+}
+
+/// <summary>
+/// Statement runner recording the statements it is given instead of running them.
+/// </summary>
+class CountingStatementRunner : public StatementRunnerBase
+{
+public:
+	size_t statements = 0;
+
+	void RunStatement(const CommandProgram& /*statement*/, LoggerBase& /*logger*/, ResultSink* /*resultSink*/) override
+	{
+		statements++;
+	}
+};
+
+TEST(TestCommandBlocks, TestStatementRunnerIsInjected)
+{
+	const std::vector<std::string> lines = { "PLACE 0,0,NORTH", "REPEAT 3 {", "MOVE", "}", "DEFINE turn {", "LEFT", "}", "CALL turn", "REPORT" };
+
+	// The commander does not care what robot it drives, the runner it is given runs the blocks.
+	RecordingLogger logger;
+	ConcurrentToyRobot robot(logger);
+	CountingStatementRunner statementRunner;
+	ScriptCommander commander(robot, logger, lines);
+	commander.SetStatementRunner(&statementRunner);
+	commander.Launch();
+
+	EXPECT_EQ(statementRunner.statements, 2u);
+	for (const auto& message : logger.messages)
+		EXPECT_EQ(message.rfind("ERROR", 0), std::string::npos) << message;
+
+	// Without a runner the statements are rejected, the plain commands still run.
+	RecordingLogger rejectedLogger;
+	ConcurrentToyRobot rejectedRobot(rejectedLogger);
+	ScriptCommander rejected(rejectedRobot, rejectedLogger, lines);
+	rejected.Launch();
+
+	std::vector<std::string> errors;
+	for (const auto& message : rejectedLogger.messages)
+	{
+		if (message.rfind("ERROR", 0) == 0)
+			errors.push_back(message);
+	}
+
+	EXPECT_EQ(errors, std::vector<std::string>(2, "ERROR - Blocks are not supported by this robot."));
+	EXPECT_NE(std::find(rejectedLogger.messages.begin(), rejectedLogger.messages.end(), "INFO - Output: 0,0,NORTH"), rejectedLogger.messages.end());
+}
+
+TEST(TestCommandBlocks, TestBatchAndTrb)
+{
+	const auto script = MakeBlockScript(3);
+
+	std::vector<CommandProgram> programs(2);
+	for (const auto& line : script.lines)
+		programs[0].CompileLine(line);
+	for (const auto& line : script.expanded)
+		programs[1].CompileLine(line);
+
+	LockstepRunner lockstep;
+	std::vector<std::vector<std::string>> reports;
+	lockstep.Run(programs, reports);
+	EXPECT_FALSE(programs[0].Blocks().empty());
+	EXPECT_EQ(reports[0], reports[1]);
+
+	TrbWriter writer(5, 5);
+	for (const auto& line : script.lines)
+		writer.WriteLine(line);
+
+	const auto& data = writer.Finish();
+	TrbReader reader;
+	TrbHeader header;
+	ASSERT_TRUE(reader.TryOpen(data.data(), data.data() + data.size(), header));
+
+	// The block commands read back with their arguments, and compile into the same program as the text.
+	CommandProgram read;
+	PlaceArgs place;
+	std::string_view args;
+	bool placeIsValid;
+	for (auto cmd = reader.Next(place, args, placeIsValid); !reader.AtEnd(); cmd = reader.Next(place, args, placeIsValid))
+	{
+		if (cmd == cmdPLACE && placeIsValid)
+			read.AppendPlace(place.x, place.y, place.facingDirection);
+		else
+			read.CompileCommand(cmd, args);
+	}
+
+	EXPECT_EQ(read.Code(), programs[0].Code());
+	ASSERT_EQ(read.Blocks().size(), programs[0].Blocks().size());
+	for (size_t idx = 0; idx < read.Blocks().size(); idx++)
+		EXPECT_EQ(read.Blocks()[idx].code, programs[0].Blocks()[idx].code);
+}
@@ -0,0 +1,223 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "CommandProgram.h"
+#include "TestUtils.h"
+#include <random>
+#include <string>
+#include <vector>
+
+static const std::vector<std::string> s_script = {
+	"MOVE",
+	"PLACE 1,2,EAST",
+	"MOVE",
+	"MOVE",
+	"MOVE",
+	"MOVE",
+	"MOVE",
+	"LEFT",
+	"REPORT",
+	"PLACE 0,0,NORTH",
+	"PLACE 1,2",
+	"PLACE x,2,WEST",
+	"JUMP",
+	"RIGHT",
+	"RIGHT",
+	"REPORT",
+	"EXIT",
+	"MOVE",
+	"REPORT"
+};
+
+static CommandProgram CompileScript(const std::vector<std::string>& lines)
+{
+	CommandProgram program;
+	for (const auto& line : lines)
+		program.CompileLine(line);
+
+	return program;
+}
+
+/// <summary>
+/// Messages logged by the commander, without prompts.
+/// </summary>
+static std::vector<std::string> LaunchScript(const std::vector<std::string>& lines)
+{
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	ScriptCommander commander(robot, logger, lines);
+	commander.Launch();
+
+	std::vector<std::string> messages;
+	for (const auto& message : logger.messages)
+	{
+		if (message.find("Please enter command") == std::string::npos)
+			messages.push_back(message);
+	}
+
+	return messages;
+}
+
+TEST(TestCommandProgram, TestCompactEncoding)
+{
+	const auto program = CompileScript({ "MOVE", "LEFT", "RIGHT", "REPORT", "PLACE 1,2,NORTH" });
+
+	EXPECT_EQ(program.CommandCount(), 5u);
+	EXPECT_EQ(program.Code().size(), 4u + 1u + CommandProgram::PlacePayloadSize);
+	EXPECT_TRUE(program.Messages().empty());
+}
+
+TEST(TestCommandProgram, TestLinesAfterExitAreIgnored)
+{
+	const auto program = CompileScript(s_script);
+
+	EXPECT_TRUE(program.IsExited());
+	EXPECT_EQ(program.CommandCount(), 16u);
+	EXPECT_EQ(program.Messages().size(), 3u);
+}
+
+TEST(TestCommandProgram, TestMatchesCommander)
+{
+	const auto program = CompileScript(s_script);
+
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	logger.Info("Toy robot starting..");
+	ProgramRunner runner(robot, logger);
+	runner.Run(program);
+	logger.Info("Toy robot quitting..");
+
+	EXPECT_EQ(logger.messages, LaunchScript(s_script));
+}
+
+TEST(TestCommandProgram, TestProgramIsReusable)
+{
+	CommandProgram program;
+	program.CompileText("PLACE 0,0,NORTH\nMOVE\nRIGHT\nMOVE\nREPORT\n");
+
+	for (int run = 0; run < 3; run++)
+	{
+		RecordingLogger logger;
+		ToyRobot robot(logger);
+		ProgramRunner runner(robot, logger);
+		runner.Run(program);
+
+		ASSERT_EQ(logger.messages.size(), 2u);
+		EXPECT_EQ(logger.messages[0], "INFO - Robot is now facing EAST");
+		EXPECT_EQ(logger.messages[1], "INFO - Output: 1,1,EAST");
+	}
+}
+
+/// <summary>
+/// Random script with long runs of MOVE and of mixed LEFT and RIGHT commands between the other commands.
+/// </summary>
+static CommandProgram MakeRunScript(unsigned seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<size_t> runLength(1, 40);
+	std::bernoulli_distribution left(0.7);
+
+	CommandProgram program;
+	for (const auto& command : MakeRandomLines(seed, 60))
+	{
+		if (command == "MOVE")
+		{
+			for (auto count = runLength(random); count > 0; count--)
+				program.CompileLine("MOVE");
+		}
+		else if (command == "LEFT" || command == "RIGHT")
+		{
+			for (auto count = runLength(random); count > 0; count--)
+				program.CompileLine(left(random) ? "LEFT" : "RIGHT");
+		}
+		else
+		{
+			program.CompileLine(command);
+		}
+	}
+
+	return program;
+}
+
+template <typename TRobot>
+static std::vector<std::string> RunProgram(const CommandProgram& program, LogLevel level, bool lazy, TRobot& robot, RecordingLogger& logger)
+{
+	logger.SetLevel(level);
+	BasicProgramRunner<TRobot> runner(robot, logger);
+	if (lazy)
+		runner.RunLazy(program);
+	else
+		runner.Run(program);
+
+	return logger.messages;
+}
+
+template <typename TRobot>
+static std::vector<std::string> RunProgram(const CommandProgram& program, LogLevel level, bool lazy)
+{
+	RecordingLogger logger;
+	TRobot robot(logger);
+	return RunProgram(program, level, lazy, robot, logger);
+}
+
+static std::vector<std::string> RunProgramWithObstacle(const CommandProgram& program, LogLevel level, bool lazy)
+{
+	RecordingLogger logger;
+	DenseOccupancy index(5, 5);
+	index.Occupy(2, 4);
+	DenseSharedToyRobot robot(logger, RuntimeBoard(5, 5), SharedOccupancy<DenseOccupancy>(index));
+	return RunProgram(program, level, lazy, robot, logger);
+}
+
+TEST(TestCommandProgram, TestLazyMatchesStepwise)
+{
+	for (unsigned seed = 0; seed < 50; seed++)
+	{
+		const auto program = MakeRunScript(seed);
+		for (const auto level : { llINFO, llWARN, llERROR, llNONE })
+		{
+			EXPECT_EQ(RunProgram<ToyRobot>(program, level, true), RunProgram<ToyRobot>(program, level, false)) << "seed " << seed;
+			EXPECT_EQ(RunProgramWithObstacle(program, level, true), RunProgramWithObstacle(program, level, false)) << "seed " << seed;
+		}
+	}
+}
+
+TEST(TestCommandProgram, TestMoveRunIsClamped)
+{
+	RecordingLogger logger;
+	RuntimeToyRobot robot(logger, RuntimeBoard(uint64_t(1) << 32, 3));
+
+	uint64_t rejected;
+	EXPECT_EQ(robot.MoveRun(3, rejected), rrNOT_PLACED);
+	EXPECT_EQ(rejected, 3u);
+
+	robot.Place(1, 1, fdEAST);
+	EXPECT_EQ(robot.MoveRun(uint64_t(1) << 40, rejected), rrEAST_EDGE);
+	EXPECT_EQ(rejected, (uint64_t(1) << 40) - ((uint64_t(1) << 32) - 1));
+	EXPECT_TRUE(logger.messages.empty());
+
+	uint64_t x;
+	uint64_t y;
+	FacingDirection facingDirection;
+	robot.Report(x, y, facingDirection);
+	EXPECT_EQ(x, uint64_t(1) << 32);
+	EXPECT_EQ(y, 1u);
+}
@@ -0,0 +1,91 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "CommandStats.h"
+#include "TestUtils.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+TEST(TestCommandStats, TestHistogramBuckets)
+{
+	// Buckets are contiguous and every value falls into the bucket whose range holds it.
+	for (size_t bucket = 1; bucket < LatencyHistogram::BucketCount; bucket++)
+		EXPECT_EQ(LatencyHistogram::BucketOf(LatencyHistogram::UpperBound(bucket - 1) + 1), bucket);
+
+	for (const uint64_t value : { 0ull, 31ull, 32ull, 33ull, 1000ull, 123456789ull, (1ull << 40) + 5 })
+	{
+		const auto bucket = LatencyHistogram::BucketOf(value);
+		EXPECT_LE(value, LatencyHistogram::UpperBound(bucket));
+		if (bucket > 0)
+		{
+			EXPECT_GT(value, LatencyHistogram::UpperBound(bucket - 1));
+		}
+	}
+
+	EXPECT_EQ(LatencyHistogram::BucketOf(UINT64_MAX), LatencyHistogram::BucketCount - 1);
+}
+
+TEST(TestCommandStats, TestHistogramPercentiles)
+{
+	LatencyHistogram histogram;
+	EXPECT_EQ(histogram.Percentile(50), 0u);
+
+	for (uint64_t value = 1; value <= 1000; value++)
+		histogram.Record(value);
+
+	EXPECT_EQ(histogram.Count(), 1000u);
+	EXPECT_EQ(histogram.Max(), 1000u);
+
+	// Within the 1/16 width of a bucket.
+	EXPECT_GE(histogram.Percentile(50), 500u);
+	EXPECT_LE(histogram.Percentile(50), 500u + 500u / 16);
+	EXPECT_GE(histogram.Percentile(99), 990u);
+	EXPECT_EQ(histogram.Percentile(100), 1000u);
+}
+
+TEST(TestCommandStats, TestStatsCommand)
+{
+	const std::vector<std::string> lines = { "MOVE", "PLACE 0,0,NORTH", "MOVE", "MOVE", "MOVE", "MOVE", "MOVE", "MOVE", "PLACE 1,x,EAST", "LEFT", "STATS" };
+
+	RecordingLogger logger;
+	logger.recordStats = true;
+	ToyRobot robot(logger);
+	ScriptCommander commander(robot, logger, lines);
+	commander.Launch();
+
+	const auto& messages = logger.messages;
+	const auto contains = [&messages](const std::string& text) {
+		return std::any_of(messages.begin(), messages.end(), [&text](const std::string& message) { return message.find(text) != std::string::npos; });
+	};
+
+	if constexpr (StatsEnabled)
+	{
+		EXPECT_TRUE(contains("INFO - Stats: MOVE count=7 "));
+		EXPECT_TRUE(contains("INFO - Stats: MOVE results: success=5, not placed=1, north edge=1"));
+		EXPECT_TRUE(contains("INFO - Stats: PLACE results: success=1, invalid arguments=1"));
+		EXPECT_TRUE(contains("INFO - Stats: LEFT results: success=1"));
+	}
+	else
+	{
+		EXPECT_TRUE(contains("ERROR - Statistics are not enabled in this build."));
+	}
+}
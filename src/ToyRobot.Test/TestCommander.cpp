@@ -0,0 +1,259 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "Commander.h"
+#include "TestUtils.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MockCommanderLogger : public LoggerBase
+{
+protected:
+	void Print(std::string_view /*msgType*/, std::string_view /*msg*/, std::string_view /*end*/) override
+	{
+		// Just ignore any log messages here.
+	}
+};
+
+static Command Parse(std::string_view input, std::string_view& args)
+{
+	return CommanderBase::ParseCommand(input, args);
+}
+
+TEST(TestCommander, TestParseKeywordsIgnoreCase)
+{
+	std::string_view args;
+	EXPECT_EQ(Parse("MOVE", args), cmdMOVE);
+	EXPECT_EQ(Parse("move", args), cmdMOVE);
+	EXPECT_EQ(Parse("Left", args), cmdTURN_LEFT);
+	EXPECT_EQ(Parse("rIGHT", args), cmdTURN_RIGHT);
+	EXPECT_EQ(Parse("REPORT", args), cmdREPORT);
+	EXPECT_EQ(Parse("Exit", args), cmdEXIT);
+	EXPECT_EQ(Parse("  PLACE 1,2,NORTH", args), cmdPLACE);
+	EXPECT_EQ(args, " 1,2,NORTH");
+}
+
+TEST(TestCommander, TestParseUnknown)
+{
+	std::string_view args;
+	EXPECT_EQ(Parse("", args), cmdUNKNOWN);
+	EXPECT_EQ(Parse("   ", args), cmdUNKNOWN);
+	EXPECT_EQ(Parse("MOVES", args), cmdUNKNOWN);
+	EXPECT_EQ(Parse("MO", args), cmdUNKNOWN);
+	EXPECT_EQ(Parse("REPOR T", args), cmdUNKNOWN);
+}
+
+TEST(TestCommander, TestSplitSkipsEmptyTokens)
+{
+	std::string_view tokens[3];
+	EXPECT_EQ(CommanderBase::Split("1,,2,NORTH,", ',', tokens, 3), 3u);
+	EXPECT_EQ(tokens[0], "1");
+	EXPECT_EQ(tokens[1], "2");
+	EXPECT_EQ(tokens[2], "NORTH");
+
+	EXPECT_EQ(CommanderBase::Split("1,2,NORTH,SOUTH", ',', tokens, 3), 4u);
+	EXPECT_EQ(CommanderBase::Split("", ',', tokens, 3), 0u);
+}
+
+TEST(TestCommander, TestParseInt)
+{
+	int num = 0;
+	EXPECT_TRUE(CommanderBase::TryParseInt("42", num));
+	EXPECT_EQ(num, 42);
+	EXPECT_TRUE(CommanderBase::TryParseInt("+3", num));
+	EXPECT_EQ(num, 3);
+	EXPECT_TRUE(CommanderBase::TryParseInt("-1", num));
+	EXPECT_EQ(num, -1);
+	EXPECT_FALSE(CommanderBase::TryParseInt("1a", num));
+	EXPECT_FALSE(CommanderBase::TryParseInt("x", num));
+}
+
+TEST(TestCommander, TestPlaceAndMove)
+{
+	const std::vector<std::string> lines = { "PLACE 1,2,EAST", "MOVE", "LEFT", "PLACE 4,4,NORTH" };
+
+	MockCommanderLogger logger;
+	ToyRobot robot(logger);
+	ScriptCommander commander(robot, logger, lines);
+
+	std::string_view args;
+	for (size_t idx = 0; idx < lines.size(); idx++)
+	{
+		const auto cmd = commander.GetCommand(args);
+		commander.Execute(cmd, args);
+	}
+
+	uint8_t x;
+	uint8_t y;
+	FacingDirection facingDirection;
+	robot.Report(x, y, facingDirection);
+
+	EXPECT_EQ(x, 2);
+	EXPECT_EQ(y, 2);
+	EXPECT_EQ(facingDirection, fdNORTH);
+}
+
+TEST(TestCommander, TestNoAllocationsPerCommand)
+{
+	const std::vector<std::string> lines = {
+		"PLACE 1,2,EAST", "MOVE", "LEFT", "RIGHT", "REPORT", "EXIT", "unknown command", "place 0,0,south"
+	};
+
+	MockCommanderLogger logger;
+	ToyRobot robot(logger);
+	ScriptCommander commander(robot, logger, lines);
+
+	const auto allocationsBefore = g_allocations;
+
+	std::string_view args;
+	Command commands[8];
+	for (auto& cmd : commands)
+		cmd = commander.GetCommand(args);
+
+	// Successful place and move do not produce any log message either.
+	commander.Execute(cmdPLACE, " 1,2,EAST");
+	commander.Execute(cmdMOVE, "");
+
+	EXPECT_EQ(g_allocations, allocationsBefore);
+
+	EXPECT_EQ(commands[0], cmdPLACE);
+	EXPECT_EQ(commands[5], cmdEXIT);
+	EXPECT_EQ(commands[6], cmdUNKNOWN);
+	EXPECT_EQ(commands[7], cmdPLACE);
+}
+
+TEST(TestCommander, TestPlaceOnRuntimeBoard)
+{
+	const std::vector<std::string> lines = { "PLACE 4294967297,0,NORTH", "PLACE 4294967296,7,SOUTH", "MOVE", "REPORT" };
+
+	RecordingLogger logger;
+	RuntimeToyRobot robot(logger, RuntimeBoard(uint64_t(1) << 32, 10));
+	ScriptCommander commander(robot, logger, lines);
+	commander.Launch();
+
+	const auto& messages = logger.messages;
+	EXPECT_NE(std::find(messages.begin(), messages.end(), "ERROR - Invalid x coordinate. X should be in between 0-4294967296"), messages.end());
+	EXPECT_NE(std::find(messages.begin(), messages.end(), "INFO - Output: 4294967296,6,SOUTH"), messages.end());
+}
+
+TEST(TestCommander, TestPipeCommander)
+{
+	// A chunk smaller than a line makes the buffer grow, and lines straddle the chunks.
+	std::istringstream input("PLACE 1,2,EAST\r\nMOVE\n\nREPORT\nLEFT\nMOVE\nREPORT");
+
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	PipeCommander commander(input, robot, logger, 4);
+	commander.Launch();
+
+	const std::vector<std::string> expected = {
+		"INFO - Toy robot starting..",
+		"ERROR - Unknown command",
+		"INFO - Output: 2,2,EAST",
+		"INFO - Robot is now facing NORTH",
+		"INFO - Output: 2,3,NORTH",
+		"INFO - Toy robot quitting.."
+	};
+	EXPECT_EQ(logger.messages, expected);
+}
+
+/// <summary>
+/// File commander handing out its raw input lines.
+/// </summary>
+class LineReadingCommander : public FileCommander
+{
+public:
+	using FileCommander::FileCommander;
+
+	/// <summary>
+	/// Every line with the input offset after it.
+	/// </summary>
+	std::vector<std::pair<std::string, uint64_t>> ReadAll()
+	{
+		std::vector<std::pair<std::string, uint64_t>> lines;
+		std::string_view line;
+		while (TryReadLine(line))
+			lines.emplace_back(std::string(line), InputOffset());
+
+		return lines;
+	}
+};
+
+static const char CrLfScript[] = "PLACE 1,2,EAST\r\nMOVE\r\n\r\nREPORT\r";
+
+static const std::vector<std::pair<std::string, uint64_t>> CrLfLines = {
+	{ "PLACE 1,2,EAST", 16 }, { "MOVE", 22 }, { "", 24 }, { "REPORT", 31 }
+};
+
+TEST(TestCommander, TestFileCommanderCrLfMapped)
+{
+	const auto path = std::filesystem::temp_directory_path() / "toyrobot_crlf.txt";
+	std::ofstream(path, std::ios::binary) << CrLfScript;
+
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	{
+		LineReadingCommander commander(path.string(), robot, logger);
+		EXPECT_TRUE(commander.IsMapped());
+		EXPECT_EQ(commander.ReadAll(), CrLfLines);
+	}
+
+	std::filesystem::remove(path);
+}
+
+#if defined(__linux__)
+
+TEST(TestCommander, TestFileCommanderCrLfStream)
+{
+	// A pipe can not be mapped, it is read through the stream. Holding it open for reading and writing keeps
+	// the script in it while the commander opens it, and closing it ends the input.
+	const auto path = std::filesystem::temp_directory_path() / "toyrobot_crlf.fifo";
+	std::filesystem::remove(path);
+	ASSERT_EQ(mkfifo(path.c_str(), 0600), 0);
+
+	const auto fifo = open(path.c_str(), O_RDWR);
+	ASSERT_GE(fifo, 0);
+	ASSERT_EQ(write(fifo, CrLfScript, sizeof(CrLfScript) - 1), static_cast<ssize_t>(sizeof(CrLfScript) - 1));
+
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	{
+		LineReadingCommander commander(path.string(), robot, logger);
+		close(fifo);
+		EXPECT_FALSE(commander.IsMapped());
+		EXPECT_EQ(commander.ReadAll(), CrLfLines);
+	}
+
+	std::filesystem::remove(path);
+}
+
+#endif
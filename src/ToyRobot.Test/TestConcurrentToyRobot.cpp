@@ -0,0 +1,143 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "ConcurrentToyRobot.h"
+#include "TestUtils.h"
+#include <random>
+#include <thread>
+
+TEST(TestConcurrentToyRobot, TestMatchesToyRobot)
+{
+	RecordingLogger expectedLogger;
+	RecordingLogger actualLogger;
+	ToyRobot expected(expectedLogger);
+	ConcurrentToyRobot actual(actualLogger);
+
+	std::mt19937 random(5);
+	for (auto step = 0; step < 5000; step++)
+	{
+		switch (random() % 8)
+		{
+		case 0:
+		{
+			const auto x = static_cast<int64_t>(random() % 9) - 2;
+			const auto y = static_cast<int64_t>(random() % 9) - 2;
+			const auto facingDirection = static_cast<FacingDirection>(random() % 5);
+			EXPECT_EQ(actual.TryPlace(x, y, facingDirection), expected.TryPlace(x, y, facingDirection));
+			break;
+		}
+		case 1:
+			EXPECT_EQ(actual.TryTurnLeft(), expected.TryTurnLeft());
+			break;
+		case 2:
+			EXPECT_EQ(actual.TryTurnRight(), expected.TryTurnRight());
+			break;
+		case 3:
+			if (random() % 20 == 0)
+			{
+				// Start over, so that PLACE is tried again.
+				const RobotState state{ 0, 0, fdUNKNOWN, false };
+				EXPECT_TRUE(expected.TryRestoreState(state));
+				EXPECT_TRUE(actual.TryRestoreState(state));
+			}
+			break;
+		default:
+			EXPECT_EQ(actual.TryMove(), expected.TryMove());
+			break;
+		}
+
+		const auto actualState = actual.SaveState();
+		const auto expectedState = expected.SaveState();
+		ASSERT_EQ(actualState.x, expectedState.x);
+		ASSERT_EQ(actualState.y, expectedState.y);
+		ASSERT_EQ(actualState.facingDirection, expectedState.facingDirection);
+		ASSERT_EQ(actualState.placed, expectedState.placed);
+	}
+
+	EXPECT_EQ(actualLogger.messages, expectedLogger.messages);
+}
+
+TEST(TestConcurrentToyRobot, TestNoLostUpdates)
+{
+	RecordingLogger logger;
+	RuntimeConcurrentToyRobot robot(logger, RuntimeBoard(1000000, 1000000));
+	ASSERT_EQ(robot.Place(0, 0, fdNORTH), rrSUCCESS);
+
+	// Every thread moves and then turns four times, which leaves the robot facing north again,
+	// so every move of every thread must land and the turns must all count.
+	const auto threadCount = 4;
+	const auto rounds = 20000;
+	std::vector<std::thread> threads;
+	for (auto idx = 0; idx < threadCount; idx++)
+	{
+		threads.emplace_back([&robot]() {
+			FacingDirection facingDirection;
+			for (auto round = 0; round < rounds; round++)
+			{
+				robot.TurnRight(facingDirection);
+				robot.TurnRight(facingDirection);
+				robot.TurnRight(facingDirection);
+				robot.TurnRight(facingDirection);
+			}
+		});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	auto state = robot.SaveState();
+	EXPECT_EQ(state.facingDirection, fdNORTH);
+
+	threads.clear();
+	for (auto idx = 0; idx < threadCount; idx++)
+	{
+		threads.emplace_back([&robot]() {
+			for (auto round = 0; round < rounds; round++)
+				robot.Move();
+		});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	state = robot.SaveState();
+	EXPECT_EQ(state.x, 0u);
+	EXPECT_EQ(state.y, static_cast<uint64_t>(threadCount * rounds));
+	EXPECT_TRUE(state.placed);
+}
+
+TEST(TestConcurrentToyRobot, TestBoardLimit)
+{
+	RecordingLogger logger;
+	RuntimeConcurrentToyRobot robot(logger, RuntimeBoard(uint64_t(1) << 32, 9));
+	EXPECT_EQ(robot.MaxX(), RuntimeConcurrentToyRobot::CoordinateLimit);
+	EXPECT_EQ(robot.Place(RuntimeConcurrentToyRobot::CoordinateLimit + 1, 0, fdEAST), rrINVALID_X);
+	EXPECT_EQ(robot.Place(RuntimeConcurrentToyRobot::CoordinateLimit, 9, fdEAST), rrSUCCESS);
+	EXPECT_EQ(robot.Move(), rrEAST_EDGE);
+
+	uint64_t x;
+	uint64_t y;
+	FacingDirection facingDirection;
+	robot.ReportPosition(x, y, facingDirection);
+	EXPECT_EQ(x, RuntimeConcurrentToyRobot::CoordinateLimit);
+	EXPECT_EQ(y, 9u);
+	EXPECT_EQ(facingDirection, fdEAST);
+}
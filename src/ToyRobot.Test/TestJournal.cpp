@@ -0,0 +1,283 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "Journal.h"
+#include "ResultSink.h"
+#include "TestUtils.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <regex>
+
+namespace fs = std::filesystem;
+
+static void WriteScript(const fs::path& path, unsigned seed, size_t count)
+{
+	static const char* const commands[] = { "MOVE", "MOVE", "LEFT", "RIGHT", "REPORT", "PLACE 1,2,EAST", "PLACE 9,9,NORTH", "JUMP" };
+
+	std::mt19937 random(seed);
+	std::ofstream file(path, std::ios::binary);
+	file << "PLACE 0,0,NORTH\n";
+	for (size_t idx = 0; idx < count; idx++)
+		file << commands[random() % 8] << (idx % 5 == 0 ? "\r\n" : "\n");
+	file << "EXIT\n";
+}
+
+static void ExpectSameState(const RobotState& actual, const RobotState& expected)
+{
+	EXPECT_EQ(actual.x, expected.x);
+	EXPECT_EQ(actual.y, expected.y);
+	EXPECT_EQ(actual.facingDirection, expected.facingDirection);
+	EXPECT_EQ(actual.placed, expected.placed);
+}
+
+/// <summary>
+/// Run the script with a journal, resuming from it when asked, and return the final robot state.
+/// </summary>
+static RobotState RunJournaled(const fs::path& input, const fs::path& journalPath, bool resume, const JournalOptions& options)
+{
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	FileCommander commander(input.string(), robot, logger);
+	JournalWriter journal(journalPath.string(), robot, options);
+
+	auto finished = false;
+	std::string error;
+	EXPECT_TRUE(journal.TryOpen(commander, input.string(), resume, finished, error)) << error;
+	EXPECT_FALSE(finished);
+
+	commander.SetJournal(&journal);
+	commander.Launch();
+	return robot.SaveState();
+}
+
+TEST(TestJournal, TestResumeMatchesUninterrupted)
+{
+	const auto input = fs::temp_directory_path() / "toyrobot_journal_input.txt";
+	const auto journalPath = fs::temp_directory_path() / "toyrobot_journal.bin";
+	WriteScript(input, 7, 2000);
+
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	FileCommander commander(input.string(), robot, logger);
+	commander.Launch();
+	const auto expected = robot.SaveState();
+
+	JournalOptions options;
+	options.checkpointCommands = 37;
+	ExpectSameState(RunJournaled(input, journalPath, false, options), expected);
+
+	JournalScan scan;
+	std::string error;
+	ASSERT_TRUE(JournalWriter::TryScan(journalPath.string(), scan, error));
+	ASSERT_TRUE(scan.hasCheckpoint);
+	EXPECT_TRUE(scan.checkpoint.finished);
+	EXPECT_EQ(scan.checkpoint.inputOffset, fs::file_size(input));
+	EXPECT_EQ(scan.checkpointEnd, fs::file_size(journalPath));
+
+	// Cut the journal at arbitrary points, as a crash would, and resume from what is left.
+	const auto fullSize = fs::file_size(journalPath);
+	for (const auto length : { fullSize / 3, fullSize / 2 + 1, fullSize - 1, uint64_t(20) })
+	{
+		RunJournaled(input, journalPath, false, options);
+		fs::resize_file(journalPath, length);
+
+		ASSERT_TRUE(JournalWriter::TryScan(journalPath.string(), scan, error));
+		EXPECT_FALSE(scan.hasCheckpoint && scan.checkpoint.finished);
+
+		ExpectSameState(RunJournaled(input, journalPath, true, options), expected);
+
+		ASSERT_TRUE(JournalWriter::TryScan(journalPath.string(), scan, error));
+		EXPECT_TRUE(scan.checkpoint.finished);
+		EXPECT_EQ(fs::file_size(journalPath), fullSize);
+	}
+
+	fs::remove(input);
+	fs::remove(journalPath);
+}
+
+/// <summary>
+/// Run the script with a journal into a log file and a result file as the file mode does, resuming when asked.
+/// </summary>
+static void RunWithOutputs(const fs::path& input, const fs::path& journalPath, const fs::path& output, const fs::path& results, bool resume)
+{
+	std::string error;
+	if (resume)
+	{
+		ASSERT_TRUE(JournalWriter::TryRewindOutputs(journalPath.string(), output.string(), results.string(), error)) << error;
+	}
+
+	FileLoggerOptions logOptions;
+	logOptions.flushPolicy = fpON_EXIT;
+	FileLogger logger(output.string(), logOptions);
+	ResultSink sink(results.string(), rfCSV, resume ? roCONTINUE : roREPLACE, 64);
+	ToyRobot robot(logger);
+	FileCommander commander(input.string(), robot, logger);
+	commander.SetResultSink(&sink);
+
+	JournalOptions options;
+	options.checkpointCommands = 37;
+	JournalWriter journal(journalPath.string(), robot, options);
+	journal.SetOutputs(&logger, &sink);
+
+	auto finished = false;
+	ASSERT_TRUE(journal.TryOpen(commander, input.string(), resume, finished, error)) << error;
+	commander.SetJournal(&journal);
+	commander.Launch();
+}
+
+/// <summary>
+/// Content of a log file without its timestamps, and without the start line a resumed run logs again.
+/// </summary>
+static std::string ReadLog(const fs::path& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	const std::regex timestamp(R"(\d{2}-\d{2}-\d{4} \d{2}-\d{2}-\d{2} - )");
+	const std::regex start("INFO - Toy robot starting\\.\\.\n");
+	return std::regex_replace(std::regex_replace(content, timestamp, ""), start, "");
+}
+
+static std::string ReadFile(const fs::path& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+TEST(TestJournal, TestResumeDoesNotRepeatOutput)
+{
+	const auto input = fs::temp_directory_path() / "toyrobot_journal_input.txt";
+	const auto journalPath = fs::temp_directory_path() / "toyrobot_journal.bin";
+	const auto output = fs::temp_directory_path() / "toyrobot_journal_output.txt";
+	const auto results = fs::temp_directory_path() / "toyrobot_journal_results.csv";
+	WriteScript(input, 13, 2000);
+
+	// The log is appended to, what an earlier run left in it is kept.
+	std::ofstream(output, std::ios::binary) << "earlier run\n";
+	RunWithOutputs(input, journalPath, output, results, false);
+	const auto expectedLog = ReadLog(output);
+	const auto expectedResults = ReadFile(results);
+	ASSERT_NE(expectedLog.find("INFO - Toy robot quitting.."), std::string::npos);
+	ASSERT_GT(expectedResults.size(), 1000u);
+
+	const auto fullSize = fs::file_size(journalPath);
+	for (const auto length : { fullSize / 3, fullSize / 2 + 1, fullSize - 1, uint64_t(20) })
+	{
+		// The crashed run got further in its outputs than in its journal.
+		std::ofstream(output, std::ios::binary) << "earlier run\n";
+		RunWithOutputs(input, journalPath, output, results, false);
+		fs::resize_file(journalPath, length);
+
+		RunWithOutputs(input, journalPath, output, results, true);
+		EXPECT_EQ(ReadLog(output), expectedLog) << length;
+		EXPECT_EQ(ReadFile(results), expectedResults) << length;
+	}
+
+	fs::remove(input);
+	fs::remove(journalPath);
+	fs::remove(output);
+	fs::remove(results);
+}
+
+TEST(TestJournal, TestCheckpointEveryBytes)
+{
+	const auto input = fs::temp_directory_path() / "toyrobot_journal_input.txt";
+	const auto journalPath = fs::temp_directory_path() / "toyrobot_journal.bin";
+	WriteScript(input, 3, 1000);
+
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	FileCommander commander(input.string(), robot, logger);
+	JournalOptions options;
+	options.checkpointCommands = 0;
+	options.checkpointBytes = 1024;
+	JournalWriter journal(journalPath.string(), robot, options);
+
+	auto finished = false;
+	std::string error;
+	ASSERT_TRUE(journal.TryOpen(commander, input.string(), false, finished, error));
+	commander.SetJournal(&journal);
+	commander.Launch();
+
+	// One checkpoint per started KB of input, plus the final one.
+	EXPECT_EQ(journal.CheckpointCount(), fs::file_size(input) / 1024 + 1);
+	EXPECT_EQ(journal.CommandCount(), 1002u);
+
+	fs::remove(input);
+	fs::remove(journalPath);
+}
+
+TEST(TestJournal, TestDamagedCheckpointIsIgnored)
+{
+	const auto input = fs::temp_directory_path() / "toyrobot_journal_input.txt";
+	const auto journalPath = fs::temp_directory_path() / "toyrobot_journal.bin";
+	WriteScript(input, 5, 100);
+
+	JournalOptions options;
+	options.checkpointCommands = 10;
+	RunJournaled(input, journalPath, false, options);
+
+	// Flip a byte of the final checkpoint. The one before it is used instead.
+	{
+		std::fstream file(journalPath, std::ios::binary | std::ios::in | std::ios::out);
+		file.seekp(-10, std::ios::end);
+		file.put('\x7f');
+	}
+
+	JournalScan scan;
+	std::string error;
+	ASSERT_TRUE(JournalWriter::TryScan(journalPath.string(), scan, error));
+	ASSERT_TRUE(scan.hasCheckpoint);
+	EXPECT_FALSE(scan.checkpoint.finished);
+	EXPECT_EQ(scan.checkpoint.commandCount, 100u);
+
+	fs::remove(input);
+	fs::remove(journalPath);
+}
+
+TEST(TestJournal, TestRejectsChangedInput)
+{
+	const auto input = fs::temp_directory_path() / "toyrobot_journal_input.txt";
+	const auto journalPath = fs::temp_directory_path() / "toyrobot_journal.bin";
+	WriteScript(input, 11, 100);
+	RunJournaled(input, journalPath, false, JournalOptions());
+
+	std::ofstream(input, std::ios::app) << "MOVE\n";
+
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	FileCommander commander(input.string(), robot, logger);
+	JournalWriter journal(journalPath.string(), robot, JournalOptions());
+
+	auto finished = false;
+	std::string error;
+	EXPECT_FALSE(journal.TryOpen(commander, input.string(), true, finished, error));
+	EXPECT_EQ(error, "The input file changed since the journal was written: " + input.string());
+
+	std::ofstream(journalPath) << "not a journal";
+	EXPECT_FALSE(journal.TryOpen(commander, input.string(), true, finished, error));
+	EXPECT_EQ(error, "Unable to read the journal: " + journalPath.string());
+
+	fs::remove(input);
+	fs::remove(journalPath);
+}
@@ -0,0 +1,63 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "LineScanner.h"
+#include <string>
+#include <vector>
+
+static std::vector<std::string> ScanAll(const std::string& buffer)
+{
+	std::vector<std::string> lines;
+	LineScanner scanner(buffer.data(), buffer.data() + buffer.size());
+
+	std::string_view line;
+	while (scanner.TryNextLine(line))
+		lines.emplace_back(line);
+
+	return lines;
+}
+
+TEST(TestLineScanner, TestEmptyBuffer)
+{
+	EXPECT_TRUE(ScanAll("").empty());
+}
+
+TEST(TestLineScanner, TestLastLineWithoutNewline)
+{
+	const std::vector<std::string> expected = { "PLACE 3,3,NORTH", "MOVE", "REPORT" };
+	EXPECT_EQ(ScanAll("PLACE 3,3,NORTH\nMOVE\nREPORT"), expected);
+}
+
+TEST(TestLineScanner, TestCarriageReturnIsRemoved)
+{
+	const std::vector<std::string> expected = { "PLACE 3,3,NORTH", "", "REPORT" };
+	EXPECT_EQ(ScanAll("PLACE 3,3,NORTH\r\n\r\nREPORT\r\n"), expected);
+}
+
+TEST(TestLineScanner, TestLongLinesAcrossVectorBlocks)
+{
+	const std::string first(37, 'a');
+	const std::string second(16, 'b');
+	const std::string third(3, 'c');
+
+	const std::vector<std::string> expected = { first, second, third };
+	EXPECT_EQ(ScanAll(first + "\n" + second + "\n" + third + "\n"), expected);
+}
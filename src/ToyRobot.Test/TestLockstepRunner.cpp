@@ -0,0 +1,103 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "LockstepRunner.h"
+#include "TestUtils.h"
+#include <random>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// REPORT output of the commander for the given script.
+/// </summary>
+static std::vector<std::string> LaunchReports(const std::vector<std::string>& lines)
+{
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	ScriptCommander commander(robot, logger, lines);
+	commander.Launch();
+
+	const std::string prefix = "INFO - Output: ";
+	std::vector<std::string> reports;
+	for (const auto& message : logger.messages)
+	{
+		if (message.rfind(prefix, 0) == 0)
+			reports.push_back(message.substr(7));
+	}
+
+	return reports;
+}
+
+/// <summary>
+/// Random scripts of different lengths, some ending early on EXIT.
+/// </summary>
+static std::vector<std::vector<std::string>> MakeRandomScripts(size_t count)
+{
+	std::mt19937 random(11);
+	std::uniform_int_distribution<size_t> length(0, 80);
+
+	std::vector<std::vector<std::string>> scripts(count);
+	for (size_t idx = 0; idx < count; idx++)
+		scripts[idx] = MakeRandomLines(static_cast<unsigned>(idx), length(random), { "PLACE 5,5,SOUTH", "EXIT" });
+
+	return scripts;
+}
+
+static void ExpectSameReports(SimdLevel level)
+{
+	const auto scripts = MakeRandomScripts(133);
+
+	std::vector<CommandProgram> programs(scripts.size());
+	for (size_t idx = 0; idx < scripts.size(); idx++)
+	{
+		for (const auto& line : scripts[idx])
+			programs[idx].CompileLine(line);
+	}
+
+	LockstepRunner runner(level);
+	std::vector<std::vector<std::string>> reports;
+	runner.Run(programs, reports);
+
+	ASSERT_EQ(reports.size(), scripts.size());
+	for (size_t idx = 0; idx < scripts.size(); idx++)
+		EXPECT_EQ(reports[idx], LaunchReports(scripts[idx])) << "script " << idx;
+}
+
+TEST(TestLockstepRunner, TestScalarMatchesCommander)
+{
+	ExpectSameReports(slSCALAR);
+}
+
+TEST(TestLockstepRunner, TestSse41MatchesCommander)
+{
+	ExpectSameReports(slSSE41);
+}
+
+TEST(TestLockstepRunner, TestAvx2MatchesCommander)
+{
+	ExpectSameReports(slAVX2);
+}
+
+TEST(TestLockstepRunner, TestLevelIsLimitedByCpu)
+{
+	EXPECT_LE(LockstepRunner(slAVX2).Level(), LockstepRunner::DetectSimdLevel());
+	EXPECT_EQ(LockstepRunner(slSCALAR).Level(), slSCALAR);
+}
@@ -0,0 +1,239 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "Logger.h"
+#include "TestUtils.h"
+#include <filesystem>
+#include <regex>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Logger keeping only the last formatted record.
+/// </summary>
+class LastRecordLogger : public LoggerBase
+{
+public:
+	std::string_view lastRecord;
+
+protected:
+	void Print(std::string_view msgType, std::string_view msg, std::string_view /*end*/) override
+	{
+		lastRecord = FormatLogMsg(msgType, msg);
+	}
+};
+
+TEST(TestLoggerBase, TestRecordFormat)
+{
+	LastRecordLogger logger;
+	logger.Warn("Robot going to move over the north edge.");
+
+	const std::regex format(R"(\d{2}-\d{2}-\d{4} \d{2}-\d{2}-\d{2} - WARN - Robot going to move over the north edge\.)");
+	EXPECT_TRUE(std::regex_match(std::string(logger.lastRecord), format));
+}
+
+TEST(TestLoggerBase, TestFormattingDoesNotAllocate)
+{
+	LastRecordLogger logger;
+	logger.Info("Warm up the buffer with a message that is long enough for the rest.");
+
+	const auto allocationsBefore = g_allocations;
+	for (int idx = 0; idx < 1000; idx++)
+	{
+		logger.Info("Output: 1,2,NORTH");
+		logger.Error("Move failed.");
+	}
+
+	EXPECT_EQ(g_allocations, allocationsBefore);
+	EXPECT_NE(logger.lastRecord.find(" - ERROR - Move failed."), std::string_view::npos);
+}
+
+TEST(TestLoggerBase, TestRuntimeLevel)
+{
+	RecordingLogger logger;
+	logger.SetLevel(llWARN);
+
+	logger.Info("info");
+	logger.Warn("warn");
+	logger.Error("error");
+	logger.Output("output");
+
+	const std::vector<std::string> expected = { "WARN - warn", "ERROR - error", "INFO - output" };
+	EXPECT_EQ(logger.messages, expected);
+}
+
+TEST(TestLoggerBase, TestLazyMessageIsOnlyBuiltWhenEnabled)
+{
+	RecordingLogger logger;
+	logger.SetLevel(llERROR);
+
+	auto built = 0;
+	logger.Warn([&]() { built++; return std::string("warn"); });
+	EXPECT_EQ(built, 0);
+
+	logger.Error([&]() { built++; return "error " + std::to_string(built); });
+	EXPECT_EQ(built, 1);
+
+	const std::vector<std::string> expected = { "ERROR - error 1" };
+	EXPECT_EQ(logger.messages, expected);
+}
+
+class TestFileLogger : public testing::Test
+{
+public:
+	void SetUp() override
+	{
+		m_path = (std::filesystem::temp_directory_path() / "toyrobot_test_filelogger.txt").string();
+		std::filesystem::remove(m_path);
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove(m_path);
+	}
+
+	std::vector<std::string> ReadLines()
+	{
+		std::vector<std::string> lines;
+		std::ifstream file(m_path);
+		std::string line;
+		while (std::getline(file, line))
+			lines.push_back(line.substr(line.find(" - ") + 3));
+
+		return lines;
+	}
+
+protected:
+	std::string m_path;
+};
+
+TEST_F(TestFileLogger, TestRecordsAreWrittenInOrder)
+{
+	{
+		FileLogger logger(m_path);
+		for (int idx = 0; idx < 1000; idx++)
+			logger.Info(std::to_string(idx));
+	}
+
+	const auto lines = ReadLines();
+	ASSERT_EQ(lines.size(), 1000u);
+	for (int idx = 0; idx < 1000; idx++)
+		EXPECT_EQ(lines[idx], "INFO - " + std::to_string(idx));
+}
+
+TEST_F(TestFileLogger, TestSyncErrorIsFlushedBeforeReturning)
+{
+	FileLoggerOptions options;
+	options.flushPolicy = fpSYNC_ERRORS;
+
+	FileLogger logger(m_path, options);
+	logger.Info("first");
+	logger.Error("second");
+
+	const auto lines = ReadLines();
+	ASSERT_EQ(lines.size(), 2u);
+	EXPECT_EQ(lines[0], "INFO - first");
+	EXPECT_EQ(lines[1], "ERROR - second");
+}
+
+TEST_F(TestFileLogger, TestConcurrentSyncErrors)
+{
+	// No timer to fall back on, every waiting producer relies on the writer flushing past its record.
+	FileLoggerOptions options;
+	options.flushPolicy = fpSYNC_ERRORS;
+	options.queueCapacity = 16;
+
+	FileLogger logger(m_path, options);
+	std::vector<std::thread> producers;
+	for (int producer = 0; producer < 8; producer++)
+	{
+		producers.emplace_back([&logger, producer]() {
+			for (int idx = 0; idx < 2000; idx++)
+			{
+				if (idx % 3 == 0)
+					logger.Info(std::to_string(producer) + ":" + std::to_string(idx));
+				logger.Error(std::to_string(producer) + ":" + std::to_string(idx));
+			}
+		});
+	}
+
+	for (auto& producer : producers)
+		producer.join();
+
+	// The last record of every producer is an ERROR, so everything is on the disk already.
+	EXPECT_EQ(ReadLines().size(), 8u * (2000 + 667));
+}
+
+TEST_F(TestFileLogger, TestMultipleProducers)
+{
+	FileLoggerOptions options;
+	options.flushPolicy = fpEVERY_N_RECORDS;
+	options.flushRecords = 16;
+	options.queueCapacity = 64;
+
+	{
+		FileLogger logger(m_path, options);
+		std::vector<std::thread> producers;
+		for (int producer = 0; producer < 4; producer++)
+		{
+			producers.emplace_back([&logger, producer]() {
+				for (int idx = 0; idx < 1000; idx++)
+					logger.Info(std::to_string(producer) + ":" + std::to_string(idx));
+			});
+		}
+
+		for (auto& producer : producers)
+			producer.join();
+	}
+
+	const auto lines = ReadLines();
+	ASSERT_EQ(lines.size(), 4000u);
+
+	// Records of each producer keep their order.
+	int next[4] = { 0, 0, 0, 0 };
+	for (const auto& line : lines)
+	{
+		const auto producer = line[7] - '0';
+		EXPECT_EQ(line, "INFO - " + std::to_string(producer) + ":" + std::to_string(next[producer]));
+		next[producer]++;
+	}
+}
+
+TEST_F(TestFileLogger, TestDropWhenQueueIsFull)
+{
+	FileLoggerOptions options;
+	options.flushPolicy = fpON_EXIT;
+	options.queueCapacity = 2;
+	options.queueFullPolicy = qfDROP;
+
+	uint64_t dropped = 0;
+	{
+		FileLogger logger(m_path, options);
+		for (int idx = 0; idx < 1000; idx++)
+			logger.Info(std::to_string(idx));
+
+		dropped = logger.DroppedRecords();
+	}
+
+	EXPECT_EQ(ReadLines().size() + dropped, 1000u);
+}
@@ -0,0 +1,112 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "OccupancyIndex.h"
+#include "TestUtils.h"
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+template <typename TIndex>
+static void ExpectOccupyAndRelease(TIndex& index, uint64_t maxX, uint64_t maxY)
+{
+	EXPECT_FALSE(index.IsOccupied(0, 0));
+	EXPECT_FALSE(index.IsOccupied(maxX, maxY));
+
+	index.Occupy(0, 0);
+	index.Occupy(maxX, maxY);
+	index.Occupy(maxX, 0);
+	EXPECT_TRUE(index.IsOccupied(0, 0));
+	EXPECT_TRUE(index.IsOccupied(maxX, maxY));
+	EXPECT_FALSE(index.IsOccupied(0, maxY));
+	EXPECT_EQ(index.Count(), 3u);
+
+	index.Release(maxX, maxY);
+	EXPECT_FALSE(index.IsOccupied(maxX, maxY));
+	EXPECT_EQ(index.Count(), 2u);
+}
+
+TEST(TestOccupancyIndex, TestDense)
+{
+	DenseOccupancy index(99, 49);
+	ExpectOccupyAndRelease(index, 99, 49);
+
+	EXPECT_TRUE(DenseOccupancy::Fits(9999, 9999, 12500000));
+	EXPECT_FALSE(DenseOccupancy::Fits(9999, 9999, 12499999));
+	EXPECT_FALSE(DenseOccupancy::Fits(uint64_t(1) << 32, uint64_t(1) << 32, uint64_t(1) << 40));
+}
+
+TEST(TestOccupancyIndex, TestSparse)
+{
+	SparseOccupancy index;
+	ExpectOccupyAndRelease(index, uint64_t(1) << 32, uint64_t(1) << 32);
+}
+
+TEST(TestOccupancyIndex, TestRobotsCollide)
+{
+	RecordingLogger logger;
+	const RuntimeBoard board(9, 9);
+	DenseOccupancy index(9, 9);
+	index.Occupy(5, 5);
+
+	DenseSharedToyRobot first(logger, board, SharedOccupancy<DenseOccupancy>(index));
+	DenseSharedToyRobot second(logger, board, SharedOccupancy<DenseOccupancy>(index));
+
+	EXPECT_EQ(first.Place(5, 5, fdNORTH), rrOCCUPIED);
+	EXPECT_EQ(first.Place(1, 1, fdEAST), rrSUCCESS);
+	EXPECT_EQ(second.Place(1, 1, fdNORTH), rrOCCUPIED);
+	EXPECT_EQ(second.Place(2, 1, fdNORTH), rrSUCCESS);
+
+	EXPECT_FALSE(first.TryMove());
+	EXPECT_EQ(logger.messages.back(), "WARN - Robot going to move into an occupied cell. Command is ignored for safety.");
+
+	EXPECT_EQ(second.Move(), rrSUCCESS);
+	EXPECT_EQ(first.Move(), rrSUCCESS);
+	EXPECT_FALSE(index.IsOccupied(1, 1));
+	EXPECT_TRUE(index.IsOccupied(2, 1));
+	EXPECT_TRUE(index.IsOccupied(2, 2));
+	EXPECT_EQ(index.Count(), 3u);
+
+	// Edges are still reported as edges, not as collisions.
+	EXPECT_EQ(first.TurnRight(), rrSUCCESS);
+	EXPECT_EQ(first.Move(), rrSUCCESS);
+	EXPECT_EQ(first.Move(), rrSOUTH_EDGE);
+}
+
+TEST(TestOccupancyIndex, TestReadObstacleMap)
+{
+	const auto path = fs::temp_directory_path() / "toyrobot_obstacles.txt";
+	std::ofstream(path) << "# obstacles\n1,2\r\n\n 3,4\n";
+
+	std::vector<std::pair<uint64_t, uint64_t>> cells;
+	std::string error;
+	ASSERT_TRUE(TryReadObstacleMap(path.string(), 5, 5, cells, error));
+	ASSERT_EQ(cells.size(), 2u);
+	EXPECT_EQ(cells[0], std::make_pair(uint64_t(1), uint64_t(2)));
+	EXPECT_EQ(cells[1], std::make_pair(uint64_t(3), uint64_t(4)));
+
+	std::ofstream(path) << "1,2\n6,0\n";
+	EXPECT_FALSE(TryReadObstacleMap(path.string(), 5, 5, cells, error));
+	EXPECT_EQ(error, "Obstacle is outside the board: 6,0");
+
+	fs::remove(path);
+}
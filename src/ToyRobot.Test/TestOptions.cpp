@@ -0,0 +1,83 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "Options.h"
+#include <string>
+#include <vector>
+
+static bool ParseOptions(std::vector<std::string> args, ProgramOptions& options, std::string& error)
+{
+	args.insert(args.begin(), "toyrobot");
+	std::vector<char*> argv;
+	for (auto& arg : args)
+		argv.push_back(arg.data());
+
+	return TryParseOptions(static_cast<int>(argv.size()), argv.data(), options, error);
+}
+
+TEST(TestOptions, TestDefaultFlushPolicy)
+{
+	ProgramOptions options;
+	std::string error;
+	ASSERT_TRUE(ParseOptions({ "in.txt", "out.txt" }, options, error)) << error;
+	EXPECT_EQ(options.logOptions.flushPolicy, fpEVERY_T_MILLISECONDS);
+}
+
+TEST(TestOptions, TestFlushOnExitKeepsSyncErrors)
+{
+	for (const auto& args : { std::vector<std::string>{ "--flush-on-exit", "--sync-errors" }, std::vector<std::string>{ "--sync-errors", "--flush-on-exit" } })
+	{
+		ProgramOptions options;
+		std::string error;
+		ASSERT_TRUE(ParseOptions(args, options, error)) << error;
+		EXPECT_EQ(options.logOptions.flushPolicy, fpSYNC_ERRORS) << args[0];
+	}
+
+	ProgramOptions options;
+	std::string error;
+	ASSERT_TRUE(ParseOptions({ "--flush-on-exit" }, options, error)) << error;
+	EXPECT_EQ(options.logOptions.flushPolicy, fpON_EXIT);
+}
+
+TEST(TestOptions, TestFlushOnExitRejectsPeriodicFlush)
+{
+	for (const auto& args : {
+		std::vector<std::string>{ "--flush-on-exit", "--flush-ms=10" },
+		std::vector<std::string>{ "--flush-ms=10", "--flush-on-exit" },
+		std::vector<std::string>{ "--flush-records=5", "--flush-on-exit" },
+		std::vector<std::string>{ "--flush-on-exit", "--flush-records=5" } })
+	{
+		ProgramOptions options;
+		std::string error;
+		EXPECT_FALSE(ParseOptions(args, options, error)) << args[0];
+		EXPECT_NE(error.find("--flush-on-exit"), std::string::npos);
+	}
+}
+
+TEST(TestOptions, TestPeriodicFlushPolicies)
+{
+	ProgramOptions options;
+	std::string error;
+	ASSERT_TRUE(ParseOptions({ "--sync-errors", "--flush-records=5", "--flush-ms=10" }, options, error)) << error;
+	EXPECT_EQ(options.logOptions.flushPolicy, fpEVERY_T_MILLISECONDS | fpEVERY_N_RECORDS | fpSYNC_ERRORS);
+	EXPECT_EQ(options.logOptions.flushRecords, 5u);
+	EXPECT_EQ(options.logOptions.flushMilliseconds, 10u);
+}
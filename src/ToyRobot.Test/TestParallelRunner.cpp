@@ -0,0 +1,124 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "ParallelRunner.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/// <summary>
+/// Log lines of the file without their timestamps, and without the statistics summary.
+/// </summary>
+static std::vector<std::string> ReadMessages(const std::string& path)
+{
+	std::ifstream file(path);
+	std::vector<std::string> messages;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (line.find(" - INFO - Stats: ") == std::string::npos)
+			messages.push_back(line.substr(line.find(" - ") + 3));
+	}
+
+	return messages;
+}
+
+class TestParallelRunner : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		m_directory = fs::temp_directory_path() / ("toyrobot_parallel_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+		fs::remove_all(m_directory);
+		fs::create_directories(m_directory / "in");
+	}
+
+	void TearDown() override
+	{
+		fs::remove_all(m_directory);
+	}
+
+	std::string Write(const std::string& name, const std::string& text)
+	{
+		const auto path = (m_directory / "in" / name).string();
+		std::ofstream(path) << text;
+		return path;
+	}
+
+	fs::path m_directory;
+};
+
+TEST(TestWildcard, TestMatches)
+{
+	EXPECT_TRUE(MatchesWildcard("commands.txt", "*.txt"));
+	EXPECT_TRUE(MatchesWildcard("commands.txt", "c?mmands*"));
+	EXPECT_TRUE(MatchesWildcard("a.txt", "*"));
+	EXPECT_FALSE(MatchesWildcard("commands.txt", "*.log"));
+	EXPECT_FALSE(MatchesWildcard("commands.txt", "?commands.txt"));
+}
+
+TEST_F(TestParallelRunner, TestExpandInputs)
+{
+	Write("b.txt", "");
+	Write("a.txt", "");
+	Write("c.log", "");
+
+	std::vector<std::string> files;
+	std::string error;
+	ASSERT_TRUE(TryExpandInputs({ (m_directory / "in" / "*.txt").string() }, files, error));
+	ASSERT_EQ(files.size(), 2u);
+	EXPECT_EQ(fs::path(files[0]).filename(), "a.txt");
+	EXPECT_EQ(fs::path(files[1]).filename(), "b.txt");
+
+	files.clear();
+	ASSERT_TRUE(TryExpandInputs({ (m_directory / "in").string() }, files, error));
+	EXPECT_EQ(files.size(), 3u);
+
+	EXPECT_FALSE(TryExpandInputs({ (m_directory / "in" / "*.csv").string() }, files, error));
+	EXPECT_FALSE(TryExpandInputs({ (m_directory / "missing.txt").string() }, files, error));
+}
+
+TEST_F(TestParallelRunner, TestEveryFileGetsItsOwnOutput)
+{
+	const std::vector<std::string> files = {
+		Write("small.txt", "PLACE 0,0,NORTH\nREPORT\n"),
+		Write("large.txt", "PLACE 1,2,EAST\nMOVE\nMOVE\nLEFT\nMOVE\nREPORT\nEXIT\n"),
+		(m_directory / "in" / "missing.txt").string()
+	};
+
+	for (const auto compile : { false, true })
+	{
+		const auto output = (m_directory / (compile ? "compiled" : "launched")).string();
+		ParallelRunner runner(2, compile, llWARN);
+		const auto results = runner.Run(files, output);
+
+		ASSERT_EQ(results.size(), 3u);
+		EXPECT_TRUE(results[0].succeeded);
+		EXPECT_TRUE(results[1].succeeded);
+		EXPECT_FALSE(results[2].succeeded);
+
+		EXPECT_EQ(ReadMessages(results[0].outputFile), std::vector<std::string>{ "INFO - Output: 0,0,NORTH" });
+		EXPECT_EQ(ReadMessages(results[1].outputFile), std::vector<std::string>{ "INFO - Output: 3,3,NORTH" });
+	}
+}
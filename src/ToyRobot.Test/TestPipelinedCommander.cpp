@@ -0,0 +1,134 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "PipelinedCommander.h"
+#include "SpscRingBuffer.h"
+#include "TestUtils.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/// <summary>
+/// Script mixing every kind of line, CRLF terminators and a last line without terminator.
+/// </summary>
+static std::string MakeScript(unsigned seed, size_t lineCount)
+{
+	return "PLACE 0,0,NORTH\n" + JoinLines(MakeRandomLines(seed, lineCount, { "PLACE 3,3,WEST\r" }));
+}
+
+static std::vector<std::string> RunPipe(const std::string& script)
+{
+	std::istringstream input(script);
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	PipeCommander commander(input, robot, logger);
+	commander.Launch();
+	return logger.messages;
+}
+
+static std::vector<std::string> RunPipelined(const std::string& script, size_t chunkSize)
+{
+	std::istringstream input(script);
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	PipelinedCommander commander(input, robot, logger, chunkSize);
+	commander.Launch();
+	return logger.messages;
+}
+
+TEST(TestPipelinedCommander, TestSpscRingBufferKeepsOrder)
+{
+	const uint64_t count = 100000;
+	SpscRingBuffer<uint64_t> queue(64);
+	EXPECT_EQ(queue.Capacity(), 64u);
+
+	std::thread producer([&queue]() {
+		for (uint64_t value = 0; value < count; value++)
+		{
+			auto pushed = value;
+			while (!queue.TryPush(pushed))
+				std::this_thread::yield();
+		}
+	});
+
+	auto ordered = true;
+	for (uint64_t expected = 0; expected < count; expected++)
+	{
+		uint64_t value = 0;
+		while (!queue.TryPop(value))
+			std::this_thread::yield();
+
+		ordered = ordered && value == expected;
+	}
+
+	producer.join();
+	EXPECT_TRUE(ordered);
+
+	uint64_t value = 0;
+	EXPECT_FALSE(queue.TryPop(value));
+}
+
+TEST(TestPipelinedCommander, TestMatchesPipeCommander)
+{
+	// Tiny chunks split lines and CRLF terminators, large ones fill several batches per chunk.
+	const auto script = MakeScript(23, 5000);
+	const auto expected = RunPipe(script);
+	for (const size_t chunkSize : { 1, 7, 4096, 1 << 20 })
+		EXPECT_EQ(RunPipelined(script, chunkSize), expected) << "chunk size " << chunkSize;
+
+	EXPECT_EQ(RunPipelined("", 16), RunPipe(""));
+	EXPECT_EQ(RunPipelined("PLACE 1,1,EAST\nREPORT", 16), RunPipe("PLACE 1,1,EAST\nREPORT"));
+}
+
+TEST(TestPipelinedCommander, TestStopsAtExit)
+{
+	auto script = MakeScript(5, 100) + "\nREPORT\nEXIT\n";
+	script += MakeScript(6, 200000);
+
+	const auto messages = RunPipelined(script, 64);
+	EXPECT_EQ(messages, RunPipe(script));
+	EXPECT_EQ(messages.back(), "INFO - Toy robot quitting..");
+}
+
+TEST(TestPipelinedCommander, TestMatchesFileCommander)
+{
+	const auto path = fs::temp_directory_path() / "toyrobot_pipelined_input.txt";
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << MakeScript(41, 3000);
+	}
+
+	RecordingLogger fileLogger;
+	ToyRobot fileRobot(fileLogger);
+	FileCommander(path.string(), fileRobot, fileLogger).Launch();
+
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	PipelinedCommander(path.string(), robot, logger).Launch();
+
+	EXPECT_EQ(logger.messages, fileLogger.messages);
+	fs::remove(path);
+}
@@ -0,0 +1,148 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "CommandProgram.h"
+#include "Commander.h"
+#include "ResultSink.h"
+#include "TestUtils.h"
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const char* const s_script = "PLACE 1,2,EAST\nREPORT\nMOVE\nLEFT\nREPORT\nJUMP\nPLACE 9,9,NORTH\nRIGHT\nRIGHT\nREPORT\n";
+
+TEST(TestResultSink, TestFormatPosition)
+{
+	char buffer[MaxPositionLength];
+	EXPECT_EQ(std::string(buffer, FormatPosition(buffer, 0, 4, fdNORTH)), "0,4,NORTH");
+	EXPECT_EQ(std::string(buffer, FormatPosition(buffer, UINT64_MAX, UINT64_MAX, fdUNKNOWN)), "18446744073709551615,18446744073709551615,UNKNOWN");
+	EXPECT_EQ(std::string(buffer, FormatPosition(buffer, 3, 1, static_cast<FacingDirection>(9))), "3,1,UNKNOWN");
+}
+
+TEST(TestResultSink, TestCsvStream)
+{
+	std::ostringstream output;
+	{
+		ResultSink sink(output, rfCSV, 1);
+		sink.Write(1, 2, fdEAST);
+		sink.Write(0, 0, fdWEST);
+		EXPECT_EQ(sink.RecordCount(), 2u);
+	}
+
+	EXPECT_EQ(output.str(), "x,y,facing\n1,2,EAST\n0,0,WEST\n");
+}
+
+TEST(TestResultSink, TestRoundTrip)
+{
+	const auto path = (fs::temp_directory_path() / "toyrobot_results.bin").string();
+
+	for (const auto format : { rfCSV, rfBINARY })
+	{
+		std::vector<ResultRecord> expected;
+		{
+			// A small buffer makes the sink write out many times.
+			ResultSink sink(path, format, 100);
+			ASSERT_TRUE(sink.IsOpen());
+			for (uint64_t idx = 0; idx < 1000; idx++)
+			{
+				ResultRecord record;
+				record.x = idx * 7919;
+				record.y = UINT64_MAX - idx;
+				record.facingDirection = static_cast<FacingDirection>(idx % 5);
+				sink.Write(record.x, record.y, record.facingDirection);
+				expected.push_back(record);
+			}
+		}
+
+		if (format == rfBINARY)
+		{
+			EXPECT_EQ(fs::file_size(path), ResultHeaderSize + 1000 * ResultRecordSize);
+		}
+
+		std::vector<ResultRecord> records;
+		std::string error;
+		ASSERT_TRUE(ResultSink::TryReadFile(path, records, error)) << error;
+		ASSERT_EQ(records.size(), expected.size());
+		for (size_t idx = 0; idx < records.size(); idx++)
+		{
+			EXPECT_EQ(records[idx].x, expected[idx].x);
+			EXPECT_EQ(records[idx].y, expected[idx].y);
+			EXPECT_EQ(records[idx].facingDirection, expected[idx].facingDirection);
+		}
+	}
+
+	fs::remove(path);
+}
+
+TEST(TestResultSink, TestCommanderSeparatesResults)
+{
+	std::istringstream input(s_script);
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	std::ostringstream output;
+	{
+		ResultSink sink(output, rfCSV);
+		PipeCommander commander(input, robot, logger);
+		commander.SetResultSink(&sink);
+		commander.Launch();
+	}
+
+	EXPECT_EQ(output.str(), "x,y,facing\n1,2,EAST\n2,2,NORTH\n2,2,SOUTH\n");
+
+	// The diagnostics stay in the log, only without the reports.
+	std::istringstream logInput(s_script);
+	RecordingLogger expectedLogger;
+	ToyRobot expectedRobot(expectedLogger);
+	PipeCommander expectedCommander(logInput, expectedRobot, expectedLogger);
+	expectedCommander.Launch();
+
+	std::vector<std::string> expected;
+	for (const auto& message : expectedLogger.messages)
+	{
+		if (message.find("Output: ") == std::string::npos)
+			expected.push_back(message);
+	}
+
+	EXPECT_EQ(logger.messages, expected);
+}
+
+TEST(TestResultSink, TestProgramRunnerWritesSink)
+{
+	CommandProgram program;
+	program.CompileText(s_script);
+
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	std::ostringstream output;
+	{
+		ResultSink sink(output, rfCSV);
+		ProgramRunner runner(robot, logger);
+		runner.SetResultSink(&sink);
+		runner.RunLazy(program);
+	}
+
+	EXPECT_EQ(output.str(), "x,y,facing\n1,2,EAST\n2,2,NORTH\n2,2,SOUTH\n");
+	for (const auto& message : logger.messages)
+		EXPECT_EQ(message.find("Output: "), std::string::npos) << message;
+}
@@ -0,0 +1,143 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "RobotFleet.h"
+#include "ToyRobot.h"
+#include "TestUtils.h"
+#include <random>
+#include <vector>
+
+TEST(TestRobotFleet, TestNotPlaced)
+{
+	RobotFleet fleet(3);
+	std::vector<uint8_t> results(fleet.Size());
+
+	EXPECT_EQ(fleet.Move(results.data()), 0u);
+	EXPECT_EQ(results, std::vector<uint8_t>(3, rrNOT_PLACED));
+
+	EXPECT_EQ(fleet.TurnLeft(results.data()), 0u);
+	EXPECT_EQ(results, std::vector<uint8_t>(3, rrNOT_PLACED));
+
+	uint8_t x;
+	uint8_t y;
+	FacingDirection facingDirection;
+	EXPECT_FALSE(fleet.Report(0, x, y, facingDirection));
+}
+
+TEST(TestRobotFleet, TestPlaceAndEdges)
+{
+	RobotFleet fleet(4);
+	const uint8_t xs[] = { 0, 5, 6, 2 };
+	const uint8_t ys[] = { 5, 0, 0, 9 };
+	const uint8_t facingDirections[] = { fdNORTH, fdEAST, fdWEST, fdSOUTH };
+	uint8_t results[4];
+
+	EXPECT_EQ(fleet.Place(xs, ys, facingDirections, results), 2u);
+	EXPECT_EQ(results[0], rrSUCCESS);
+	EXPECT_EQ(results[1], rrSUCCESS);
+	EXPECT_EQ(results[2], rrINVALID_X);
+	EXPECT_EQ(results[3], rrINVALID_Y);
+
+	EXPECT_EQ(fleet.Place(0, 1, 1, fdSOUTH), rrALREADY_PLACED);
+
+	EXPECT_EQ(fleet.Move(results), 0u);
+	EXPECT_EQ(results[0], rrNORTH_EDGE);
+	EXPECT_EQ(results[1], rrEAST_EDGE);
+	EXPECT_EQ(results[2], rrNOT_PLACED);
+
+	uint64_t mask = ~0ull;
+	const uint8_t commands[] = { cmdTURN_RIGHT, cmdTURN_RIGHT, cmdMOVE, cmdREPORT };
+	EXPECT_EQ(fleet.Step(commands, results), 3u);
+	RobotFleet::ToSuccessMask(results, 4, &mask);
+	EXPECT_EQ(mask, 0b1011u);
+
+	uint8_t x;
+	uint8_t y;
+	FacingDirection facingDirection;
+	ASSERT_TRUE(fleet.Report(1, x, y, facingDirection));
+	EXPECT_EQ(x, 5);
+	EXPECT_EQ(y, 0);
+	EXPECT_EQ(facingDirection, fdSOUTH);
+}
+
+TEST(TestRobotFleet, TestMatchesToyRobot)
+{
+	const size_t robots = 257;
+	const int steps = 200;
+
+	std::mt19937 random(7);
+	std::uniform_int_distribution<int> coordinate(0, 6);
+	std::uniform_int_distribution<int> direction(fdNORTH, fdWEST);
+	std::uniform_int_distribution<int> command(cmdMOVE, cmdREPORT);
+
+	RecordingLogger logger;
+	std::vector<ToyRobot> expected;
+	expected.reserve(robots);
+
+	RobotFleet fleet(robots);
+	std::vector<uint8_t> xs(robots), ys(robots), facingDirections(robots), results(robots);
+	for (size_t idx = 0; idx < robots; idx++)
+	{
+		xs[idx] = static_cast<uint8_t>(coordinate(random));
+		ys[idx] = static_cast<uint8_t>(coordinate(random));
+		facingDirections[idx] = static_cast<uint8_t>(direction(random));
+		expected.emplace_back(logger);
+	}
+
+	fleet.Place(xs.data(), ys.data(), facingDirections.data(), results.data());
+	for (size_t idx = 0; idx < robots; idx++)
+		EXPECT_EQ(results[idx], expected[idx].Place(xs[idx], ys[idx], static_cast<FacingDirection>(facingDirections[idx])));
+
+	std::vector<uint8_t> commands(robots);
+	for (int step = 0; step < steps; step++)
+	{
+		for (auto& cmd : commands)
+			cmd = static_cast<uint8_t>(command(random));
+
+		fleet.Step(commands.data(), results.data());
+
+		for (size_t idx = 0; idx < robots; idx++)
+		{
+			auto result = rrSUCCESS;
+			switch (commands[idx])
+			{
+			case cmdMOVE: result = expected[idx].Move(); break;
+			case cmdTURN_LEFT: result = expected[idx].TurnLeft(); break;
+			case cmdTURN_RIGHT: result = expected[idx].TurnRight(); break;
+			default: break;
+			}
+			ASSERT_EQ(results[idx], result);
+		}
+	}
+
+	for (size_t idx = 0; idx < robots; idx++)
+	{
+		uint8_t x = 0, y = 0, expectedX = 0, expectedY = 0;
+		FacingDirection facingDirection = fdUNKNOWN, expectedDirection = fdUNKNOWN;
+		if (fleet.Report(idx, x, y, facingDirection))
+		{
+			expected[idx].Report(expectedX, expectedY, expectedDirection);
+			EXPECT_EQ(x, expectedX);
+			EXPECT_EQ(y, expectedY);
+			EXPECT_EQ(facingDirection, expectedDirection);
+		}
+	}
+}
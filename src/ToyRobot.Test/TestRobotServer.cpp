@@ -0,0 +1,206 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "RobotServer.h"
+
+#if defined(__linux__)
+#include <chrono>
+#include <filesystem>
+#include <poll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+/// <summary>
+/// Blocking test client of the robot server.
+/// </summary>
+class TestClient
+{
+public:
+	explicit TestClient(const std::string& address)
+	{
+		ServerAddress resolved;
+		std::string error;
+		EXPECT_TRUE(TryResolveServerAddress(address, resolved, error)) << error;
+
+		m_socket = socket(resolved.family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		EXPECT_EQ(connect(m_socket, reinterpret_cast<const sockaddr*>(resolved.storage), resolved.length), 0);
+	}
+
+	~TestClient()
+	{
+		close(m_socket);
+	}
+
+	void Send(const std::string& text)
+	{
+		EXPECT_EQ(send(m_socket, text.data(), text.size(), MSG_NOSIGNAL), static_cast<ssize_t>(text.size()));
+	}
+
+	/// <summary>
+	/// Tell the server nothing more is sent, keeping the connection open for its answers.
+	/// </summary>
+	void ShutdownSend()
+	{
+		EXPECT_EQ(shutdown(m_socket, SHUT_WR), 0);
+	}
+
+	/// <summary>
+	/// Read until the received text contains the expected text, the server closes the connection or a second passes.
+	/// </summary>
+	std::string ReceiveUntil(const std::string& expected)
+	{
+		std::string received;
+		char buffer[4096];
+		pollfd poll{ m_socket, POLLIN, 0 };
+		while (received.find(expected) == std::string::npos && ::poll(&poll, 1, 1000) > 0)
+		{
+			const auto count = read(m_socket, buffer, sizeof(buffer));
+			if (count <= 0)
+				break;
+
+			received.append(buffer, static_cast<size_t>(count));
+		}
+
+		return received;
+	}
+
+	/// <summary>
+	/// Whether the server closed the connection.
+	/// </summary>
+	bool IsClosed()
+	{
+		char buffer[256];
+		pollfd poll{ m_socket, POLLIN, 0 };
+		while (::poll(&poll, 1, 1000) > 0)
+		{
+			if (read(m_socket, buffer, sizeof(buffer)) <= 0)
+				return true;
+		}
+
+		return false;
+	}
+
+private:
+	int m_socket = -1;
+};
+
+static void WaitForActiveSessions(const RobotServer& server, uint64_t count)
+{
+	for (auto attempt = 0; attempt < 100 && server.Stats().activeSessions != count; attempt++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+TEST(TestRobotServer, TestSessionsHaveTheirOwnRobot)
+{
+	ServerOptions options;
+	options.address = "tcp:127.0.0.1:0";
+	options.threads = 2;
+	RobotServer server(options);
+
+	std::string error;
+	ASSERT_TRUE(server.TryStart(error)) << error;
+	ASSERT_NE(server.Port(), 0);
+
+	const auto address = "tcp:127.0.0.1:" + std::to_string(server.Port());
+	TestClient first(address);
+	TestClient second(address);
+
+	// The commands of the first client arrive split across writes.
+	first.Send("PLACE 1,2,");
+	second.Send("PLACE 3,3,SOUTH\nMOVE\r\nREPORT\n");
+	first.Send("EAST\nMOVE\nREP");
+	first.Send("ORT\n");
+
+	EXPECT_NE(first.ReceiveUntil("Output: 2,2,EAST").find("Output: 2,2,EAST"), std::string::npos);
+	EXPECT_NE(second.ReceiveUntil("Output: 3,2,SOUTH").find("Output: 3,2,SOUTH"), std::string::npos);
+
+	second.Send("EXIT\n");
+	EXPECT_TRUE(second.IsClosed());
+
+	WaitForActiveSessions(server, 1);
+	const auto stats = server.Stats();
+	EXPECT_EQ(stats.sessions, 2);
+	EXPECT_EQ(stats.activeSessions, 1);
+	EXPECT_EQ(stats.commands, 7);
+
+	server.Stop();
+	EXPECT_TRUE(first.IsClosed());
+}
+
+TEST(TestRobotServer, TestUnixSocket)
+{
+	const auto path = (std::filesystem::temp_directory_path() / "toyrobot_server_test.sock").string();
+
+	ServerOptions options;
+	options.address = "unix:" + path;
+	options.threads = 1;
+	RobotServer server(options);
+
+	std::string error;
+	ASSERT_TRUE(server.TryStart(error)) << error;
+	EXPECT_EQ(server.Port(), 0);
+
+	{
+		TestClient client(options.address);
+		client.Send("MOVE\nPLACE 0,0,NORTH\nLEFT\nREPORT\nEXIT\n");
+		const auto received = client.ReceiveUntil("Output: 0,0,WEST");
+		EXPECT_NE(received.find("Output: 0,0,WEST"), std::string::npos);
+		EXPECT_TRUE(client.IsClosed());
+	}
+
+	server.Stop();
+	EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(TestRobotServer, TestLastLineBeforeHalfClose)
+{
+	ServerOptions options;
+	options.address = "tcp:127.0.0.1:0";
+	options.threads = 1;
+	RobotServer server(options);
+
+	std::string error;
+	ASSERT_TRUE(server.TryStart(error)) << error;
+
+	// The last line has no line break, it is still run as in file mode.
+	const auto address = "tcp:127.0.0.1:" + std::to_string(server.Port());
+	TestClient client(address);
+	client.Send("PLACE 1,2,EAST\nREPORT");
+	client.ShutdownSend();
+
+	EXPECT_NE(client.ReceiveUntil("Output: 1,2,EAST").find("Output: 1,2,EAST"), std::string::npos);
+	EXPECT_TRUE(client.IsClosed());
+
+	server.Stop();
+	EXPECT_EQ(server.Stats().commands, 2);
+}
+
+TEST(TestRobotServer, TestInvalidAddress)
+{
+	ServerAddress resolved;
+	std::string error;
+	EXPECT_FALSE(TryResolveServerAddress("udp:127.0.0.1:1", resolved, error));
+	EXPECT_FALSE(TryResolveServerAddress("tcp:127.0.0.1", resolved, error));
+	EXPECT_FALSE(TryResolveServerAddress("tcp:127.0.0.1:99999", resolved, error));
+}
+
+#endif
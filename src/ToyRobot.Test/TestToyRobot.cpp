@@ -24,7 +24,7 @@
 class MockLogger : public LoggerBase
 {
 protected:
-	void Print(std::string /*msgType*/, std::string /*msg*/, std::string /*end*/) override
+	void Print(std::string_view /*msgType*/, std::string_view /*msg*/, std::string_view /*end*/) override
 	{
 		// Just ignore any log messages here.
 	}
@@ -251,3 +251,61 @@ TEST_F(TestToyRobot, TestMoveOverWestEdge)
 	EXPECT_FALSE(TryMove());
 	ExpectRobotCoordinates(0, cmd_y, cmd_facingDirection);
 }
+
+TEST(TestBoard, TestPlaceOutOfRangeIsNotTruncated)
+{
+	MockLogger logger;
+	ToyRobot robot(logger);
+
+	EXPECT_EQ(robot.Place(256, 0, fdNORTH), rrINVALID_X);
+	EXPECT_EQ(robot.Place(0, -256, fdNORTH), rrINVALID_Y);
+	EXPECT_EQ(robot.Place(-1, 0, fdNORTH), rrINVALID_X);
+	EXPECT_EQ(robot.Place(5, 5, fdNORTH), rrSUCCESS);
+}
+
+TEST(TestBoard, TestWiderStaticBoard)
+{
+	MockLogger logger;
+	BasicToyRobot<StaticBoard<uint16_t, 999, 9>> robot(logger);
+
+	EXPECT_EQ(robot.Place(1000, 0, fdEAST), rrINVALID_X);
+	EXPECT_EQ(robot.Place(998, 9, fdEAST), rrSUCCESS);
+	EXPECT_EQ(robot.Move(), rrSUCCESS);
+	EXPECT_EQ(robot.Move(), rrEAST_EDGE);
+	EXPECT_EQ(robot.TurnLeft(), rrSUCCESS);
+	EXPECT_EQ(robot.Move(), rrNORTH_EDGE);
+
+	uint16_t x;
+	uint16_t y;
+	FacingDirection facingDirection;
+	robot.Report(x, y, facingDirection);
+
+	EXPECT_EQ(x, 999);
+	EXPECT_EQ(y, 9);
+	EXPECT_EQ(facingDirection, fdNORTH);
+}
+
+TEST(TestBoard, TestRuntimeBoardEdges)
+{
+	const uint64_t maxCoordinate = uint64_t(1) << 32;
+
+	MockLogger logger;
+	RuntimeToyRobot robot(logger, RuntimeBoard(maxCoordinate, maxCoordinate));
+
+	EXPECT_FALSE(robot.TryPlace(maxCoordinate + 1, 0, fdEAST));
+	EXPECT_TRUE(robot.TryPlace(maxCoordinate, 0, fdEAST));
+	EXPECT_FALSE(robot.TryMove());
+	EXPECT_TRUE(robot.TryTurnRight());
+	EXPECT_FALSE(robot.TryMove());
+	EXPECT_TRUE(robot.TryTurnRight());
+	EXPECT_TRUE(robot.TryMove());
+
+	uint64_t x;
+	uint64_t y;
+	FacingDirection facingDirection;
+	robot.ReportPosition(x, y, facingDirection);
+
+	EXPECT_EQ(x, maxCoordinate - 1);
+	EXPECT_EQ(y, 0u);
+	EXPECT_EQ(facingDirection, fdWEST);
+}
@@ -0,0 +1,191 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "CommandProgram.h"
+#include "RobotTransition.h"
+#include "TestUtils.h"
+#include "TransitionRunner.h"
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Random script with every kind of line, plus STATS and a CRLF terminator. The robot is placed late, so the first chunks start unplaced.
+/// </summary>
+static std::string MakeScript(unsigned seed, size_t lineCount)
+{
+	return JoinLines(MakeRandomLines(seed, lineCount, { "STATS", "PLACE 3,3,WEST\r" }));
+}
+
+/// <summary>
+/// Log of the script run with --compile, without timestamps.
+/// </summary>
+static std::vector<std::string> RunCompiled(const std::string& script, LogLevel level, bool lazy)
+{
+	CommandProgram program;
+	program.CompileText(script);
+
+	RecordingLogger logger;
+	logger.SetLevel(level);
+	ToyRobot robot(logger);
+	logger.Info("Toy robot starting..");
+	ProgramRunner runner(robot, logger);
+	if (lazy)
+		runner.RunLazy(program);
+	else
+		runner.Run(program);
+	logger.Info("Toy robot quitting..");
+
+	return logger.messages;
+}
+
+static std::vector<std::string> RunComposed(const std::string& script, size_t threads, size_t chunkSize, LogLevel level, bool lazy, size_t& chunkCount)
+{
+	std::ostringstream output;
+	TransitionRunner runner(threads, level, lazy, chunkSize);
+	runner.Run(script, output);
+	chunkCount = runner.ChunkCount();
+
+	std::istringstream lines(output.str());
+	std::vector<std::string> messages;
+	std::string line;
+	while (std::getline(lines, line))
+		messages.push_back(line.substr(line.find(" - ") + 3));
+
+	return messages;
+}
+
+TEST(TestTransitionRunner, TestStatesRoundTrip)
+{
+	std::set<RobotTransition::State> states;
+	for (size_t state = 0; state < RobotTransition::StateCount; state++)
+	{
+		const auto decoded = RobotTransition::Decode(static_cast<RobotTransition::State>(state));
+		EXPECT_EQ(RobotTransition::Encode(decoded), state);
+		EXPECT_EQ(decoded.placed, state != RobotTransition::Unplaced);
+		states.insert(RobotTransition::Encode(decoded));
+	}
+
+	EXPECT_EQ(states.size(), 181u);
+
+	RobotTransition::State placed;
+	EXPECT_TRUE(RobotTransition::TryPlace(5, 5, fdUNKNOWN, placed));
+	EXPECT_FALSE(RobotTransition::TryPlace(6, 0, fdNORTH, placed));
+	EXPECT_FALSE(RobotTransition::TryPlace(0, -1, fdNORTH, placed));
+
+	// A placed robot can not be placed again.
+	const auto place = RobotTransition::Place(2, 3, fdSOUTH);
+	EXPECT_EQ(RobotTransition::Decode(place.Apply(RobotTransition::Unplaced)).y, 3u);
+	EXPECT_EQ(place.Apply(placed), placed);
+}
+
+TEST(TestTransitionRunner, TestBuilderMatchesRobot)
+{
+	std::mt19937 random(11);
+	std::vector<RobotTransition> parts;
+	TransitionBuilder whole;
+
+	for (int part = 0; part < 3; part++)
+	{
+		std::vector<std::pair<Command, int64_t>> commands;
+		TransitionBuilder builder;
+		for (int idx = 0; idx < 300; idx++)
+		{
+			const auto cmd = static_cast<Command>(cmdPLACE + random() % 4);
+			const auto cell = static_cast<int64_t>(random() % 8);
+			commands.emplace_back(cmd, cell);
+			for (auto* target : { &builder, &whole })
+			{
+				if (cmd == cmdPLACE)
+					target->ApplyPlace(cell, 5 - cell, static_cast<FacingDirection>(cell % 5));
+				else
+					target->Apply(cmd);
+			}
+		}
+
+		const auto transition = builder.Transition();
+		RecordingLogger logger;
+		for (size_t state = 0; state < RobotTransition::StateCount; state++)
+		{
+			ToyRobot robot(logger);
+			robot.TryRestoreState(RobotTransition::Decode(static_cast<RobotTransition::State>(state)));
+			for (const auto& command : commands)
+			{
+				switch (command.first)
+				{
+				case cmdPLACE: robot.Place(command.second, 5 - command.second, static_cast<FacingDirection>(command.second % 5)); break;
+				case cmdMOVE: robot.Move(); break;
+				case cmdTURN_LEFT: robot.TurnLeft(); break;
+				default: robot.TurnRight(); break;
+				}
+			}
+
+			EXPECT_EQ(transition.Apply(static_cast<RobotTransition::State>(state)), RobotTransition::Encode(robot.SaveState()));
+		}
+
+		parts.push_back(transition);
+	}
+
+	// Composition is associative and matches building the whole sequence at once.
+	EXPECT_EQ(parts[0].Then(parts[1]).Then(parts[2]), parts[0].Then(parts[1].Then(parts[2])));
+	EXPECT_EQ(parts[0].Then(parts[1]).Then(parts[2]), whole.Transition());
+	EXPECT_EQ(RobotTransition().Then(parts[1]), parts[1]);
+}
+
+TEST(TestTransitionRunner, TestMatchesCompiledRun)
+{
+	const auto script = MakeScript(5, 20000);
+	const auto expected = RunCompiled(script, llINFO, false);
+
+	for (const size_t chunkSize : { 1, 7, 100, 4096, 1 << 20 })
+	{
+		for (const size_t threads : { 1, 3 })
+		{
+			size_t chunkCount;
+			EXPECT_EQ(RunComposed(script, threads, chunkSize, llINFO, false, chunkCount), expected) << chunkSize << " " << threads;
+			EXPECT_GE(chunkCount, chunkSize == 1 << 20 ? 1u : script.size() / (chunkSize + 16));
+		}
+	}
+}
+
+TEST(TestTransitionRunner, TestStopsAtExit)
+{
+	const auto script = MakeScript(6, 5000) + "\nEXIT\n" + MakeScript(7, 5000);
+	size_t chunkCount;
+	EXPECT_EQ(RunComposed(script, 2, 256, llINFO, false, chunkCount), RunCompiled(script, llINFO, false));
+	EXPECT_LT(chunkCount, script.size() / 256);
+}
+
+TEST(TestTransitionRunner, TestLazyAndLevels)
+{
+	const auto script = MakeScript(8, 10000);
+	for (const auto level : { llINFO, llWARN, llNONE })
+	{
+		size_t chunkCount;
+		EXPECT_EQ(RunComposed(script, 2, 500, level, true, chunkCount), RunCompiled(script, level, true));
+	}
+
+	size_t chunkCount;
+	EXPECT_EQ(RunComposed("", 2, 500, llINFO, false, chunkCount), RunCompiled("", llINFO, false));
+	EXPECT_EQ(chunkCount, 0u);
+}
@@ -0,0 +1,153 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "TrbFile.h"
+#include "TestUtils.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace fs = std::filesystem;
+
+TEST(TestTrbFile, TestRoundTrip)
+{
+	TrbWriter writer(4, 7);
+	writer.Write(cmdMOVE);
+	writer.WritePlace({ -5, int64_t(1) << 40, fdWEST });
+	writer.Write(cmdTURN_LEFT);
+	writer.Write(cmdUNKNOWN);
+	writer.WriteInvalidPlace(" 1,x,NORTH");
+	writer.Write(cmdTURN_RIGHT);
+	writer.Write(cmdSTATS);
+	writer.Write(cmdREPORT);
+	writer.Write(cmdEXIT);
+	const auto& data = writer.Finish();
+	EXPECT_EQ(writer.CommandCount(), 9u);
+
+	TrbReader reader;
+	TrbHeader header;
+	ASSERT_TRUE(reader.TryOpen(data.data(), data.data() + data.size(), header));
+	EXPECT_EQ(header.version, TrbVersion);
+	EXPECT_EQ(header.maxX, 4u);
+	EXPECT_EQ(header.maxY, 7u);
+
+	PlaceArgs place;
+	std::string_view args;
+	bool placeIsValid;
+	EXPECT_EQ(reader.Next(place, args, placeIsValid), cmdMOVE);
+	ASSERT_EQ(reader.Next(place, args, placeIsValid), cmdPLACE);
+	EXPECT_TRUE(placeIsValid);
+	EXPECT_EQ(place.x, -5);
+	EXPECT_EQ(place.y, int64_t(1) << 40);
+	EXPECT_EQ(place.facingDirection, fdWEST);
+	EXPECT_EQ(reader.Next(place, args, placeIsValid), cmdTURN_LEFT);
+	EXPECT_EQ(reader.Next(place, args, placeIsValid), cmdUNKNOWN);
+	ASSERT_EQ(reader.Next(place, args, placeIsValid), cmdPLACE);
+	EXPECT_FALSE(placeIsValid);
+	EXPECT_EQ(args, " 1,x,NORTH");
+	EXPECT_EQ(reader.Next(place, args, placeIsValid), cmdTURN_RIGHT);
+	EXPECT_EQ(reader.Next(place, args, placeIsValid), cmdSTATS);
+	EXPECT_EQ(reader.Next(place, args, placeIsValid), cmdREPORT);
+	EXPECT_EQ(reader.Next(place, args, placeIsValid), cmdEXIT);
+	EXPECT_FALSE(reader.AtEnd());
+	EXPECT_EQ(reader.Next(place, args, placeIsValid), cmdEXIT);
+	EXPECT_TRUE(reader.AtEnd());
+}
+
+TEST(TestTrbFile, TestPacking)
+{
+	// Header of 6 bytes, then 3 bits per command.
+	TrbWriter writer(5, 5);
+	for (int idx = 0; idx < 8; idx++)
+		writer.Write(cmdMOVE);
+	EXPECT_EQ(writer.Finish().size(), 6u + 3u);
+
+	const std::string truncated = "TRB\x01\x05";
+	TrbReader reader;
+	TrbHeader header;
+	EXPECT_FALSE(reader.TryOpen(truncated.data(), truncated.data() + truncated.size(), header));
+
+	const std::string newer = "TRB\x04\x05\x05";
+	EXPECT_FALSE(reader.TryOpen(newer.data(), newer.data() + newer.size(), header));
+
+	// Version 1 has no extended codes, code 7 alone is an unknown line: MOVE, unknown, MOVE.
+	const std::string version1 = std::string("TRB\x01\x05\x05\xBA\x00", 8);
+	ASSERT_TRUE(reader.TryOpen(version1.data(), version1.data() + version1.size(), header));
+	EXPECT_EQ(header.version, 1u);
+
+	PlaceArgs place;
+	std::string_view args;
+	bool placeIsValid;
+	EXPECT_EQ(reader.Next(place, args, placeIsValid), cmdMOVE);
+	EXPECT_EQ(reader.Next(place, args, placeIsValid), cmdUNKNOWN);
+	EXPECT_EQ(reader.Next(place, args, placeIsValid), cmdMOVE);
+}
+
+TEST(TestTrbFile, TestCommanderMatchesText)
+{
+	static const char* const lines[] = { "MOVE", "MOVE", "LEFT", "right", "REPORT", "PLACE 1,2,EAST", "PLACE 9,9,NORTH",
+		"PLACE 1,,SOUTH", "PLACE -1,0,WEST", "JUMP", "", "  move", "PLACE 3,3,unknown" };
+
+	const auto textPath = fs::temp_directory_path() / "toyrobot_trb_input.txt";
+	const auto trbPath = fs::temp_directory_path() / "toyrobot_trb_input.trb";
+	{
+		std::mt19937 random(17);
+		std::ofstream file(textPath, std::ios::binary);
+		file << "PLACE 0,0,NORTH\n";
+		for (int idx = 0; idx < 3000; idx++)
+			file << lines[random() % 13] << (idx % 7 == 0 ? "\r\n" : "\n");
+	}
+
+	TrbConversion conversion;
+	std::string error;
+	ASSERT_TRUE(TryConvertToTrb(textPath.string(), trbPath.string(), 5, 5, conversion, error)) << error;
+	EXPECT_EQ(conversion.commandCount, 3001u);
+	EXPECT_EQ(conversion.outputBytes, fs::file_size(trbPath));
+	EXPECT_LT(conversion.outputBytes * 4, conversion.inputBytes);
+	EXPECT_TRUE(IsTrbFile(trbPath.string()));
+	EXPECT_FALSE(IsTrbFile(textPath.string()));
+
+	RecordingLogger textLogger;
+	ToyRobot textRobot(textLogger);
+	FileCommander(textPath.string(), textRobot, textLogger).Launch();
+
+	RecordingLogger trbLogger;
+	ToyRobot trbRobot(trbLogger);
+	TrbCommander commander(trbPath.string(), trbRobot, trbLogger);
+	ASSERT_TRUE(commander.IsOpen());
+	commander.Launch();
+
+	EXPECT_EQ(trbLogger.messages, textLogger.messages);
+
+	// Back to text, which runs the same again.
+	const auto backPath = fs::temp_directory_path() / "toyrobot_trb_back.txt";
+	ASSERT_TRUE(TryConvertFromTrb(trbPath.string(), backPath.string(), conversion, error)) << error;
+	EXPECT_EQ(conversion.commandCount, 3001u);
+
+	RecordingLogger backLogger;
+	ToyRobot backRobot(backLogger);
+	FileCommander(backPath.string(), backRobot, backLogger).Launch();
+	EXPECT_EQ(backLogger.messages, textLogger.messages);
+
+	fs::remove(textPath);
+	fs::remove(trbPath);
+	fs::remove(backPath);
+}
@@ -0,0 +1,116 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "Commander.h"
+#include "ToyRobot.h"
+#include <random>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Number of heap allocations made by the test executable so far. See AllocationCounter.cpp.
+/// </summary>
+extern size_t g_allocations;
+
+/// <summary>
+/// Logger keeping every message in memory as "TYPE - message".
+/// Statistics summaries differ from run to run, they are dropped unless recordStats is set.
+/// </summary>
+class RecordingLogger : public LoggerBase
+{
+public:
+	std::vector<std::string> messages;
+	bool recordStats = false;
+
+protected:
+	void Print(std::string_view msgType, std::string_view msg, std::string_view /*end*/) override
+	{
+		if (!recordStats && msg.rfind("Stats: ", 0) == 0)
+			return;
+
+		messages.push_back(std::string(msgType) + " - " + std::string(msg));
+	}
+};
+
+/// <summary>
+/// Commander reading its input from a fixed list of lines.
+/// </summary>
+class ScriptCommander : public CommanderBase
+{
+public:
+	ScriptCommander(RobotRef robot, LoggerBase& logger, const std::vector<std::string>& lines)
+		: CommanderBase(robot, logger),
+		m_lines(lines)
+	{}
+
+	using CommanderBase::GetCommand;
+	using CommanderBase::Execute;
+
+protected:
+	bool TryReadLine(std::string_view& input) override
+	{
+		if (m_next == m_lines.size())
+			return false;
+
+		input = m_lines[m_next++];
+		return true;
+	}
+
+private:
+	const std::vector<std::string>& m_lines;
+	size_t m_next = 0;
+};
+
+/// <summary>
+/// Random script lines drawn from moves, turns, REPORT, valid and invalid PLACE, unknown commands and blank lines.
+/// The same seed gives the same lines. A test adds the lines it is about with extraLines, they are drawn like the others.
+/// </summary>
+inline std::vector<std::string> MakeRandomLines(unsigned seed, size_t lineCount, const std::vector<std::string>& extraLines = {})
+{
+	static const char* const lines[] = { "MOVE", "MOVE", "MOVE", "LEFT", "RIGHT", "right", "  move", "REPORT", "REPORT",
+		"PLACE 0,0,NORTH", "PLACE 1,2,EAST", "place 1,4,west", "PLACE 9,9,NORTH", "PLACE 1,-1,EAST", "PLACE 256,3,WEST",
+		"PLACE 1,,SOUTH", "PLACE 1,2", "PLACE 0,0,unknown", "JUMP", "" };
+
+	std::vector<std::string> pool(std::begin(lines), std::end(lines));
+	pool.insert(pool.end(), extraLines.begin(), extraLines.end());
+
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<size_t> line(0, pool.size() - 1);
+
+	std::vector<std::string> script(lineCount);
+	for (auto& text : script)
+		text = pool[line(random)];
+
+	return script;
+}
+
+/// <summary>
+/// Lines joined by newlines, the last one without terminator.
+/// </summary>
+inline std::string JoinLines(const std::vector<std::string>& lines)
+{
+	std::string text;
+	for (size_t idx = 0; idx < lines.size(); idx++)
+		text.append(lines[idx]).append(idx + 1 < lines.size() ? "\n" : "");
+
+	return text;
+}
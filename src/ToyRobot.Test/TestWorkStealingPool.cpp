@@ -0,0 +1,77 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "WorkStealingPool.h"
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+TEST(TestWorkStealingPool, TestRunsEveryTask)
+{
+	WorkStealingPool pool(4);
+	std::vector<std::atomic<int>> runs(1000);
+
+	for (auto& run : runs)
+		pool.Submit([&run]() { run++; });
+
+	pool.Wait();
+
+	for (const auto& run : runs)
+		EXPECT_EQ(run.load(), 1);
+}
+
+TEST(TestWorkStealingPool, TestTasksSubmittedFromWorkers)
+{
+	WorkStealingPool pool(3);
+	std::atomic<int> leaves{ 0 };
+
+	for (int idx = 0; idx < 10; idx++)
+	{
+		pool.Submit([&pool, &leaves]() {
+			for (int child = 0; child < 10; child++)
+				pool.Submit([&leaves]() { leaves++; });
+		});
+	}
+
+	pool.Wait();
+	EXPECT_EQ(leaves.load(), 100);
+}
+
+TEST(TestWorkStealingPool, TestIdleWorkersSteal)
+{
+	WorkStealingPool pool(2);
+	std::atomic<int> done{ 0 };
+
+	// Every task is queued by the same worker, so the other worker can only get work by stealing it.
+	pool.Submit([&pool, &done]() {
+		for (int idx = 0; idx < 20; idx++)
+		{
+			pool.Submit([&done]() {
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				done++;
+			});
+		}
+	});
+
+	pool.Wait();
+	EXPECT_EQ(done.load(), 20);
+	EXPECT_GT(pool.StolenCount(), 0u);
+}
@@ -0,0 +1,142 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gtest/gtest.h"
+#include "WorkloadGenerator.h"
+#include "TestUtils.h"
+#include <algorithm>
+#include <sstream>
+
+static std::string Generate(const WorkloadOptions& options, uint64_t lines, size_t capacity)
+{
+	WorkloadGenerator generator(options);
+	std::vector<char> buffer(capacity);
+	std::string output;
+	while (lines > 0)
+	{
+		const auto size = generator.Fill(buffer.data(), buffer.size(), lines);
+		output.append(buffer.data(), size);
+	}
+
+	return output;
+}
+
+static std::vector<std::string> SplitLines(const std::string& text)
+{
+	std::vector<std::string> lines;
+	std::istringstream stream(text);
+	for (std::string line; std::getline(stream, line);)
+		lines.push_back(line);
+
+	return lines;
+}
+
+static size_t CountMessages(const RecordingLogger& logger, const std::string& text)
+{
+	return std::count_if(logger.messages.begin(), logger.messages.end(), [&text](const std::string& message) {
+		return message.find(text) != std::string::npos;
+	});
+}
+
+TEST(TestWorkloadGenerator, TestDeterministic)
+{
+	WorkloadOptions options;
+	options.seed = 17;
+	options.maxX = 1000;
+	options.maxY = 20;
+	options.edgeRate = 0.3;
+	options.invalidPlaceRate = 0.3;
+
+	const auto output = Generate(options, 100000, 1 << 20);
+	EXPECT_EQ(Generate(options, 100000, WorkloadGenerator::MaxLineLength + 1), output);
+	EXPECT_EQ(SplitLines(output).size(), 100000u);
+
+	options.seed = 18;
+	EXPECT_NE(Generate(options, 100000, 1 << 20), output);
+}
+
+TEST(TestWorkloadGenerator, TestMix)
+{
+	WorkloadOptions options;
+	std::string error;
+	ASSERT_TRUE(TryParseWorkloadMix("move=50,left=20,report=30", options.weights, error)) << error;
+	options.initialPlace = false;
+
+	WorkloadGenerator generator(options);
+	std::vector<char> buffer(1 << 16);
+	uint64_t lines = 1000000;
+	while (lines > 0)
+		generator.Fill(buffer.data(), buffer.size(), lines);
+
+	const auto counts = generator.Counts();
+	EXPECT_NEAR(counts[wlMOVE], 500000, 5000);
+	EXPECT_NEAR(counts[wlLEFT], 200000, 5000);
+	EXPECT_NEAR(counts[wlREPORT], 300000, 5000);
+	EXPECT_EQ(counts[wlRIGHT], 0u);
+	EXPECT_EQ(counts[wlPLACE], 0u);
+	EXPECT_EQ(counts[wlUNKNOWN], 0u);
+
+	EXPECT_FALSE(TryParseWorkloadMix("jump=5", options.weights, error));
+	EXPECT_FALSE(TryParseWorkloadMix("move=x", options.weights, error));
+	EXPECT_FALSE(TryParseWorkloadMix("move=0", options.weights, error));
+}
+
+TEST(TestWorkloadGenerator, TestEdgeHugging)
+{
+	WorkloadOptions options;
+	options.weights[wlLEFT] = 0;
+	options.weights[wlRIGHT] = 0;
+	options.edgeRate = 1;
+
+	for (options.seed = 1; options.seed <= 8; options.seed++)
+	{
+		const auto lines = SplitLines(Generate(options, 1000, 1 << 16));
+
+		// Placed on an edge facing off the board, every MOVE is refused.
+		RecordingLogger logger;
+		ToyRobot robot(logger);
+		ScriptCommander commander(robot, logger, lines);
+		commander.Launch();
+		EXPECT_EQ(CountMessages(logger, "edge. Command is ignored for safety."), static_cast<size_t>(std::count(lines.begin(), lines.end(), "MOVE")));
+	}
+}
+
+TEST(TestWorkloadGenerator, TestInvalidPlaces)
+{
+	WorkloadOptions options;
+	std::string error;
+	ASSERT_TRUE(TryParseWorkloadMix("place=1", options.weights, error)) << error;
+	options.initialPlace = false;
+	options.invalidPlaceRate = 1;
+
+	const auto lines = SplitLines(Generate(options, 2000, 1 << 16));
+	RecordingLogger logger;
+	ToyRobot robot(logger);
+	ScriptCommander commander(robot, logger, lines);
+	commander.Launch();
+
+	// Every PLACE is rejected, and every error path of PLACE is taken.
+	EXPECT_EQ(robot.SaveState().placed, false);
+	EXPECT_GT(CountMessages(logger, "Invalid number of arguments"), 0u);
+	EXPECT_GT(CountMessages(logger, "Invalid x value"), 0u);
+	EXPECT_GT(CountMessages(logger, "Invalid y value"), 0u);
+	EXPECT_GT(CountMessages(logger, "Invalid facing direction"), 0u);
+	EXPECT_GT(CountMessages(logger, "Invalid x coordinate"), 0u);
+}
@@ -0,0 +1,82 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <limits>
+#include <stdint.h>
+#include <type_traits>
+
+/// <summary>
+/// Board with compile time extents. Coordinates run from 0 to XMax and from 0 to YMax.
+/// The bounds checks fold into constants and the robot keeps its position in TCoordinate.
+/// </summary>
+template <typename TCoordinate, TCoordinate XMax, TCoordinate YMax>
+struct StaticBoard
+{
+	using Coordinate = TCoordinate;
+
+	static_assert(std::is_unsigned_v<TCoordinate>, "Board coordinates must be unsigned");
+	static_assert(XMax < std::numeric_limits<TCoordinate>::max() && YMax < std::numeric_limits<TCoordinate>::max(),
+		"A step below zero wraps to the largest coordinate, which must stay off the board");
+
+	static constexpr Coordinate MaxX() { return XMax; }
+	static constexpr Coordinate MaxY() { return YMax; }
+};
+
+/// <summary>
+/// Board with extents chosen at runtime, e.g. from the command line.
+/// The largest coordinate must stay below the maximum of TCoordinate, see StaticBoard.
+/// </summary>
+template <typename TCoordinate>
+class DynamicBoard
+{
+public:
+	using Coordinate = TCoordinate;
+
+	static_assert(std::is_unsigned_v<TCoordinate>, "Board coordinates must be unsigned");
+
+	/// <summary>
+	/// Largest extent supported by this board type.
+	/// </summary>
+	static constexpr Coordinate Limit = std::numeric_limits<TCoordinate>::max() - 1;
+
+	DynamicBoard(Coordinate maxX, Coordinate maxY)
+		: m_maxX(maxX < Limit ? maxX : Limit),
+		m_maxY(maxY < Limit ? maxY : Limit)
+	{}
+
+	Coordinate MaxX() const { return m_maxX; }
+	Coordinate MaxY() const { return m_maxY; }
+
+private:
+	Coordinate m_maxX;
+	Coordinate m_maxY;
+};
+
+/// <summary>
+/// The classic board, with coordinates from 0 to 5 held in a single byte.
+/// </summary>
+using DefaultBoard = StaticBoard<uint8_t, 5, 5>;
+
+/// <summary>
+/// Board of any size chosen with --board, 2^32 x 2^32 included.
+/// </summary>
+using RuntimeBoard = DynamicBoard<uint64_t>;
\ No newline at end of file
@@ -0,0 +1,635 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "CommandProgram.h"
+#include "Commander.h"
+#include "LineScanner.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace
+{
+    const char* const DefineArgumentsError = "Invalid arguments for define command. Command expects a name and an opening brace in the form of (define name {)";
+    const char* const RepeatArgumentsError = "Invalid arguments for repeat command. Command expects a count and an opening brace in the form of (repeat n {)";
+
+    /// <summary>
+    /// Macro names are made of letters, digits and underscores.
+    /// </summary>
+    bool IsMacroName(std::string_view name)
+    {
+        return std::all_of(name.begin(), name.end(), [](char ch) {
+            return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_';
+        });
+    }
+}
+
+void CommandProgram::CompileLine(std::string_view line)
+{
+    if (m_exited)
+        return;
+
+    std::string_view args;
+    CompileCommand(CommanderBase::ParseCommand(line, args), args);
+}
+
+void CommandProgram::CompileCommand(Command cmd, std::string_view args)
+{
+    if (m_exited)
+        return;
+
+    m_hasBlockCommands |= IsBlockCommand(cmd);
+    switch (cmd)
+    {
+    case cmdPLACE:
+    {
+        PlaceArgs place;
+        std::string error;
+        if (CommanderBase::TryParsePlace(args, place, error))
+            AppendPlace(place.x, place.y, place.facingDirection);
+        else
+            AppendError(std::move(error));
+        break;
+    }
+    case cmdMOVE:
+    case cmdTURN_LEFT:
+    case cmdTURN_RIGHT:
+    case cmdREPORT:
+        AppendCommand(cmd);
+        break;
+    case cmdEXIT:
+        m_exited = true;
+        Finish();
+        break;
+    case cmdDEFINE:
+    case cmdREPEAT:
+        Open(cmd, args);
+        break;
+    case cmdCALL:
+        Call(args);
+        break;
+    case cmdEND_BLOCK:
+        Close();
+        break;
+    case cmdSTATS:
+        AppendError("The STATS command is not supported by compiled programs.");
+        break;
+    case cmdUNKNOWN:
+    default:
+        AppendError("Unknown command");
+        break;
+    }
+}
+
+void CommandProgram::CompileText(std::string_view text)
+{
+    LineScanner scanner(text.data(), text.data() + text.size());
+
+    std::string_view line;
+    while (scanner.TryNextLine(line))
+        CompileLine(line);
+
+    Finish();
+}
+
+bool CommandProgram::TryCompileFile(const std::string& path)
+{
+    MappedFile mappedFile;
+    if (mappedFile.TryOpen(path))
+    {
+        CompileText(std::string_view(mappedFile.Data(), mappedFile.Size()));
+        return true;
+    }
+
+    std::ifstream filestream(path);
+    if (!filestream.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(filestream, line))
+        CompileLine(line);
+
+    Finish();
+    return true;
+}
+
+void CommandProgram::Finish()
+{
+    if (m_open.empty())
+        return;
+
+    // The open blocks are dropped with everything compiled into them.
+    m_open.clear();
+    AppendError("A block is not closed. Expected } before the end of the script.");
+}
+
+void CommandProgram::AppendCommand(Command cmd)
+{
+    CurrentCode().push_back(static_cast<uint8_t>(cmd));
+    m_commandCount++;
+}
+
+void CommandProgram::AppendPlace(int64_t x, int64_t y, FacingDirection facingDirection)
+{
+    uint8_t payload[PlacePayloadSize];
+    std::memcpy(payload, &x, sizeof(x));
+    std::memcpy(payload + sizeof(x), &y, sizeof(y));
+    payload[2 * sizeof(int64_t)] = static_cast<uint8_t>(facingDirection);
+
+    auto& code = CurrentCode();
+    code.push_back(static_cast<uint8_t>(cmdPLACE));
+    code.insert(code.end(), payload, payload + PlacePayloadSize);
+    m_commandCount++;
+}
+
+void CommandProgram::AppendError(std::string message)
+{
+    const auto index = static_cast<uint32_t>(m_messages.size());
+    m_messages.push_back(std::move(message));
+
+    uint8_t payload[ErrorPayloadSize];
+    std::memcpy(payload, &index, sizeof(index));
+
+    auto& code = CurrentCode();
+    code.push_back(static_cast<uint8_t>(cmdUNKNOWN));
+    code.insert(code.end(), payload, payload + ErrorPayloadSize);
+    m_commandCount++;
+}
+
+RobotEffect CommandProgram::RepeatEffect(uint32_t block, uint64_t count) const
+{
+    // The powers are all powers of the same effect, so they can be applied in any order.
+    RobotEffect effect;
+    const auto& powers = m_blocks[block].powers;
+    for (size_t power = 0; power < powers.size() && (count >> power) != 0; power++)
+    {
+        if (((count >> power) & 1) != 0)
+            effect.Append(powers[power]);
+    }
+
+    return effect;
+}
+
+void CommandProgram::Open(Command cmd, std::string_view args)
+{
+    std::string_view tokens[3];
+    const auto count = CommanderBase::Split(args, ' ', tokens, 3);
+    const auto error = cmd == cmdDEFINE ? DefineArgumentsError : RepeatArgumentsError;
+
+    // Without the brace there is no block, the lines that follow are compiled where they are.
+    if (count == 0 || count > 3 || tokens[count - 1] != "{")
+    {
+        AppendError(error);
+        return;
+    }
+
+    // Otherwise the block takes the lines up to its closing brace, even when the rest of the line is invalid.
+    OpenBlock block{ cmdUNKNOWN, static_cast<uint32_t>(m_blocks.size()), 0, {} };
+    if (count == 2 && cmd == cmdDEFINE && IsMacroName(tokens[0]))
+    {
+        block.kind = cmdDEFINE;
+        block.name = tokens[0];
+    }
+    else if (count == 2 && cmd == cmdREPEAT && CommanderBase::TryParseInt(tokens[0], block.count))
+    {
+        block.kind = cmdREPEAT;
+    }
+    else
+    {
+        AppendError(error);
+    }
+
+    m_blocks.emplace_back();
+    m_open.push_back(std::move(block));
+}
+
+void CommandProgram::Close()
+{
+    if (m_open.empty())
+    {
+        AppendError("Unexpected }. There is no open block to close.");
+        return;
+    }
+
+    auto block = std::move(m_open.back());
+    m_open.pop_back();
+    if (block.kind == cmdUNKNOWN)
+        return;
+
+    auto& compiled = m_blocks[block.index];
+    RobotEffect effect;
+    const uint8_t* pc = compiled.code.data();
+    const uint8_t* const end = pc + compiled.code.size();
+    while (pc < end)
+    {
+        const auto cmd = static_cast<Command>(*pc++);
+        switch (cmd)
+        {
+        case cmdMOVE:
+        case cmdTURN_LEFT:
+        case cmdTURN_RIGHT:
+        case cmdREPORT:
+            effect.Append(RobotEffect::Of(cmd));
+            break;
+        case cmdPLACE:
+        {
+            int64_t x;
+            int64_t y;
+            std::memcpy(&x, pc, sizeof(x));
+            std::memcpy(&y, pc + sizeof(x), sizeof(y));
+            effect.Append(RobotEffect::Place(x, y, static_cast<FacingDirection>(pc[2 * sizeof(int64_t)])));
+            pc += PlacePayloadSize;
+            break;
+        }
+        case cmdCALL:
+        {
+            uint32_t index;
+            std::memcpy(&index, pc, sizeof(index));
+            effect.Append(m_blocks[index].powers[0]);
+            pc += CallPayloadSize;
+            break;
+        }
+        case cmdREPEAT:
+        {
+            uint64_t count;
+            uint32_t index;
+            std::memcpy(&count, pc, sizeof(count));
+            std::memcpy(&index, pc + sizeof(count), sizeof(index));
+            effect.Append(RepeatEffect(index, count));
+            pc += RepeatPayloadSize;
+            break;
+        }
+        case cmdUNKNOWN:
+        default:
+            effect.Append(RobotEffect::Of(cmdUNKNOWN));
+            pc += ErrorPayloadSize;
+            break;
+        }
+    }
+
+    compiled.powers.assign(1, effect);
+    if (block.kind == cmdDEFINE)
+        m_macros[block.name] = block.index;
+    else
+        AppendBlock(cmdREPEAT, block.index, block.count);
+}
+
+void CommandProgram::Call(std::string_view args)
+{
+    std::string_view name;
+    if (CommanderBase::Split(args, ' ', &name, 1) != 1)
+    {
+        AppendError("Invalid number of arguments for call command. Command expects 1 argument in the form of (call name)");
+        return;
+    }
+
+    const auto macro = m_macros.find(std::string(name));
+    if (macro == m_macros.end())
+    {
+        AppendError("Unknown macro: " + std::string(name));
+        return;
+    }
+
+    AppendBlock(cmdCALL, macro->second, 1);
+}
+
+void CommandProgram::AppendBlock(Command cmd, uint32_t index, uint64_t count)
+{
+    // Every open block adds a level around the block when it runs.
+    auto& block = m_blocks[index];
+    if (block.depth + m_open.size() > MaxBlockDepth)
+    {
+        AppendError("Blocks are nested too deeply.");
+        return;
+    }
+
+    if (!m_open.empty())
+    {
+        auto& outer = m_blocks[m_open.back().index];
+        outer.depth = std::max(outer.depth, block.depth + 1);
+    }
+
+    while (block.powers.size() < 64 && (count >> block.powers.size()) != 0)
+        block.powers.push_back(block.powers.back().Then(block.powers.back()));
+
+    uint8_t payload[RepeatPayloadSize];
+    size_t size = 0;
+    if (cmd == cmdREPEAT)
+    {
+        std::memcpy(payload, &count, sizeof(count));
+        size = sizeof(count);
+    }
+
+    std::memcpy(payload + size, &index, sizeof(index));
+    size += sizeof(index);
+
+    auto& code = CurrentCode();
+    code.push_back(static_cast<uint8_t>(cmd));
+    code.insert(code.end(), payload, payload + size);
+    m_commandCount++;
+}
+
+template <typename TRobot>
+void BasicProgramRunner<TRobot>::Run(const CommandProgram& program)
+{
+    m_lazy = false;
+    Execute(program, program.Code());
+}
+
+template <typename TRobot>
+void BasicProgramRunner<TRobot>::RunLazy(const CommandProgram& program)
+{
+    m_lazy = true;
+    ExecuteLazy(program, program.Code());
+}
+
+template <typename TRobot>
+void BasicProgramRunner<TRobot>::Execute(const CommandProgram& program, const std::vector<uint8_t>& code)
+{
+    const uint8_t* pc = code.data();
+    const uint8_t* const end = pc + code.size();
+
+    while (pc < end)
+    {
+        const auto cmd = static_cast<Command>(*pc++);
+        switch (cmd)
+        {
+        case cmdMOVE:
+        {
+            const auto result = m_robot.Move();
+            if (result != rrSUCCESS)
+                Fail(cmd, result);
+            break;
+        }
+        case cmdTURN_LEFT:
+        case cmdTURN_RIGHT:
+            Turn(cmd);
+            break;
+        case cmdREPORT:
+            Report();
+            break;
+        case cmdPLACE:
+            pc = Place(pc);
+            break;
+        case cmdCALL:
+            pc = Call(program, pc);
+            break;
+        case cmdREPEAT:
+            pc = Repeat(program, pc);
+            break;
+        case cmdUNKNOWN:
+        default:
+            pc = Error(program, pc);
+            break;
+        }
+    }
+}
+
+template <typename TRobot>
+void BasicProgramRunner<TRobot>::ExecuteLazy(const CommandProgram& program, const std::vector<uint8_t>& code)
+{
+    const uint8_t* pc = code.data();
+    const uint8_t* const end = pc + code.size();
+
+    while (pc < end)
+    {
+        const auto cmd = static_cast<Command>(*pc);
+        switch (cmd)
+        {
+        case cmdMOVE:
+        {
+            // MOVE has no payload, so a run of them is a run of equal bytes.
+            const auto runEnd = std::find_if(pc, end, [](uint8_t op) { return op != cmdMOVE; });
+            const auto steps = static_cast<uint64_t>(runEnd - pc);
+            pc = runEnd;
+
+            uint64_t rejected;
+            const auto result = m_robot.MoveRun(steps, rejected);
+
+            // The rejected moves are the last ones of the run and leave the robot where it is,
+            // so each of them logs the same messages. With every level disabled there is nothing to log.
+            if (m_logger.IsEnabled(llERROR))
+            {
+                for (uint64_t idx = 0; idx < rejected; idx++)
+                    Fail(cmdMOVE, result);
+            }
+            break;
+        }
+        case cmdTURN_LEFT:
+        case cmdTURN_RIGHT:
+        {
+            const auto runEnd = std::find_if(pc, end, [](uint8_t op) { return op != cmdTURN_LEFT && op != cmdTURN_RIGHT; });
+
+            // The first turn tells whether the robot can turn at all. If it can, every turn of the run succeeds.
+            // Without INFO nothing is logged for them, and the run reduces to its net number of right turns modulo 4.
+            if (Turn(static_cast<Command>(*pc++)) && !m_logger.IsEnabled(llINFO))
+            {
+                const auto lefts = static_cast<size_t>(std::count(pc, runEnd, static_cast<uint8_t>(cmdTURN_LEFT)));
+                const auto rights = static_cast<size_t>(runEnd - pc) - lefts;
+                for (auto quarter = (rights + 4 - lefts % 4) % 4; quarter > 0; quarter--)
+                    m_robot.TurnRight();
+
+                pc = runEnd;
+            }
+            else
+            {
+                while (pc < runEnd)
+                    Turn(static_cast<Command>(*pc++));
+            }
+            break;
+        }
+        case cmdREPORT:
+            Report();
+            pc++;
+            break;
+        case cmdPLACE:
+            pc = Place(pc + 1);
+            break;
+        case cmdCALL:
+            pc = Call(program, pc + 1);
+            break;
+        case cmdREPEAT:
+            pc = Repeat(program, pc + 1);
+            break;
+        case cmdUNKNOWN:
+        default:
+            pc = Error(program, pc + 1);
+            break;
+        }
+    }
+}
+
+template <typename TRobot>
+const uint8_t* BasicProgramRunner<TRobot>::Call(const CommandProgram& program, const uint8_t* payload)
+{
+    uint32_t index;
+    std::memcpy(&index, payload, sizeof(index));
+    RunBlock(program, index, 1);
+
+    return payload + CommandProgram::CallPayloadSize;
+}
+
+template <typename TRobot>
+const uint8_t* BasicProgramRunner<TRobot>::Repeat(const CommandProgram& program, const uint8_t* payload)
+{
+    uint64_t count;
+    uint32_t index;
+    std::memcpy(&count, payload, sizeof(count));
+    std::memcpy(&index, payload + sizeof(count), sizeof(index));
+    RunBlock(program, index, count);
+
+    return payload + CommandProgram::RepeatPayloadSize;
+}
+
+template <typename TRobot>
+void BasicProgramRunner<TRobot>::RunBlock(const CommandProgram& program, uint32_t index, uint64_t count)
+{
+    const auto& block = program.Blocks()[index];
+    if constexpr (std::is_same_v<TRobot, ToyRobot>)
+    {
+        const auto levels = EnabledLevels();
+        auto state = RobotTransition::Encode(m_robot.SaveState());
+        while (count > 0)
+        {
+            if ((block.powers[0].Levels(state) & levels) != 0)
+            {
+                if (m_lazy)
+                    ExecuteLazy(program, block.code);
+                else
+                    Execute(program, block.code);
+
+                state = RobotTransition::Encode(m_robot.SaveState());
+                count--;
+                continue;
+            }
+
+            // Skip the longest run of silent iterations, largest power first. Silence holds for every
+            // prefix of a silent run, so this finds its length bit by bit.
+            for (auto power = block.powers.size(); power-- > 0;)
+            {
+                const auto span = uint64_t(1) << power;
+                if (span <= count && (block.powers[power].Levels(state) & levels) == 0)
+                {
+                    state = block.powers[power].Transition().Apply(state);
+                    count -= span;
+                }
+            }
+
+            m_robot.TryRestoreState(RobotTransition::Decode(state));
+        }
+    }
+    else
+    {
+        for (; count > 0; count--)
+        {
+            if (m_lazy)
+                ExecuteLazy(program, block.code);
+            else
+                Execute(program, block.code);
+        }
+    }
+}
+
+template <typename TRobot>
+uint8_t BasicProgramRunner<TRobot>::EnabledLevels() const
+{
+    uint8_t levels = elOUTPUT;
+    if (m_logger.IsEnabled(llINFO))
+        levels |= elINFO;
+    if (m_logger.IsEnabled(llWARN))
+        levels |= elWARN;
+    if (m_logger.IsEnabled(llERROR))
+        levels |= elERROR;
+
+    return levels;
+}
+
+template <typename TRobot>
+bool BasicProgramRunner<TRobot>::Turn(Command cmd)
+{
+    const auto result = cmd == cmdTURN_LEFT ? m_robot.TurnLeft() : m_robot.TurnRight();
+    if (result != rrSUCCESS)
+        Fail(cmd, result);
+    else if (m_logger.IsEnabled(llINFO))
+        m_robot.LogResult(cmd, result);
+
+    return result == rrSUCCESS;
+}
+
+template <typename TRobot>
+const uint8_t* BasicProgramRunner<TRobot>::Place(const uint8_t* payload)
+{
+    int64_t x;
+    int64_t y;
+    std::memcpy(&x, payload, sizeof(x));
+    std::memcpy(&y, payload + sizeof(x), sizeof(y));
+    const auto facingDirection = static_cast<FacingDirection>(payload[2 * sizeof(int64_t)]);
+
+    const auto result = m_robot.Place(x, y, facingDirection);
+    if (result != rrSUCCESS)
+        Fail(cmdPLACE, result);
+
+    return payload + CommandProgram::PlacePayloadSize;
+}
+
+template <typename TRobot>
+const uint8_t* BasicProgramRunner<TRobot>::Error(const CommandProgram& program, const uint8_t* payload)
+{
+    uint32_t index;
+    std::memcpy(&index, payload, sizeof(index));
+    m_logger.Error(program.Messages()[index]);
+
+    return payload + CommandProgram::ErrorPayloadSize;
+}
+
+template <typename TRobot>
+void BasicProgramRunner<TRobot>::Fail(Command cmd, RobotResult result)
+{
+    m_robot.LogResult(cmd, result);
+    m_logger.Error(CommanderBase::GetFailureMessage(cmd));
+}
+
+template <typename TRobot>
+void BasicProgramRunner<TRobot>::Report()
+{
+    typename TRobot::Coordinate x;
+    typename TRobot::Coordinate y;
+    FacingDirection facingDirection;
+
+    m_robot.Report(x, y, facingDirection);
+    if (m_resultSink != nullptr)
+    {
+        m_resultSink->Write(x, y, facingDirection);
+        return;
+    }
+
+    static const char Prefix[] = "Output: ";
+    char output[sizeof(Prefix) - 1 + MaxPositionLength];
+    std::memcpy(output, Prefix, sizeof(Prefix) - 1);
+    const auto length = FormatPosition(output + sizeof(Prefix) - 1, x, y, facingDirection);
+    m_logger.Output(std::string_view(output, sizeof(Prefix) - 1 + length));
+}
+
+template class BasicProgramRunner<ToyRobot>;
+template class BasicProgramRunner<RuntimeToyRobot>;
+template class BasicProgramRunner<DenseSharedToyRobot>;
+template class BasicProgramRunner<SparseSharedToyRobot>;
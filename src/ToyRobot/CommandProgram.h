@@ -0,0 +1,333 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Commands.h"
+#include "FacingDirection.h"
+#include "Logger.h"
+#include "ResultSink.h"
+#include "RobotTransition.h"
+#include "ToyRobot.h"
+
+/// <summary>
+/// Body of a DEFINE or REPEAT block, compiled once into its own opcode stream.
+/// </summary>
+struct ProgramBlock
+{
+    std::vector<uint8_t> code;
+
+    /// <summary>
+    /// Effect of running the block 2^k times on the default board, for every k up to the highest bit of the
+    /// largest count the block is repeated with. The first one is the effect of a single run.
+    /// </summary>
+    std::vector<RobotEffect> powers;
+
+    /// <summary>
+    /// Number of blocks nested in each other when the block runs, itself included.
+    /// </summary>
+    size_t depth = 1;
+};
+
+/// <summary>
+/// Command script compiled into a packed opcode stream.
+/// Every opcode is a single byte holding the Command value. MOVE, LEFT, RIGHT and REPORT have no payload,
+/// PLACE is followed by x and y as 64 bit integers and the facing direction as one byte,
+/// UNKNOWN carries a 32 bit index into the message table and stands for a line that failed to parse.
+/// CALL carries a 32 bit block index, REPEAT the count as a 64 bit integer followed by the block index.
+///
+/// Blocks are written one command per line: "DEFINE name {" and "REPEAT n {" open one, "}" closes it, and
+/// "CALL name" runs the latest macro of that name defined before the line. Macros are bound when the script
+/// is compiled, so a macro can not call itself. Lines inside a block compile into the block, with the same
+/// errors they would log at the top level. A block left open at an EXIT or at the end of the script is
+/// dropped with an error.
+/// A compiled program is immutable once built and can be run any number of times.
+/// </summary>
+class CommandProgram
+{
+public:
+    static constexpr size_t PlacePayloadSize = 2 * sizeof(int64_t) + 1;
+    static constexpr size_t ErrorPayloadSize = sizeof(uint32_t);
+    static constexpr size_t CallPayloadSize = sizeof(uint32_t);
+    static constexpr size_t RepeatPayloadSize = sizeof(uint64_t) + sizeof(uint32_t);
+
+    /// <summary>
+    /// Deepest nesting of blocks, macro calls included. The runner recurses once per level.
+    /// </summary>
+    static constexpr size_t MaxBlockDepth = 64;
+
+    /// <summary>
+    /// Compile a single line of the command script and append it to the program.
+    /// Lines after an EXIT command are ignored.
+    /// </summary>
+    /// <param name="line">Input line</param>
+    void CompileLine(std::string_view line);
+
+    /// <summary>
+    /// Compile a command parsed from a line of the command script.
+    /// </summary>
+    /// <param name="cmd">The command</param>
+    /// <param name="args">Arguments following the command keyword</param>
+    void CompileCommand(Command cmd, std::string_view args);
+
+    /// <summary>
+    /// Compile every line of the given text, up to the end of the script.
+    /// </summary>
+    void CompileText(std::string_view text);
+
+    /// <summary>
+    /// Compile the command script in the given file.
+    /// </summary>
+    /// <param name="path">Path of the file</param>
+    /// <returns>[true] File compiled. [false] File could not be opened.</returns>
+    bool TryCompileFile(const std::string& path);
+
+    /// <summary>
+    /// End of the script. Drops the blocks still open with an error.
+    /// </summary>
+    void Finish();
+
+    /// <summary>
+    /// Append to the innermost open block, or to the program when no block is open.
+    /// </summary>
+    void AppendCommand(Command cmd);
+    void AppendPlace(int64_t x, int64_t y, FacingDirection facingDirection);
+    void AppendError(std::string message);
+
+    /// <summary>
+    /// Drop the compiled top level commands, keeping the macros and blocks. Used to run a script one
+    /// statement at a time.
+    /// </summary>
+    void ClearCode() { m_code.clear(); }
+
+    const std::vector<uint8_t>& Code() const { return m_code; }
+    const std::vector<std::string>& Messages() const { return m_messages; }
+    const std::vector<ProgramBlock>& Blocks() const { return m_blocks; }
+
+    /// <summary>
+    /// Effect of running a block the given number of times, put together from its powers.
+    /// The powers must reach the highest bit of the count.
+    /// </summary>
+    RobotEffect RepeatEffect(uint32_t block, uint64_t count) const;
+
+    /// <summary>
+    /// Whether a line of a block command has been compiled, whether it compiled or not.
+    /// </summary>
+    bool HasBlockCommands() const { return m_hasBlockCommands; }
+
+    /// <summary>
+    /// Whether lines are being compiled into a block.
+    /// </summary>
+    bool IsBlockOpen() const { return !m_open.empty(); }
+
+    static bool IsBlockCommand(Command cmd)
+    {
+        return cmd == cmdDEFINE || cmd == cmdCALL || cmd == cmdREPEAT || cmd == cmdEND_BLOCK;
+    }
+
+    /// <summary>
+    /// Number of commands in the program, including the lines that failed to parse.
+    /// </summary>
+    size_t CommandCount() const { return m_commandCount; }
+
+    /// <summary>
+    /// Whether an EXIT command was compiled. No further lines are accepted after that.
+    /// </summary>
+    bool IsExited() const { return m_exited; }
+
+private:
+    /// <summary>
+    /// Block being compiled. The kind is cmdDEFINE or cmdREPEAT, or cmdUNKNOWN for a block whose opening
+    /// line is invalid, which is compiled to keep the braces balanced and then dropped.
+    /// </summary>
+    struct OpenBlock
+    {
+        Command kind;
+        uint32_t index;
+        uint64_t count;
+        std::string name;
+    };
+
+    void Open(Command cmd, std::string_view args);
+    void Close();
+    void Call(std::string_view args);
+
+    /// <summary>
+    /// Append a CALL or REPEAT of a closed block, unless it would nest the blocks too deeply.
+    /// </summary>
+    void AppendBlock(Command cmd, uint32_t index, uint64_t count);
+
+    std::vector<uint8_t>& CurrentCode() { return m_open.empty() ? m_code : m_blocks[m_open.back().index].code; }
+
+    std::vector<uint8_t> m_code;
+    std::vector<std::string> m_messages;
+    std::vector<ProgramBlock> m_blocks;
+    std::vector<OpenBlock> m_open;
+    std::unordered_map<std::string, uint32_t> m_macros;
+    size_t m_commandCount = 0;
+    bool m_exited = false;
+    bool m_hasBlockCommands = false;
+};
+
+/// <summary>
+/// Interpreter executing a compiled program on a robot.
+/// Successful commands run without any logging or string handling, turn notifications are only built
+/// when INFO is enabled. Failures and reports are logged with the same messages as the commanders.
+/// The runner is instantiated per robot type, so the board checks inline into the interpreter loop.
+/// A robot of the default board skips the runs of a block that log nothing at the current level: they are
+/// applied from the effect of the block, as many at a time as its powers allow, so a silent REPEAT costs
+/// O(log n) table lookups. The runs that log are executed command by command. Other robots run every block.
+/// </summary>
+template <typename TRobot>
+class BasicProgramRunner
+{
+public:
+    BasicProgramRunner(TRobot& robot, LoggerBase& logger)
+        : m_robot(robot),
+        m_logger(logger)
+    {}
+
+    /// <summary>
+    /// Copy constructor is not allowed
+    /// </summary>
+    BasicProgramRunner(const BasicProgramRunner&) = delete;
+
+    /// <summary>
+    /// Execute the whole program.
+    /// </summary>
+    void Run(const CommandProgram& program);
+
+    /// <summary>
+    /// Execute the whole program, coalescing runs of consecutive commands (--lazy).
+    /// A run of MOVEs is applied as one clamped displacement, and the rejected moves are counted instead of tried.
+    /// A run of turns reduces to its net rotation modulo 4 when their INFO messages are disabled.
+    /// The log is the same as Run's, message for message.
+    /// </summary>
+    void RunLazy(const CommandProgram& program);
+
+    /// <summary>
+    /// Write the REPORT results into the given sink instead of the log. The sink must outlive the runner.
+    /// </summary>
+    void SetResultSink(ResultSink* resultSink) { m_resultSink = resultSink; }
+
+private:
+    /// <summary>
+    /// Execute an opcode stream of the program, the top level or a block.
+    /// </summary>
+    void Execute(const CommandProgram& program, const std::vector<uint8_t>& code);
+    void ExecuteLazy(const CommandProgram& program, const std::vector<uint8_t>& code);
+
+    /// <summary>
+    /// Decode and run a CALL or a REPEAT.
+    /// </summary>
+    /// <returns>Position after the payload</returns>
+    const uint8_t* Call(const CommandProgram& program, const uint8_t* payload);
+    const uint8_t* Repeat(const CommandProgram& program, const uint8_t* payload);
+
+    /// <summary>
+    /// Run a block the given number of times.
+    /// </summary>
+    void RunBlock(const CommandProgram& program, uint32_t index, uint64_t count);
+
+    /// <summary>
+    /// Levels that write a record at the current log level, a mask of EffectLevel values.
+    /// </summary>
+    uint8_t EnabledLevels() const;
+
+    /// <summary>
+    /// Apply a single turn and log its outcome.
+    /// </summary>
+    /// <returns>[true] The robot turned. [false] The turn failed.</returns>
+    bool Turn(Command cmd);
+
+    /// <summary>
+    /// Decode and apply a PLACE.
+    /// </summary>
+    /// <returns>Position after the payload</returns>
+    const uint8_t* Place(const uint8_t* payload);
+
+    /// <summary>
+    /// Decode and log a line that failed to compile.
+    /// </summary>
+    /// <returns>Position after the payload</returns>
+    const uint8_t* Error(const CommandProgram& program, const uint8_t* payload);
+
+    void Fail(Command cmd, RobotResult result);
+    void Report();
+
+    TRobot& m_robot;
+    LoggerBase& m_logger;
+    ResultSink* m_resultSink = nullptr;
+    bool m_lazy = false;
+};
+
+using ProgramRunner = BasicProgramRunner<ToyRobot>;
+using RuntimeProgramRunner = BasicProgramRunner<RuntimeToyRobot>;
+
+// The runners are instantiated once in CommandProgram.cpp.
+extern template class BasicProgramRunner<ToyRobot>;
+extern template class BasicProgramRunner<RuntimeToyRobot>;
+extern template class BasicProgramRunner<DenseSharedToyRobot>;
+extern template class BasicProgramRunner<SparseSharedToyRobot>;
+
+/// <summary>
+/// Runs the block statements of a commander. A commander only sees RobotBase, so the runner is created next
+/// to the robot, where its type is known, and handed to the commander with SetStatementRunner.
+/// </summary>
+class StatementRunnerBase
+{
+public:
+    virtual ~StatementRunnerBase() = default;
+
+    /// <summary>
+    /// Run a compiled statement on the robot.
+    /// </summary>
+    /// <param name="statement">Macros and blocks of the script so far, and the statement to run</param>
+    /// <param name="logger">Logger of the commander</param>
+    /// <param name="resultSink">Sink of the REPORT results, or nullptr to log them</param>
+    virtual void RunStatement(const CommandProgram& statement, LoggerBase& logger, ResultSink* resultSink) = 0;
+};
+
+/// <summary>
+/// Statement runner of a robot of the given type, running the statements with its BasicProgramRunner.
+/// </summary>
+template <typename TRobot>
+class StatementRunner final : public StatementRunnerBase
+{
+public:
+    explicit StatementRunner(TRobot& robot)
+        : m_robot(robot)
+    {}
+
+    void RunStatement(const CommandProgram& statement, LoggerBase& logger, ResultSink* resultSink) override
+    {
+        BasicProgramRunner<TRobot> runner(m_robot, logger);
+        runner.SetResultSink(resultSink);
+        runner.Run(statement);
+    }
+
+private:
+    TRobot& m_robot;
+};
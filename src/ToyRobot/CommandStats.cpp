@@ -0,0 +1,198 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "CommandStats.h"
+#include <chrono>
+#include <memory>
+#include <sstream>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86)
+#define TOYROBOT_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TOYROBOT_HAS_RDTSC 1
+#endif
+
+namespace
+{
+    const char* const CommandNames[StatsCommandCount] = { "UNKNOWN", "PLACE", "MOVE", "LEFT", "RIGHT", "REPORT", "EXIT", "STATS", "DEFINE", "CALL", "REPEAT", "}" };
+    const char* const StageNames[ssCOUNT] = { "read", "parse", "execute", "log" };
+    const char* const ResultNames[StatsResultCount] = {
+        "success", "not placed", "already placed", "invalid x", "invalid y", "north edge", "south edge",
+        "east edge", "west edge", "unknown direction", "occupied"
+    };
+
+    uint64_t SteadyNanoseconds()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /// <summary>
+    /// Both clocks read at startup. The tick rate is measured from here, over the lifetime of the process.
+    /// </summary>
+    struct ClockBase
+    {
+        uint64_t nanoseconds = SteadyNanoseconds();
+        uint64_t ticks = CommandStats::Ticks();
+    };
+
+    const ClockBase g_clockBase;
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const
+{
+    if (m_count == 0)
+        return 0;
+
+    const auto target = static_cast<uint64_t>(percentile / 100 * static_cast<double>(m_count) + 0.5);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BucketCount; bucket++)
+    {
+        seen += m_counts[bucket];
+        if (seen >= target && seen > 0)
+            return UpperBound(bucket) < m_max ? UpperBound(bucket) : m_max;
+    }
+
+    return m_max;
+}
+
+size_t LatencyHistogram::BucketOf(uint64_t value)
+{
+    if (value < (uint64_t(2) << SubBucketBits))
+        return static_cast<size_t>(value);
+
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long exponent;
+    _BitScanReverse64(&exponent, value);
+#elif defined(__GNUC__)
+    const auto exponent = static_cast<unsigned>(63 - __builtin_clzll(value));
+#else
+    unsigned exponent = 63;
+    while ((value >> exponent) == 0)
+        exponent--;
+#endif
+
+    if (exponent > MaxExponent)
+        return BucketCount - 1;
+
+    // The leading bit and the next SubBucketBits bits select the bucket.
+    return (static_cast<size_t>(exponent - SubBucketBits) << SubBucketBits) + static_cast<size_t>(value >> (exponent - SubBucketBits));
+}
+
+uint64_t LatencyHistogram::UpperBound(size_t bucket)
+{
+    if (bucket < (size_t(2) << SubBucketBits))
+        return bucket;
+
+    const auto exponent = static_cast<unsigned>(bucket >> SubBucketBits) + SubBucketBits - 1;
+    const auto leading = (bucket & ((size_t(1) << SubBucketBits) - 1)) | (size_t(1) << SubBucketBits);
+    return ((static_cast<uint64_t>(leading) + 1) << (exponent - SubBucketBits)) - 1;
+}
+
+CommandStats& CommandStats::ThisThread()
+{
+    // On the heap, the histograms are too large for thread local storage.
+    thread_local const auto stats = std::make_unique<CommandStats>();
+    return *stats;
+}
+
+uint64_t CommandStats::Ticks()
+{
+#if defined(TOYROBOT_HAS_RDTSC)
+    return __rdtsc();
+#else
+    return SteadyNanoseconds();
+#endif
+}
+
+double CommandStats::NanosecondsPerTick()
+{
+#if defined(TOYROBOT_HAS_RDTSC)
+    // A summary is rarely asked for within the first millisecond, spin in case it is.
+    auto nanoseconds = SteadyNanoseconds() - g_clockBase.nanoseconds;
+    while (nanoseconds < 1000000)
+        nanoseconds = SteadyNanoseconds() - g_clockBase.nanoseconds;
+
+    const auto ticks = Ticks() - g_clockBase.ticks;
+    return ticks == 0 ? 1.0 : static_cast<double>(nanoseconds) / static_cast<double>(ticks);
+#else
+    return 1.0;
+#endif
+}
+
+void CommandStats::Reset()
+{
+    *this = CommandStats();
+}
+
+std::vector<std::string> CommandStats::Summary() const
+{
+    const auto scale = NanosecondsPerTick();
+    const auto nanoseconds = [scale](uint64_t ticks) { return static_cast<uint64_t>(static_cast<double>(ticks) * scale + 0.5); };
+
+    std::vector<std::string> lines;
+    for (size_t cmd = 0; cmd < StatsCommandCount; cmd++)
+    {
+        const auto& latencies = m_latencies[cmd];
+        if (latencies[ssPARSE].Count() == 0)
+            continue;
+
+        std::ostringstream line;
+        line << CommandNames[cmd] << " count=" << latencies[ssPARSE].Count() << " ns p50/p99/max:";
+        for (auto stage = 0; stage < ssCOUNT; stage++)
+        {
+            const auto& histogram = latencies[stage];
+            line << " " << StageNames[stage] << "=" << nanoseconds(histogram.Percentile(50)) << "/"
+                << nanoseconds(histogram.Percentile(99)) << "/" << nanoseconds(histogram.Max());
+        }
+        lines.push_back(line.str());
+
+        std::ostringstream results;
+        results << CommandNames[cmd] << " results:";
+        auto any = false;
+        for (size_t result = 0; result < StatsResultCount; result++)
+        {
+            if (m_results[cmd][result] == 0)
+                continue;
+
+            results << (any ? ", " : " ") << ResultNames[result] << "=" << m_results[cmd][result];
+            any = true;
+        }
+
+        if (cmd == cmdPLACE && m_invalidArguments != 0)
+        {
+            results << (any ? ", " : " ") << "invalid arguments=" << m_invalidArguments;
+            any = true;
+        }
+
+        if (any)
+            lines.push_back(results.str());
+    }
+
+    if (lines.empty())
+        lines.push_back("No commands executed.");
+
+    return lines;
+}
@@ -0,0 +1,165 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Commands.h"
+#include "RobotResult.h"
+
+/// <summary>
+/// Compile time switch of the command statistics. When it is zero, the default, the instrumentation compiles to
+/// nothing and the STATS command only reports that statistics are not available.
+/// </summary>
+#ifndef TOYROBOT_ENABLE_STATS
+#define TOYROBOT_ENABLE_STATS 0
+#endif
+
+constexpr bool StatsEnabled = TOYROBOT_ENABLE_STATS != 0;
+
+/// <summary>
+/// Stages of a command timed by the statistics.
+/// </summary>
+enum StatsStage
+{
+    ssREAD = 0,
+    ssPARSE = 1,
+    ssEXECUTE = 2,
+    ssLOG = 3,
+    ssCOUNT = 4
+};
+
+const size_t StatsCommandCount = cmdEND_BLOCK + 1;
+
+const size_t StatsResultCount = rrOCCUPIED + 1;
+
+/// <summary>
+/// Histogram of tick counts with log-linear buckets, as in HdrHistogram: values below 32 have their own bucket,
+/// every larger power of two is split into 16 buckets, so a value is known within 6%.
+/// </summary>
+class LatencyHistogram
+{
+public:
+    static const unsigned SubBucketBits = 4;
+
+    /// <summary>
+    /// Largest power of two kept apart. Longer durations (2^40 ticks is minutes) share the last bucket.
+    /// </summary>
+    static const unsigned MaxExponent = 40;
+    static const size_t BucketCount = (MaxExponent - SubBucketBits + 1) << SubBucketBits;
+
+    void Record(uint64_t value)
+    {
+        m_counts[BucketOf(value)]++;
+        m_count++;
+        m_max = value > m_max ? value : m_max;
+    }
+
+    uint64_t Count() const { return m_count; }
+    uint64_t Max() const { return m_max; }
+
+    /// <summary>
+    /// Smallest value that at least the given percentage of the recorded values do not exceed, rounded up to the
+    /// end of its bucket.
+    /// </summary>
+    uint64_t Percentile(double percentile) const;
+
+    static size_t BucketOf(uint64_t value);
+
+    /// <summary>
+    /// Largest value falling into the bucket.
+    /// </summary>
+    static uint64_t UpperBound(size_t bucket);
+
+private:
+    uint64_t m_counts[BucketCount] = {};
+    uint64_t m_count = 0;
+    uint64_t m_max = 0;
+};
+
+/// <summary>
+/// Latency histograms per command and stage, and counters of the results of the robot, of one thread.
+/// Threads only ever touch their own statistics, so recording takes no lock and no atomic operation.
+/// </summary>
+class CommandStats
+{
+public:
+    /// <summary>
+    /// Statistics of the calling thread, created on first use.
+    /// </summary>
+    static CommandStats& ThisThread();
+
+    /// <summary>
+    /// Current time in ticks: the time stamp counter on x86, steady_clock nanoseconds elsewhere.
+    /// </summary>
+    static uint64_t Ticks();
+
+    /// <summary>
+    /// Length of a tick, measured against steady_clock since the start of the process.
+    /// </summary>
+    static double NanosecondsPerTick();
+
+    void Record(Command cmd, StatsStage stage, uint64_t ticks)
+    {
+        m_latencies[cmd][stage].Record(ticks);
+    }
+
+    /// <summary>
+    /// Count the outcome of a robot command: rrSUCCESS, or the reason the robot refused it.
+    /// </summary>
+    void CountResult(Command cmd, RobotResult result)
+    {
+        m_results[cmd][result]++;
+    }
+
+    /// <summary>
+    /// Count a PLACE whose arguments do not parse.
+    /// </summary>
+    void CountInvalidArguments()
+    {
+        m_invalidArguments++;
+    }
+
+    /// <summary>
+    /// Ticks when the line of the current command was read. Left by CommanderBase::GetCommand for Launch.
+    /// </summary>
+    uint64_t& ReadEndTicks() { return m_readEndTicks; }
+
+    /// <summary>
+    /// Ticks spent printing log records on this thread so far. Execute time is split from log time with it.
+    /// </summary>
+    uint64_t& LogTicks() { return m_logTicks; }
+
+    void Reset();
+
+    /// <summary>
+    /// Summary of the statistics, one line per command that was seen and one line of results per command.
+    /// </summary>
+    std::vector<std::string> Summary() const;
+
+private:
+    LatencyHistogram m_latencies[StatsCommandCount][ssCOUNT];
+    uint64_t m_results[StatsCommandCount][StatsResultCount] = {};
+    uint64_t m_invalidArguments = 0;
+    uint64_t m_readEndTicks = 0;
+    uint64_t m_logTicks = 0;
+};
@@ -19,214 +19,517 @@
  */
 
 #include "Commander.h"
+#include "Journal.h"
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <string>
 
-CommanderBase::CommanderBase(ToyRobot& robot, LoggerBase& logger)
+namespace
+{
+    /// <summary>
+    /// Case insensitive comparison against a lower-case keyword of the same length.
+    /// </summary>
+    bool EqualsKeyword(std::string_view str, std::string_view keyword)
+    {
+        for (size_t idx = 0; idx < keyword.size(); idx++)
+        {
+            if ((str[idx] | 0x20) != keyword[idx])
+                return false;
+        }
+
+        return true;
+    }
+
+    /// <summary>
+    /// Count a command the robot accepted. Rejections are counted by the robot when it logs them.
+    /// </summary>
+    void CountSuccess(Command cmd)
+    {
+        if constexpr (StatsEnabled)
+            CommandStats::ThisThread().CountResult(cmd, rrSUCCESS);
+    }
+
+    /// <summary>
+    /// Keyword dispatch for the commands. Switches on length and the first letter,
+    /// so each keyword is confirmed with a single comparison.
+    /// </summary>
+    Command LookupCommand(std::string_view keyword)
+    {
+        switch (keyword.size())
+        {
+        case 1:
+            return keyword[0] == '}' ? cmdEND_BLOCK : cmdUNKNOWN;
+        case 4:
+            switch (keyword[0] | 0x20)
+            {
+            case 'm': return EqualsKeyword(keyword, "move") ? cmdMOVE : cmdUNKNOWN;
+            case 'l': return EqualsKeyword(keyword, "left") ? cmdTURN_LEFT : cmdUNKNOWN;
+            case 'e': return EqualsKeyword(keyword, "exit") ? cmdEXIT : cmdUNKNOWN;
+            case 'c': return EqualsKeyword(keyword, "call") ? cmdCALL : cmdUNKNOWN;
+            default: return cmdUNKNOWN;
+            }
+        case 5:
+            switch (keyword[0] | 0x20)
+            {
+            case 'p': return EqualsKeyword(keyword, "place") ? cmdPLACE : cmdUNKNOWN;
+            case 'r': return EqualsKeyword(keyword, "right") ? cmdTURN_RIGHT : cmdUNKNOWN;
+            case 's': return EqualsKeyword(keyword, "stats") ? cmdSTATS : cmdUNKNOWN;
+            default: return cmdUNKNOWN;
+            }
+        case 6:
+            // REPORT and REPEAT share their first three letters.
+            switch (keyword[0] | 0x20)
+            {
+            case 'r': return EqualsKeyword(keyword, "report") ? cmdREPORT : EqualsKeyword(keyword, "repeat") ? cmdREPEAT : cmdUNKNOWN;
+            case 'd': return EqualsKeyword(keyword, "define") ? cmdDEFINE : cmdUNKNOWN;
+            default: return cmdUNKNOWN;
+            }
+        default:
+            return cmdUNKNOWN;
+        }
+    }
+
+    /// <summary>
+    /// Keyword dispatch for the facing directions.
+    /// </summary>
+    bool TryLookupFacingDirection(std::string_view keyword, FacingDirection& facingDirection)
+    {
+        switch (keyword.size())
+        {
+        case 4:
+            switch (keyword[0] | 0x20)
+            {
+            case 'e': facingDirection = fdEAST; return EqualsKeyword(keyword, "east");
+            case 'w': facingDirection = fdWEST; return EqualsKeyword(keyword, "west");
+            default: return false;
+            }
+        case 5:
+            switch (keyword[0] | 0x20)
+            {
+            case 'n': facingDirection = fdNORTH; return EqualsKeyword(keyword, "north");
+            case 's': facingDirection = fdSOUTH; return EqualsKeyword(keyword, "south");
+            default: return false;
+            }
+        case 7:
+            facingDirection = fdUNKNOWN;
+            return EqualsKeyword(keyword, "unknown");
+        default:
+            return false;
+        }
+    }
+}
+
+CommanderBase::CommanderBase(RobotRef robot, LoggerBase& logger)
     : m_robot(robot),
     m_logger(logger)
 {
-    for (const auto& entry : m_facingDirections)
-        m_facingDirectionStrings.emplace(entry.second, entry.first);
 }
 
 void CommanderBase::Launch()
 {
     m_logger.Info("Toy robot starting..");
 
+    const auto prompt = ShowsPrompt();
+    if constexpr (StatsEnabled)
+        CommandStats::ThisThread().Reset();
+
+    // Without a prompt the next command is read as soon as the previous one is done, so its end is the next start.
+    uint64_t ticks = 0;
     auto cmd = cmdUNKNOWN;
     while (cmd != cmdEXIT)
     {
-        std::vector<std::string> args;
+        if (prompt)
+            m_logger.Info("Please enter command : ", "");
 
-        cmd = GetCommand(args);
-        switch (cmd)
+        std::string_view args;
+        if constexpr (StatsEnabled)
         {
-        case cmdPLACE:
-            Place(args);
-            break;
-        case cmdMOVE:
-            Move();
-            break;
-        case cmdTURN_LEFT:
-        {
-            const auto sucess = m_robot.TryTurnLeft();
-            if (!sucess)
-                m_logger.Error("Turn left failed.");
-            break;
+            auto& readTicks = CommandStats::ThisThread().ReadEndTicks();
+            const auto start = prompt || ticks == 0 ? CommandStats::Ticks() : ticks;
+            readTicks = start;
+            cmd = GetCommand(args);
+            ticks = ExecuteMeasured(cmd, args, start, readTicks, CommandStats::Ticks());
         }
-        case cmdTURN_RIGHT:
+        else
         {
-            const auto sucess = m_robot.TryTurnRight();
-            if (!sucess)
-                m_logger.Error("Turn right failed.");
-            break;
-        }
-        case cmdREPORT:
-            Report();
-            break;
-        case cmdEXIT:
-            continue;
-            break;
-        case cmdUNKNOWN:
-        default:
-            m_logger.Error("Unknown command");
-            break;
+            cmd = GetCommand(args);
+            Execute(cmd, args);
         }
+
+        OnExecuted(cmd, args);
     }
 
+    OnQuit();
+    if constexpr (StatsEnabled)
+        Stats();
+
     m_logger.Info("Toy robot quitting..");
 }
 
-void CommanderBase::Place(std::vector<std::string>& xargs)
+uint64_t CommanderBase::ExecuteMeasured(Command cmd, std::string_view args, uint64_t startTicks, uint64_t readTicks, uint64_t parsedTicks)
+{
+    auto& stats = CommandStats::ThisThread();
+    const auto logTicks = stats.LogTicks();
+    Execute(cmd, args);
+    const auto endTicks = CommandStats::Ticks();
+    const auto executed = endTicks - parsedTicks;
+    const auto logged = stats.LogTicks() - logTicks;
+
+    stats.Record(cmd, ssREAD, readTicks - startTicks);
+    stats.Record(cmd, ssPARSE, parsedTicks - readTicks);
+    stats.Record(cmd, ssEXECUTE, executed > logged ? executed - logged : 0);
+    stats.Record(cmd, ssLOG, logged);
+    return endTicks;
+}
+
+void CommanderBase::Execute(Command cmd, std::string_view args)
 {
-    if (xargs.size() != 1)
+    // Lines of an open block are compiled into it, not executed.
+    if (m_statement.IsBlockOpen() || CommandProgram::IsBlockCommand(cmd))
     {
-        m_logger.Error("Invalid number of arguments for place command. Command expects 3 arguments in the form of (place x,y,direction)");
+        const auto* place = cmd == cmdPLACE ? ParsedPlace() : nullptr;
+        if (place != nullptr)
+            m_statement.AppendPlace(place->x, place->y, place->facingDirection);
+        else
+            ExecuteBlockCommand(cmd, args);
         return;
     }
 
-    const auto args = Split(xargs[0], ",");
+    switch (cmd)
+    {
+    case cmdPLACE:
+    case cmdMOVE:
+    case cmdTURN_LEFT:
+    case cmdTURN_RIGHT:
+    case cmdREPORT:
+        m_robot.Execute(*this, cmd, args);
+        break;
+    case cmdSTATS:
+        Stats();
+        break;
+    case cmdEXIT:
+        break;
+    case cmdUNKNOWN:
+    default:
+        m_logger.Error("Unknown command");
+        break;
+    }
+}
 
-    if (args.size() != 3)
+const char* CommanderBase::GetFailureMessage(Command cmd)
+{
+    switch (cmd)
     {
-        m_logger.Error("Invalid number of arguments for place command. Command expects 3 arguments in the form of (place  x,y,direction)");
-        return;
+    case cmdPLACE:
+        return "Placement failed.";
+    case cmdMOVE:
+        return "Move failed.";
+    case cmdTURN_LEFT:
+        return "Turn left failed.";
+    case cmdTURN_RIGHT:
+        return "Turn right failed.";
+    default:
+        return "Unknown command";
     }
+}
 
-    int x = 0;
-    if (!TryParseInt(args[0], x))
+bool CommanderBase::TryParsePlace(std::string_view xargs, PlaceArgs& place, std::string& error)
+{
+    std::string_view placeArgs;
+    if (Split(xargs, ' ', &placeArgs, 1) != 1)
     {
-        m_logger.Error("Invalid x value: " + args[0]);
-        return;
+        error = "Invalid number of arguments for place command. Command expects 3 arguments in the form of (place x,y,direction)";
+        return false;
     }
 
-    int y = 0;
-    if (!TryParseInt(args[1], y))
+    std::string_view args[3];
+    if (Split(placeArgs, ',', args, 3) != 3)
     {
-        m_logger.Error("Invalid y value : " + args[1]);
-        return;
+        error = "Invalid number of arguments for place command. Command expects 3 arguments in the form of (place  x,y,direction)";
+        return false;
     }
 
-    const auto facingDirectionItr = m_facingDirections.find(ToLower(args[2]));
-    if (facingDirectionItr == m_facingDirections.end())
+    if (!TryParseInt(args[0], place.x))
     {
-        m_logger.Error("Invalid facing direction: " + args[2]);
-        return;
+        error = "Invalid x value: " + std::string(args[0]);
+        return false;
     }
 
-    const auto sucess = m_robot.TryPlace(x, y, facingDirectionItr->second);
-    if (!sucess)
+    if (!TryParseInt(args[1], place.y))
     {
-        m_logger.Error("Placement failed.");
-        return;
+        error = "Invalid y value : " + std::string(args[1]);
+        return false;
     }
+
+    if (!TryLookupFacingDirection(args[2], place.facingDirection))
+    {
+        error = "Invalid facing direction: " + std::string(args[2]);
+        return false;
+    }
+
+    return true;
+}
+
+bool CommanderBase::TryGetPlace(std::string_view args, PlaceArgs& place)
+{
+    const auto* parsed = ParsedPlace();
+    if (parsed != nullptr)
+    {
+        place = *parsed;
+        return true;
+    }
+
+    std::string error;
+    if (!TryParsePlace(args, place, error))
+    {
+        if constexpr (StatsEnabled)
+            CommandStats::ThisThread().CountInvalidArguments();
+
+        m_logger.Error(error);
+        return false;
+    }
+
+    return true;
 }
 
-void CommanderBase::Move()
+void CommanderBase::OnRobotResult(Command cmd, bool sucess)
 {
-    const auto sucess = m_robot.TryMove();
     if (!sucess)
-        m_logger.Error("Move failed.");
+        m_logger.Error(GetFailureMessage(cmd));
+    else
+        CountSuccess(cmd);
 }
 
-void CommanderBase::Report()
+void CommanderBase::ExecuteBlockCommand(Command cmd, std::string_view args)
 {
-    uint8_t x;
-    uint8_t y;
-    FacingDirection facingDirection;
+    m_statement.CompileCommand(cmd, args);
+    if (m_statement.IsBlockOpen() || m_statement.Code().empty())
+        return;
 
-    m_robot.Report(x, y, facingDirection);
-    m_logger.Info("Output: " + std::to_string(x) + "," + std::to_string(y) + "," + ToUpper(m_facingDirectionStrings[facingDirection]));
+    if (m_statementRunner != nullptr)
+        m_statementRunner->RunStatement(m_statement, m_logger, m_resultSink);
+    else
+        m_logger.Error("Blocks are not supported by this robot.");
+
+    m_statement.ClearCode();
 }
 
-std::vector<std::string> CommanderBase::Split(const std::string& str, const std::string& delimiter)
+void CommanderBase::Report(uint64_t x, uint64_t y, FacingDirection facingDirection)
 {
-    std::vector<std::string> tokens;
+    CountSuccess(cmdREPORT);
+    if (m_resultSink != nullptr)
+    {
+        m_resultSink->Write(x, y, facingDirection);
+        return;
+    }
+
+    static const char Prefix[] = "Output: ";
+    char output[sizeof(Prefix) - 1 + MaxPositionLength];
+    std::memcpy(output, Prefix, sizeof(Prefix) - 1);
+    const auto length = FormatPosition(output + sizeof(Prefix) - 1, x, y, facingDirection);
+    m_logger.Output(std::string_view(output, sizeof(Prefix) - 1 + length));
+}
+
+void CommanderBase::Stats()
+{
+    if constexpr (StatsEnabled)
+    {
+        for (const auto& line : CommandStats::ThisThread().Summary())
+            m_logger.Output("Stats: " + line);
+    }
+    else
+    {
+        m_logger.Error("Statistics are not enabled in this build. Define TOYROBOT_ENABLE_STATS=1 to enable them.");
+    }
+}
+
+size_t CommanderBase::Split(std::string_view str, char delimiter, std::string_view* tokens, size_t maxTokens)
+{
+    size_t count = 0;
     size_t prev = 0;
-    size_t pos = 0;
-    do
+    while (prev < str.length())
     {
-        pos = str.find(delimiter, prev);
-        if (pos == std::string::npos)
+        auto pos = str.find(delimiter, prev);
+        if (pos == std::string_view::npos)
             pos = str.length();
 
-        std::string token = str.substr(prev, pos - prev);
-        if (!token.empty())
-            tokens.push_back(token);
+        if (pos > prev)
+        {
+            if (count < maxTokens)
+                tokens[count] = str.substr(prev, pos - prev);
+            count++;
+        }
 
-        prev = pos + delimiter.length();
+        prev = pos + 1;
+    }
+
+    return count;
+}
 
-    } while (pos < str.length() && prev < str.length());
+Command CommanderBase::GetCommand(std::string_view& args)
+{
+    std::string_view input;
+    if constexpr (StatsEnabled)
+    {
+        const auto read = TryReadLine(input);
+        CommandStats::ThisThread().ReadEndTicks() = CommandStats::Ticks();
+        if (!read)
+            return cmdEXIT;
+    }
+    else if (!TryReadLine(input))
+    {
+        return cmdEXIT;
+    }
 
-    return tokens;
+    return ParseCommand(input, args);
 }
 
-std::string CommanderBase::ToLower(std::string str)
+Command CommanderBase::ParseCommand(std::string_view input, std::string_view& args)
 {
-    std::string strlower = str;
-    std::for_each(strlower.begin(), strlower.end(), [](char& c) {
-        c = ::tolower(c);
-    });
+    const auto begin = input.find_first_not_of(' ');
+    if (begin == std::string_view::npos)
+        return cmdUNKNOWN;
+
+    auto end = input.find(' ', begin);
+    if (end == std::string_view::npos)
+        end = input.length();
+
+    const auto cmd = LookupCommand(input.substr(begin, end - begin));
+    if (cmd != cmdUNKNOWN)
+        args = input.substr(end);
 
-    return strlower;
+    return cmd;
 }
 
-std::string CommanderBase::ToUpper(std::string str)
+bool ConsoleCommander::TryReadLine(std::string_view& input)
 {
-    std::string strupper = str;
-    std::for_each(strupper.begin(), strupper.end(), [](char& c) {
-        c = ::toupper(c);
-        });
+    if (!std::getline(std::cin, m_line))
+        return false;
 
-    return strupper;
+    input = m_line;
+    return true;
 }
 
-bool CommanderBase::TryParseInt(std::string str, int& num)
+PipeCommander::PipeCommander(std::istream& input, RobotRef robot, LoggerBase& logger, size_t chunkSize)
+    : CommanderBase(robot, logger),
+    m_input(input.rdbuf()),
+    m_buffer(chunkSize > 0 ? chunkSize : DefaultChunkSize)
 {
-    char* end;
-    num = strtol(str.c_str(), &end, 10);
-    return *end == '\0';
 }
 
-Command CommanderBase::GetCommand(std::vector<std::string>& args)
+bool PipeCommander::TryReadLine(std::string_view& input)
 {
-    m_logger.Info("Please enter command : ", "");
+    for (;;)
+    {
+        const auto begin = m_buffer.data() + m_begin;
+        const auto end = m_buffer.data() + m_end;
+        const auto newline = FindNewline(begin, end);
+        if (newline != end || (m_eof && begin != end))
+        {
+            auto lineEnd = newline;
+            if (lineEnd != begin && *(lineEnd - 1) == '\r')
+                lineEnd--;
 
-    std::string input;
-    if (!TryReadLine(input))
-        return cmdEXIT;
+            input = std::string_view(begin, lineEnd - begin);
+            m_begin = newline == end ? m_end : static_cast<size_t>(newline - m_buffer.data()) + 1;
+            return true;
+        }
 
-    const auto cmdArgs = Split(input, " ");
-    if (cmdArgs.size() == 0)
-        return cmdUNKNOWN;
+        if (m_eof)
+            return false;
 
-    const auto commandItr = m_commands.find(ToLower(cmdArgs[0]));
-    if (commandItr == m_commands.end())
-        return cmdUNKNOWN;
+        Fill();
+    }
+}
 
-    for (size_t idx = 1; idx < cmdArgs.size(); idx++)
-        args.push_back(cmdArgs[idx]);
+void PipeCommander::Fill()
+{
+    if (m_begin > 0)
+    {
+        std::memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+        m_end -= m_begin;
+        m_begin = 0;
+    }
 
-    return commandItr->second;
+    if (m_end == m_buffer.size())
+        m_buffer.resize(m_buffer.size() * 2);
+
+    const auto count = m_input->sgetn(m_buffer.data() + m_end, static_cast<std::streamsize>(m_buffer.size() - m_end));
+    if (count <= 0)
+        m_eof = true;
+    else
+        m_end += static_cast<size_t>(count);
+}
+
+FileCommander::FileCommander(std::string path, RobotRef robot, LoggerBase& logger)
+    : CommanderBase(robot, logger)
+{
+    if (m_mappedFile.TryOpen(path))
+        m_scanner = LineScanner(m_mappedFile.Data(), m_mappedFile.Data() + m_mappedFile.Size());
+    else
+        m_filestream.open(path, std::ios::binary);
 }
 
-bool ConsoleCommander::TryReadLine(std::string& input)
+bool FileCommander::TryReadLine(std::string_view& input)
 {
-    std::getline(std::cin, input);
+    if (m_mappedFile.IsOpen())
+        return m_scanner.TryNextLine(input);
 
+    if (!m_filestream.is_open())
+        return false;
+
+    if (!std::getline(m_filestream, m_line))
+        return false;
+
+    // Same as the line scanner: the offset counts every byte, but a trailing carriage return is not part of the line.
+    m_streamOffset += m_line.size() + (m_filestream.eof() ? 0 : 1);
+    if (!m_line.empty() && m_line.back() == '\r')
+        m_line.pop_back();
+
+    input = m_line;
     return true;
 }
 
-bool FileCommander::TryReadLine(std::string& input)
+uint64_t FileCommander::InputOffset() const
+{
+    if (m_mappedFile.IsOpen())
+        return static_cast<uint64_t>(m_scanner.Position() - m_mappedFile.Data());
+
+    return m_streamOffset;
+}
+
+bool FileCommander::TrySeek(uint64_t offset)
 {
+    if (m_mappedFile.IsOpen())
+    {
+        if (offset > m_mappedFile.Size())
+            return false;
+
+        m_scanner = LineScanner(m_mappedFile.Data() + offset, m_mappedFile.Data() + m_mappedFile.Size());
+        return true;
+    }
+
     if (!m_filestream.is_open())
         return false;
 
-    if (!std::getline(m_filestream, input))
+    m_filestream.clear();
+    if (!m_filestream.seekg(static_cast<std::streamoff>(offset)))
         return false;
 
+    m_streamOffset = offset;
     return true;
+}
+
+void FileCommander::OnExecuted(Command cmd, std::string_view args)
+{
+    if (m_journal != nullptr)
+        m_journal->Record(cmd, args, InputOffset());
+}
+
+void FileCommander::OnQuit()
+{
+    if (m_journal != nullptr)
+        m_journal->Finish(InputOffset());
 }
\ No newline at end of file
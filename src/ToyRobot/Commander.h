@@ -22,118 +22,282 @@
 
 #include <iostream>
 #include <string>
-#include <map>
-#include <vector>
-#include "ToyRobot.h"
+#include <string_view>
+#include <charconv>
+#include <stdint.h>
+#include "RobotBase.h"
+#include "CommandProgram.h"
 #include "Commands.h"
 #include "Logger.h"
+#include "LineScanner.h"
+#include "MappedFile.h"
+#include "ResultSink.h"
 #include <fstream>
+#include <type_traits>
+#include <vector>
+
+class CommanderBase;
+class JournalWriter;
+
+/// <summary>
+/// Arguments of the place command.
+/// </summary>
+struct PlaceArgs
+{
+    int64_t x = 0;
+    int64_t y = 0;
+    FacingDirection facingDirection = fdUNKNOWN;
+};
+
+/// <summary>
+/// Robot of a commander. It converts from a reference to a robot of any type, and keeps the robot commands
+/// of CommanderBase compiled for that type, so a ToyRobot is called directly rather than through RobotBase.
+/// A RobotBase reference keeps the calls virtual.
+/// </summary>
+class RobotRef
+{
+public:
+    template <typename TRobot, typename = std::enable_if_t<!std::is_same_v<TRobot, RobotRef>>>
+    RobotRef(TRobot& robot)
+        : m_robot(&robot),
+        m_execute(&ExecuteOn<TRobot>)
+    {}
+
+    /// <summary>
+    /// Convey a PLACE, MOVE, LEFT, RIGHT or REPORT command to the robot.
+    /// </summary>
+    void Execute(CommanderBase& commander, Command cmd, std::string_view args) const
+    {
+        m_execute(commander, m_robot, cmd, args);
+    }
+
+private:
+    template <typename TRobot>
+    static void ExecuteOn(CommanderBase& commander, void* robot, Command cmd, std::string_view args);
+
+    void* m_robot;
+    void (*m_execute)(CommanderBase& commander, void* robot, Command cmd, std::string_view args);
+};
 
 // Commander Base class. This class provide abstraction for console and file commanders.
 class CommanderBase
 {
 public:
-    CommanderBase(ToyRobot& robot, LoggerBase& logger);
+    CommanderBase(RobotRef robot, LoggerBase& logger);
     void Launch();
 
+    /// <summary>
+    /// Parse a single input line into a command. Does not allocate.
+    /// </summary>
+    /// <param name="input">Input line</param>
+    /// <param name="args">View of the arguments following the command keyword</param>
+    /// <returns>The command</returns>
+    static Command ParseCommand(std::string_view input, std::string_view& args);
+
+    /// <summary>
+    /// Helper function for splitting string by given delimiter. Empty tokens are skipped.
+    /// </summary>
+    /// <param name="str">Input string</param>
+    /// <param name="delimiter">Delimiter character</param>
+    /// <param name="tokens">Output array receiving views of the tokens</param>
+    /// <param name="maxTokens">Capacity of the output array</param>
+    /// <returns>Number of tokens found. This can be larger than maxTokens, in which case only the first maxTokens are stored.</returns>
+    static size_t Split(std::string_view str, char delimiter, std::string_view* tokens, size_t maxTokens);
+
+    /// <summary>
+    /// Try convert the provided string to an integer. Values out of the range of TInteger fail.
+    /// </summary>
+    /// <param name="str">Input string</param>
+    /// <param name="num">result integer if conversion if sucess</param>
+    /// <returns>[true] conversion sucess. [false] conversion failed.</returns>
+    template <typename TInteger>
+    static bool TryParseInt(std::string_view str, TInteger& num)
+    {
+        // strtol used to accept an explicit plus sign, keep accepting it.
+        if (!str.empty() && str[0] == '+')
+            str.remove_prefix(1);
+
+        const auto end = str.data() + str.size();
+        const auto result = std::from_chars(str.data(), end, num);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    /// <summary>
+    /// Try parse the arguments of the place command in the form of (x,y,direction).
+    /// </summary>
+    /// <param name="args">User arguments</param>
+    /// <param name="place">Parsed arguments if the parsing sucess</param>
+    /// <param name="error">Error message if the parsing failed</param>
+    /// <returns>[true] parsing sucess. [false] parsing failed.</returns>
+    static bool TryParsePlace(std::string_view args, PlaceArgs& place, std::string& error);
+
+    /// <summary>
+    /// Write the REPORT results into the given sink instead of the log. The sink must outlive the commander.
+    /// </summary>
+    void SetResultSink(ResultSink* resultSink) { m_resultSink = resultSink; }
+
+    /// <summary>
+    /// Run the block statements with the given runner, which must outlive the commander.
+    /// Without a runner the block commands are rejected.
+    /// </summary>
+    void SetStatementRunner(StatementRunnerBase* statementRunner) { m_statementRunner = statementRunner; }
+
+    /// <summary>
+    /// Error message logged when the robot rejects the given command.
+    /// </summary>
+    static const char* GetFailureMessage(Command cmd);
+
 protected:
     /// <summary>
     /// Try to read a single line from the input stream.
     /// </summary>
-    /// <param name="input">string reference for loading the input value</param>
+    /// <param name="input">View of the line. It is valid until the next call.</param>
     /// <returns>[true] Line is read sucessfully. [false] input stream is closed</returns>
-    bool virtual TryReadLine(std::string& input) = 0;
+    bool virtual TryReadLine(std::string_view& input) = 0;
 
-private:
     /// <summary>
     /// Get a single command from user
     /// </summary>
-    /// <param name="args">List of user provided input arguments.</param>
+    /// <param name="args">View of the user provided input arguments.</param>
     /// <returns>The command</returns>
-    Command GetCommand(std::vector<std::string>& args);
+    virtual Command GetCommand(std::string_view& args);
 
     /// <summary>
-    /// Convey the place command to the robot.
+    /// Convey a single command to the robot.
     /// </summary>
+    /// <param name="cmd">The command</param>
     /// <param name="args">User arguments</param>
-    void Place(std::vector<std::string>& args);
+    void Execute(Command cmd, std::string_view args);
 
     /// <summary>
-    /// Convey move command to the robot.
+    /// Arguments of the current place command when the input already holds them parsed, as a binary file does.
     /// </summary>
-    void Move();
+    /// <returns>The parsed arguments, or nullptr to parse them from the text of the command</returns>
+    virtual const PlaceArgs* ParsedPlace() const { return nullptr; }
 
     /// <summary>
-    /// Convey report command and print output on the user stream.
+    /// Called by Launch after every executed command. Does nothing by default.
     /// </summary>
-    void Report();
+    /// <param name="cmd">The command</param>
+    /// <param name="args">User arguments. Valid until the next line is read.</param>
+    virtual void OnExecuted(Command /*cmd*/, std::string_view /*args*/) {}
 
     /// <summary>
-    /// Helper function for splitting string by given delimiter.
+    /// Called by Launch once the commander quits. Does nothing by default.
     /// </summary>
-    std::vector<std::string> Split(const std::string& str, const std::string& delimiter);
+    virtual void OnQuit() {}
 
     /// <summary>
-    /// Helper function for converting string to lower case.
+    /// Whether Launch logs a prompt before reading every command.
     /// </summary>
-    /// <param name="str">Input string</param>
-    /// <returns>Output string converted to lower-case</returns>
-    std::string ToLower(std::string str);
+    virtual bool ShowsPrompt() const { return true; }
 
     /// <summary>
-    /// Helper function for converting string to upper case
+    /// Execute a command and record the latencies of its stages in the statistics of the thread.
+    /// The time spent logging during Execute is reported as the log stage.
     /// </summary>
-    /// <param name="str">Input string</param>
-    /// <returns>Output string converted to upper-case</returns>
-    std::string ToUpper(std::string str);
+    /// <param name="startTicks">Ticks when reading the command started</param>
+    /// <param name="readTicks">Ticks when the command was read</param>
+    /// <param name="parsedTicks">Ticks when the command was parsed</param>
+    /// <returns>Ticks when the command was executed</returns>
+    uint64_t ExecuteMeasured(Command cmd, std::string_view args, uint64_t startTicks, uint64_t readTicks, uint64_t parsedTicks);
+
+private:
+    friend class RobotRef;
 
     /// <summary>
-    /// Try convert the provided string to an integer.
+    /// Convey a PLACE, MOVE, LEFT, RIGHT or REPORT command to a robot of the given type.
     /// </summary>
-    /// <param name="str">Input string</param>
-    /// <param name="num">result integer if conversion if sucess</param>
-    /// <returns>[true] conversion sucess. [false] conversion failed.</returns>
-    bool TryParseInt(std::string str, int& num);
+    template <typename TRobot>
+    void ExecuteRobotCommand(TRobot& robot, Command cmd, std::string_view args);
+
+    /// <summary>
+    /// Arguments of the place command, parsed from the user arguments unless the input holds them.
+    /// </summary>
+    /// <param name="args">User arguments</param>
+    /// <param name="place">Place arguments</param>
+    /// <returns>[true] Arguments are valid. [false] They are invalid, the error is logged.</returns>
+    bool TryGetPlace(std::string_view args, PlaceArgs& place);
 
     /// <summary>
-    /// Mapping of commands and their internal representation.
+    /// Log the failure of a robot command, or count its success.
     /// </summary>
-    const std::map<std::string, Command> m_commands = {
-        { "place", cmdPLACE },
-        { "move", cmdMOVE },
-        { "left", cmdTURN_LEFT },
-        { "right", cmdTURN_RIGHT},
-        { "report", cmdREPORT},
-        { "exit", cmdEXIT }
-    };
+    void OnRobotResult(Command cmd, bool sucess);
 
     /// <summary>
-    /// Mapping of robot's facing directions and their internal representation.
+    /// Print the position of the robot on the user stream, or write it into the result sink.
     /// </summary>
-    const std::map<std::string, FacingDirection> m_facingDirections = {
-        { "north", fdNORTH },
-        { "south", fdSOUTH },
-        { "east", fdEAST },
-        { "west", fdWEST },
-        { "unknown", fdUNKNOWN }
-    };
+    void Report(uint64_t x, uint64_t y, FacingDirection facingDirection);
 
     /// <summary>
-    /// Inverse mapping of robot's facing direction
+    /// Print the command statistics of the thread, or an error when they are not compiled in.
     /// </summary>
-    std::map<FacingDirection, std::string> m_facingDirectionStrings;
+    void Stats();
 
-    ToyRobot& m_robot;
+    /// <summary>
+    /// Compile a line of a block statement, and run the statement once its outermost block is closed.
+    /// </summary>
+    void ExecuteBlockCommand(Command cmd, std::string_view args);
+
+    RobotRef m_robot;
     LoggerBase& m_logger;
+    ResultSink* m_resultSink = nullptr;
+    StatementRunnerBase* m_statementRunner = nullptr;
+
+    /// <summary>
+    /// Macros and blocks of the script so far, and the statement being compiled.
+    /// </summary>
+    CommandProgram m_statement;
 };
 
+template <typename TRobot>
+void RobotRef::ExecuteOn(CommanderBase& commander, void* robot, Command cmd, std::string_view args)
+{
+    commander.ExecuteRobotCommand(*static_cast<TRobot*>(robot), cmd, args);
+}
+
+template <typename TRobot>
+void CommanderBase::ExecuteRobotCommand(TRobot& robot, Command cmd, std::string_view args)
+{
+    switch (cmd)
+    {
+    case cmdPLACE:
+    {
+        PlaceArgs place;
+        if (TryGetPlace(args, place))
+            OnRobotResult(cmd, robot.TryPlace(place.x, place.y, place.facingDirection));
+        break;
+    }
+    case cmdMOVE:
+        OnRobotResult(cmd, robot.TryMove());
+        break;
+    case cmdTURN_LEFT:
+        OnRobotResult(cmd, robot.TryTurnLeft());
+        break;
+    case cmdTURN_RIGHT:
+        OnRobotResult(cmd, robot.TryTurnRight());
+        break;
+    case cmdREPORT:
+    {
+        uint64_t x;
+        uint64_t y;
+        FacingDirection facingDirection;
+        robot.ReportPosition(x, y, facingDirection);
+        Report(x, y, facingDirection);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
 /// <summary>
 /// Console commander which can get commands from console
 /// </summary>
 class ConsoleCommander : public CommanderBase
 {
 public:
-    ConsoleCommander(ToyRobot& robot, LoggerBase& logger)
+    ConsoleCommander(RobotRef robot, LoggerBase& logger)
         : CommanderBase(robot, logger)
     {}
 
@@ -143,19 +307,56 @@ public:
     ConsoleCommander(const ConsoleCommander&) = delete;
 
 protected:
-    bool TryReadLine(std::string& input) override;
+    bool TryReadLine(std::string_view& input) override;
+
+private:
+    std::string m_line;
 };
 
 /// <summary>
-/// File commander which can get commands from file
+/// Non-interactive commander reading commands piped into a stream, such as stdin.
+/// The stream buffer is read in large chunks which are split into lines in place. No prompt is logged,
+/// and the commander quits at the end of the stream.
+/// </summary>
+class PipeCommander : public CommanderBase
+{
+public:
+    static const size_t DefaultChunkSize = 64 * 1024;
+
+    PipeCommander(std::istream& input, RobotRef robot, LoggerBase& logger, size_t chunkSize = DefaultChunkSize);
+
+    /// <summary>
+    /// Copy constructor is not allowed
+    /// </summary>
+    PipeCommander(const PipeCommander&) = delete;
+
+protected:
+    bool TryReadLine(std::string_view& input) override;
+    bool ShowsPrompt() const override { return false; }
+
+private:
+    /// <summary>
+    /// Move the unread part of the buffer to its front and read the next chunk after it.
+    /// The buffer grows when a single line does not fit.
+    /// </summary>
+    void Fill();
+
+    std::streambuf* m_input;
+    std::vector<char> m_buffer;
+    size_t m_begin = 0;
+    size_t m_end = 0;
+    bool m_eof = false;
+};
+
+/// <summary>
+/// File commander which can get commands from file.
+/// Regular files are memory mapped and lines are handed out as views into the mapping.
+/// Pipes and special files fall back to a buffered stream.
 /// </summary>
 class FileCommander : public CommanderBase
 {
 public:
-    FileCommander(std::string path, ToyRobot& robot, LoggerBase& logger)
-        : CommanderBase(robot, logger),
-        m_filestream(path)
-    { }
+    FileCommander(std::string path, RobotRef robot, LoggerBase& logger);
 
     /// <summary>
     /// Copy constructor is not allowed
@@ -167,9 +368,44 @@ public:
         m_filestream.close();
     }
 
+    /// <summary>
+    /// Whether the input is read through the memory mapping.
+    /// </summary>
+    bool IsMapped() const { return m_mappedFile.IsOpen(); }
+
+    /// <summary>
+    /// Whether the input file could be opened.
+    /// </summary>
+    bool IsOpen() const { return m_mappedFile.IsOpen() || m_filestream.is_open(); }
+
+    /// <summary>
+    /// Number of input bytes consumed so far, line terminators included.
+    /// </summary>
+    uint64_t InputOffset() const;
+
+    /// <summary>
+    /// Continue reading the input at the given byte offset, e.g. when resuming from a journal.
+    /// </summary>
+    /// <returns>[true] Input is positioned. [false] Offset is past the end or the input can not seek.</returns>
+    bool TrySeek(uint64_t offset);
+
+    /// <summary>
+    /// Record every executed command to the given journal, which must outlive the commander.
+    /// </summary>
+    void SetJournal(JournalWriter* journal) { m_journal = journal; }
+
 protected:
-    bool TryReadLine(std::string& input) override;
+    bool TryReadLine(std::string_view& input) override;
+    void OnExecuted(Command cmd, std::string_view args) override;
+    void OnQuit() override;
 
 private:
+    MappedFile m_mappedFile;
+    LineScanner m_scanner;
+
     std::ifstream m_filestream;
+    std::string m_line;
+    uint64_t m_streamOffset = 0;
+
+    JournalWriter* m_journal = nullptr;
 };
\ No newline at end of file
@@ -28,5 +28,10 @@ enum Command
 	cmdTURN_LEFT = 3,
 	cmdTURN_RIGHT = 4,
 	cmdREPORT = 5,
-	cmdEXIT = 6
+	cmdEXIT = 6,
+	cmdSTATS = 7,
+	cmdDEFINE = 8,
+	cmdCALL = 9,
+	cmdREPEAT = 10,
+	cmdEND_BLOCK = 11
 };
\ No newline at end of file
@@ -0,0 +1,273 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <type_traits>
+#include "Board.h"
+#include "ToyRobot.h"
+
+/// <summary>
+/// Toy robot that several commanders can drive at the same time, e.g. a console operator and a file feed.
+/// The whole state is packed into one 64 bit word: x in bits 0-29, y in bits 30-59, the facing direction in
+/// bits 60-62 and the placed flag in bit 63. PLACE, MOVE, LEFT and RIGHT read the word, apply the same rules
+/// as BasicToyRobot and publish the new word with a compare and swap, retrying if another thread changed it
+/// in between. A rejected command changes nothing, so it takes effect at its read. REPORT is a single load.
+/// Coordinates are limited to CoordinateLimit, larger runtime boards are clamped to it.
+/// The robot is alone on the board, and the logger must accept calls from several threads.
+/// </summary>
+template <typename TBoard>
+class BasicConcurrentToyRobot final : public RobotBase, private TBoard
+{
+public:
+	using Board = TBoard;
+
+	/// <summary>
+	/// Largest coordinate that fits into the packed word.
+	/// </summary>
+	static constexpr uint64_t CoordinateLimit = (uint64_t(1) << 30) - 1;
+
+	explicit BasicConcurrentToyRobot(LoggerBase& logger, const TBoard& board = TBoard())
+		: TBoard(ClampBoard(board)),
+		m_logger(logger)
+	{}
+
+	/// <summary>
+	/// Copy constructor is not allowed
+	/// </summary>
+	BasicConcurrentToyRobot(const BasicConcurrentToyRobot&) = delete;
+
+	bool TryPlace(int64_t x, int64_t y, FacingDirection facingDirection) override;
+	bool TryMove() override;
+	bool TryTurnRight() override;
+	bool TryTurnLeft() override;
+	void ReportPosition(uint64_t& x, uint64_t& y, FacingDirection& facingDirection) const override;
+	RobotState SaveState() const override;
+	bool TryRestoreState(const RobotState& state) override;
+
+	uint64_t MaxX() const { return TBoard::MaxX(); }
+	uint64_t MaxY() const { return TBoard::MaxY(); }
+
+	/// <summary>
+	/// Place the robot without logging.
+	/// </summary>
+	RobotResult Place(int64_t x, int64_t y, FacingDirection facingDirection)
+	{
+		auto word = m_word.load(std::memory_order_acquire);
+		do
+		{
+			if (IsPlaced(word))
+				return rrALREADY_PLACED;
+
+			if (x < 0 || static_cast<uint64_t>(x) > TBoard::MaxX())
+				return rrINVALID_X;
+
+			if (y < 0 || static_cast<uint64_t>(y) > TBoard::MaxY())
+				return rrINVALID_Y;
+		} while (!m_word.compare_exchange_weak(word, Pack(static_cast<uint64_t>(x), static_cast<uint64_t>(y), facingDirection, true),
+			std::memory_order_acq_rel, std::memory_order_acquire));
+
+		return rrSUCCESS;
+	}
+
+	/// <summary>
+	/// Move the robot one unit forward without logging.
+	/// </summary>
+	RobotResult Move()
+	{
+		auto word = m_word.load(std::memory_order_acquire);
+		for (;;)
+		{
+			if (!IsPlaced(word))
+				return rrNOT_PLACED;
+
+			// Stepping below zero wraps to a value past the board limit, as in BasicToyRobot::Move.
+			const auto direction = DirectionOf(word) & 7;
+			const auto nextX = XOf(word) + static_cast<uint64_t>(static_cast<int8_t>(DeltaX[direction]));
+			const auto nextY = YOf(word) + static_cast<uint64_t>(static_cast<int8_t>(DeltaY[direction]));
+			if (nextX > TBoard::MaxX() || nextY > TBoard::MaxY() || !IsKnownDirection[direction])
+				return static_cast<RobotResult>(BlockedResult[direction]);
+
+			if (m_word.compare_exchange_weak(word, Pack(nextX, nextY, DirectionOf(word), true),
+				std::memory_order_acq_rel, std::memory_order_acquire))
+				return rrSUCCESS;
+		}
+	}
+
+	/// <summary>
+	/// Turn the robot 90 degrees to the left without logging.
+	/// </summary>
+	/// <param name="facingDirection">Facing direction after the turn, as seen by this command</param>
+	RobotResult TurnLeft(FacingDirection& facingDirection)
+	{
+		return Turn(LeftOf, facingDirection);
+	}
+
+	/// <summary>
+	/// Turn the robot 90 degrees to the right without logging.
+	/// </summary>
+	/// <param name="facingDirection">Facing direction after the turn, as seen by this command</param>
+	RobotResult TurnRight(FacingDirection& facingDirection)
+	{
+		return Turn(RightOf, facingDirection);
+	}
+
+private:
+	static constexpr unsigned YShift = 30;
+	static constexpr unsigned DirectionShift = 60;
+	static constexpr uint64_t CoordinateMask = CoordinateLimit;
+	static constexpr uint64_t PlacedBit = uint64_t(1) << 63;
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "The packed robot state needs lock-free 64 bit atomics");
+	static_assert(fdWEST < 8, "Facing directions must fit into 3 bits");
+
+	static uint64_t Pack(uint64_t x, uint64_t y, FacingDirection facingDirection, bool placed)
+	{
+		return x | (y << YShift) | (static_cast<uint64_t>(facingDirection & 7) << DirectionShift) | (placed ? PlacedBit : 0);
+	}
+
+	static uint64_t XOf(uint64_t word) { return word & CoordinateMask; }
+	static uint64_t YOf(uint64_t word) { return (word >> YShift) & CoordinateMask; }
+	static FacingDirection DirectionOf(uint64_t word) { return static_cast<FacingDirection>((word >> DirectionShift) & 7); }
+	static bool IsPlaced(uint64_t word) { return (word & PlacedBit) != 0; }
+
+	static TBoard ClampBoard(const TBoard& board)
+	{
+		if constexpr (std::is_empty_v<TBoard>)
+		{
+			static_assert(TBoard::MaxX() <= CoordinateLimit && TBoard::MaxY() <= CoordinateLimit,
+				"The board does not fit into the packed robot state");
+			return board;
+		}
+		else
+		{
+			return TBoard(board.MaxX() < CoordinateLimit ? board.MaxX() : CoordinateLimit,
+				board.MaxY() < CoordinateLimit ? board.MaxY() : CoordinateLimit);
+		}
+	}
+
+	RobotResult Turn(const DirectionTable& successor, FacingDirection& facingDirection)
+	{
+		auto word = m_word.load(std::memory_order_acquire);
+		for (;;)
+		{
+			if (!IsPlaced(word))
+				return rrNOT_PLACED;
+
+			const auto direction = DirectionOf(word);
+			facingDirection = static_cast<FacingDirection>(successor[direction]);
+			if (!IsKnownDirection[direction])
+				return rrUNKNOWN_DIRECTION;
+
+			if (m_word.compare_exchange_weak(word, Pack(XOf(word), YOf(word), facingDirection, true),
+				std::memory_order_acq_rel, std::memory_order_acquire))
+				return rrSUCCESS;
+		}
+	}
+
+	/// <summary>
+	/// Packed state, alone on its cache line so that the threads contend on the word only.
+	/// </summary>
+	alignas(64) std::atomic<uint64_t> m_word{ Pack(0, 0, fdUNKNOWN, false) };
+
+	LoggerBase& m_logger;
+};
+
+template <typename TBoard>
+bool BasicConcurrentToyRobot<TBoard>::TryPlace(int64_t x, int64_t y, FacingDirection facingDirection)
+{
+	const auto result = Place(x, y, facingDirection);
+	if (result != rrSUCCESS)
+		LogRobotResult(m_logger, cmdPLACE, result, facingDirection, TBoard::MaxX(), TBoard::MaxY());
+
+	return result == rrSUCCESS;
+}
+
+template <typename TBoard>
+bool BasicConcurrentToyRobot<TBoard>::TryMove()
+{
+	const auto result = Move();
+	if (result != rrSUCCESS)
+		LogRobotResult(m_logger, cmdMOVE, result, fdUNKNOWN, TBoard::MaxX(), TBoard::MaxY());
+
+	return result == rrSUCCESS;
+}
+
+template <typename TBoard>
+bool BasicConcurrentToyRobot<TBoard>::TryTurnLeft()
+{
+	FacingDirection facingDirection = fdUNKNOWN;
+	const auto result = TurnLeft(facingDirection);
+	LogRobotResult(m_logger, cmdTURN_LEFT, result, facingDirection, TBoard::MaxX(), TBoard::MaxY());
+
+	return result == rrSUCCESS;
+}
+
+template <typename TBoard>
+bool BasicConcurrentToyRobot<TBoard>::TryTurnRight()
+{
+	FacingDirection facingDirection = fdUNKNOWN;
+	const auto result = TurnRight(facingDirection);
+	LogRobotResult(m_logger, cmdTURN_RIGHT, result, facingDirection, TBoard::MaxX(), TBoard::MaxY());
+
+	return result == rrSUCCESS;
+}
+
+template <typename TBoard>
+void BasicConcurrentToyRobot<TBoard>::ReportPosition(uint64_t& x, uint64_t& y, FacingDirection& facingDirection) const
+{
+	const auto word = m_word.load(std::memory_order_acquire);
+	x = XOf(word);
+	y = YOf(word);
+	facingDirection = DirectionOf(word);
+}
+
+template <typename TBoard>
+RobotState BasicConcurrentToyRobot<TBoard>::SaveState() const
+{
+	const auto word = m_word.load(std::memory_order_acquire);
+	return { XOf(word), YOf(word), DirectionOf(word), IsPlaced(word) };
+}
+
+template <typename TBoard>
+bool BasicConcurrentToyRobot<TBoard>::TryRestoreState(const RobotState& state)
+{
+	if (state.x > TBoard::MaxX() || state.y > TBoard::MaxY())
+		return false;
+
+	m_word.store(Pack(state.x, state.y, state.facingDirection, state.placed), std::memory_order_release);
+	return true;
+}
+
+/// <summary>
+/// Concurrent robot on the classic 5x5 board.
+/// </summary>
+using ConcurrentToyRobot = BasicConcurrentToyRobot<DefaultBoard>;
+
+/// <summary>
+/// Concurrent robot on a board sized at runtime, up to CoordinateLimit.
+/// </summary>
+using RuntimeConcurrentToyRobot = BasicConcurrentToyRobot<RuntimeBoard>;
+
+// Compiled once in ConcurrentToyRobot.cpp.
+extern template class BasicConcurrentToyRobot<DefaultBoard>;
+extern template class BasicConcurrentToyRobot<RuntimeBoard>;
@@ -0,0 +1,333 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Journal.h"
+#include "CommandProgram.h"
+#include "Commander.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include "ResultSink.h"
+#include <cstring>
+#include <filesystem>
+
+namespace
+{
+    const char JournalMagic[4] = { 'T', 'R', 'J', '2' };
+    const size_t HeaderSize = sizeof(JournalMagic) + 2 * sizeof(uint64_t);
+
+    /// <summary>
+    /// Checkpoint payload: input offset, command count, log and result file sizes, x and y as 64 bit integers,
+    /// the facing direction and the flags as one byte each. Followed by a 32 bit checksum of the payload.
+    /// </summary>
+    const size_t CheckpointPayloadSize = 6 * sizeof(uint64_t) + 2;
+    const size_t CheckpointSize = 1 + CheckpointPayloadSize + sizeof(uint32_t);
+
+    const uint8_t CheckpointPlaced = 1;
+    const uint8_t CheckpointFinished = 2;
+
+    /// <summary>
+    /// FNV-1a hash, enough to tell a torn or damaged checkpoint from a complete one.
+    /// </summary>
+    uint32_t Checksum(const uint8_t* data, size_t size)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t idx = 0; idx < size; idx++)
+            hash = (hash ^ data[idx]) * 16777619u;
+
+        return hash;
+    }
+
+    void EncodeCheckpoint(const JournalCheckpoint& checkpoint, uint8_t* payload)
+    {
+        std::memcpy(payload, &checkpoint.inputOffset, sizeof(uint64_t));
+        std::memcpy(payload + 8, &checkpoint.commandCount, sizeof(uint64_t));
+        std::memcpy(payload + 16, &checkpoint.outputOffset, sizeof(uint64_t));
+        std::memcpy(payload + 24, &checkpoint.resultOffset, sizeof(uint64_t));
+        std::memcpy(payload + 32, &checkpoint.state.x, sizeof(uint64_t));
+        std::memcpy(payload + 40, &checkpoint.state.y, sizeof(uint64_t));
+        payload[48] = static_cast<uint8_t>(checkpoint.state.facingDirection);
+        payload[49] = (checkpoint.state.placed ? CheckpointPlaced : 0) | (checkpoint.finished ? CheckpointFinished : 0);
+    }
+
+    void DecodeCheckpoint(const uint8_t* payload, JournalCheckpoint& checkpoint)
+    {
+        std::memcpy(&checkpoint.inputOffset, payload, sizeof(uint64_t));
+        std::memcpy(&checkpoint.commandCount, payload + 8, sizeof(uint64_t));
+        std::memcpy(&checkpoint.outputOffset, payload + 16, sizeof(uint64_t));
+        std::memcpy(&checkpoint.resultOffset, payload + 24, sizeof(uint64_t));
+        std::memcpy(&checkpoint.state.x, payload + 32, sizeof(uint64_t));
+        std::memcpy(&checkpoint.state.y, payload + 40, sizeof(uint64_t));
+        checkpoint.state.facingDirection = static_cast<FacingDirection>(payload[48]);
+        checkpoint.state.placed = (payload[49] & CheckpointPlaced) != 0;
+        checkpoint.finished = (payload[49] & CheckpointFinished) != 0;
+    }
+
+    /// <summary>
+    /// Cut an output file back to the given size. A missing file is fine while nothing was written to it.
+    /// </summary>
+    bool TryCutFile(const std::string& path, uint64_t size, std::string& error)
+    {
+        std::error_code ec;
+        const auto current = std::filesystem::file_size(path, ec);
+        if (ec && size == 0)
+            return true;
+
+        if (ec || current < size)
+        {
+            error = "The output file is shorter than the journal expects: " + path;
+            return false;
+        }
+
+        std::filesystem::resize_file(path, size, ec);
+        if (ec)
+        {
+            error = "Unable to cut the output file back to the checkpoint: " + path;
+            return false;
+        }
+
+        return true;
+    }
+}
+
+bool JournalWriter::TryOpen(FileCommander& commander, const std::string& inputPath, bool resume, bool& finished, std::string& error)
+{
+    finished = false;
+
+    std::error_code ec;
+    const uint64_t inputSize = std::filesystem::file_size(inputPath, ec);
+    if (ec)
+    {
+        error = "Unable to read the size of the input file: " + inputPath;
+        return false;
+    }
+
+    if (!resume)
+    {
+        m_file.open(m_path, std::ios::binary | std::ios::trunc);
+        if (!m_file.is_open())
+        {
+            error = "Unable to create the journal: " + m_path;
+            return false;
+        }
+
+        // Nothing is logged yet, the flush only tells where this run starts in the log.
+        const uint64_t outputSize = m_logger != nullptr ? m_logger->Flush() : 0;
+        m_file.write(JournalMagic, sizeof(JournalMagic));
+        m_file.write(reinterpret_cast<const char*>(&inputSize), sizeof(inputSize));
+        m_file.write(reinterpret_cast<const char*>(&outputSize), sizeof(outputSize));
+        m_file.flush();
+        return true;
+    }
+
+    JournalScan scan;
+    if (!TryScan(m_path, scan, error))
+        return false;
+
+    if (scan.inputSize != inputSize)
+    {
+        error = "The input file changed since the journal was written: " + inputPath;
+        return false;
+    }
+
+    if (scan.hasCheckpoint)
+    {
+        const auto& checkpoint = scan.checkpoint;
+        if (checkpoint.finished)
+        {
+            finished = true;
+            return true;
+        }
+
+        if (!m_robot.TryRestoreState(checkpoint.state))
+        {
+            error = "The robot state of the journal does not fit the board: " + m_path;
+            return false;
+        }
+
+        if (!commander.TrySeek(checkpoint.inputOffset))
+        {
+            error = "Unable to seek the input file to the checkpoint: " + inputPath;
+            return false;
+        }
+
+        m_commandCount = checkpoint.commandCount;
+        m_lastCheckpointCommand = checkpoint.commandCount;
+        m_lastCheckpointOffset = checkpoint.inputOffset;
+    }
+
+    // Commands after the checkpoint are executed again, so their records are dropped along with any torn record.
+    std::filesystem::resize_file(m_path, scan.checkpointEnd, ec);
+    if (!ec)
+        m_file.open(m_path, std::ios::binary | std::ios::app);
+
+    if (!m_file.is_open())
+    {
+        error = "Unable to open the journal: " + m_path;
+        return false;
+    }
+
+    return true;
+}
+
+void JournalWriter::Record(Command cmd, std::string_view args, uint64_t inputOffset)
+{
+    if (!m_file.is_open())
+        return;
+
+    m_file.put(static_cast<char>(jrCOMMAND));
+    m_file.put(static_cast<char>(cmd));
+    if (cmd == cmdPLACE)
+    {
+        const auto length = static_cast<uint16_t>(args.size() < UINT16_MAX ? args.size() : UINT16_MAX);
+        m_file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        m_file.write(args.data(), length);
+    }
+
+    m_commandCount++;
+
+    // The macros of a script live in the commander, and a checkpoint does not hold them. Once a block command
+    // is seen no more checkpoints are taken, so a resumed run starts before the first one and compiles it again.
+    m_blockCommands |= CommandProgram::IsBlockCommand(cmd);
+    if (m_blockCommands)
+        return;
+
+    const auto commandsDue = m_options.checkpointCommands != 0 && m_commandCount - m_lastCheckpointCommand >= m_options.checkpointCommands;
+    const auto bytesDue = m_options.checkpointBytes != 0 && inputOffset - m_lastCheckpointOffset >= m_options.checkpointBytes;
+    if (commandsDue || bytesDue)
+        Checkpoint(inputOffset, false);
+}
+
+void JournalWriter::Finish(uint64_t inputOffset)
+{
+    if (m_file.is_open())
+        Checkpoint(inputOffset, true);
+}
+
+void JournalWriter::Checkpoint(uint64_t inputOffset, bool finished)
+{
+    // The output of every command before the checkpoint has to be on the disk before the checkpoint is.
+    JournalCheckpoint checkpoint;
+    if (m_logger != nullptr)
+        checkpoint.outputOffset = m_logger->Flush();
+
+    if (m_results != nullptr)
+    {
+        m_results->Flush();
+        checkpoint.resultOffset = m_results->FlushedSize();
+    }
+
+    checkpoint.inputOffset = inputOffset;
+    checkpoint.commandCount = m_commandCount;
+    checkpoint.state = m_robot.SaveState();
+    checkpoint.finished = finished;
+
+    uint8_t record[CheckpointSize];
+    record[0] = jrCHECKPOINT;
+    EncodeCheckpoint(checkpoint, record + 1);
+    const auto checksum = Checksum(record + 1, CheckpointPayloadSize);
+    std::memcpy(record + 1 + CheckpointPayloadSize, &checksum, sizeof(checksum));
+
+    m_file.write(reinterpret_cast<const char*>(record), sizeof(record));
+    m_file.flush();
+
+    m_lastCheckpointCommand = m_commandCount;
+    m_lastCheckpointOffset = inputOffset;
+    m_checkpointCount++;
+}
+
+bool JournalWriter::TryScan(const std::string& path, JournalScan& scan, std::string& error)
+{
+    MappedFile mappedFile;
+    if (!mappedFile.TryOpen(path) || mappedFile.Size() < HeaderSize
+        || std::memcmp(mappedFile.Data(), JournalMagic, sizeof(JournalMagic)) != 0)
+    {
+        error = "Unable to read the journal: " + path;
+        return false;
+    }
+
+    const auto* const begin = reinterpret_cast<const uint8_t*>(mappedFile.Data());
+    const auto* const end = begin + mappedFile.Size();
+    std::memcpy(&scan.inputSize, begin + sizeof(JournalMagic), sizeof(uint64_t));
+    std::memcpy(&scan.outputSize, begin + sizeof(JournalMagic) + sizeof(uint64_t), sizeof(uint64_t));
+    scan.hasCheckpoint = false;
+    scan.checkpointEnd = HeaderSize;
+
+    // Walk the records up to the first incomplete or damaged one, which is where a crashed run stopped writing.
+    const uint8_t* pos = begin + HeaderSize;
+    while (pos < end)
+    {
+        if (*pos == jrCOMMAND)
+        {
+            if (end - pos < 2)
+                break;
+
+            auto length = 2;
+            if (pos[1] == cmdPLACE)
+            {
+                uint16_t argsLength;
+                if (end - pos < 4)
+                    break;
+
+                std::memcpy(&argsLength, pos + 2, sizeof(argsLength));
+                length += static_cast<int>(sizeof(argsLength)) + argsLength;
+                if (end - pos < length)
+                    break;
+            }
+
+            pos += length;
+        }
+        else if (*pos == jrCHECKPOINT)
+        {
+            if (static_cast<size_t>(end - pos) < CheckpointSize)
+                break;
+
+            uint32_t checksum;
+            std::memcpy(&checksum, pos + 1 + CheckpointPayloadSize, sizeof(checksum));
+            if (checksum != Checksum(pos + 1, CheckpointPayloadSize))
+                break;
+
+            DecodeCheckpoint(pos + 1, scan.checkpoint);
+            scan.hasCheckpoint = true;
+            pos += CheckpointSize;
+            scan.checkpointEnd = static_cast<uint64_t>(pos - begin);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool JournalWriter::TryRewindOutputs(const std::string& path, const std::string& outputPath, const std::string& resultsPath, std::string& error)
+{
+    JournalScan scan;
+    if (!TryScan(path, scan, error))
+        return false;
+
+    if (scan.hasCheckpoint && scan.checkpoint.finished)
+        return true;
+
+    // Without a checkpoint the run starts over, from where the log stood when the journal was created.
+    const auto outputSize = scan.hasCheckpoint ? scan.checkpoint.outputOffset : scan.outputSize;
+    const auto resultSize = scan.hasCheckpoint ? scan.checkpoint.resultOffset : 0;
+    return TryCutFile(outputPath, outputSize, error) && (resultsPath.empty() || TryCutFile(resultsPath, resultSize, error));
+}
\ No newline at end of file
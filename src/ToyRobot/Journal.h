@@ -0,0 +1,202 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "Commands.h"
+#include "JournalRecord.h"
+#include "RobotBase.h"
+
+class FileCommander;
+class FileLogger;
+class ResultSink;
+
+/// <summary>
+/// When the journal writes a checkpoint. A zero interval is disabled.
+/// </summary>
+struct JournalOptions
+{
+    /// <summary>
+    /// Checkpoint after this many commands (--checkpoint-commands=N).
+    /// </summary>
+    uint64_t checkpointCommands = 100000;
+
+    /// <summary>
+    /// Checkpoint after this many input bytes (--checkpoint-bytes=N).
+    /// </summary>
+    uint64_t checkpointBytes = 0;
+};
+
+/// <summary>
+/// Robot state at a point of the input.
+/// </summary>
+struct JournalCheckpoint
+{
+    /// <summary>
+    /// Input byte offset of the first line not executed yet.
+    /// </summary>
+    uint64_t inputOffset = 0;
+
+    /// <summary>
+    /// Number of commands executed up to the checkpoint.
+    /// </summary>
+    uint64_t commandCount = 0;
+
+    /// <summary>
+    /// Size of the log and of the result file, flushed before the checkpoint was written.
+    /// </summary>
+    uint64_t outputOffset = 0;
+    uint64_t resultOffset = 0;
+
+    RobotState state;
+
+    /// <summary>
+    /// Whether the commander quit at this checkpoint, so there is nothing left to resume.
+    /// </summary>
+    bool finished = false;
+};
+
+/// <summary>
+/// Result of reading a journal back.
+/// </summary>
+struct JournalScan
+{
+    /// <summary>
+    /// Size of the input file the journal was written for.
+    /// </summary>
+    uint64_t inputSize = 0;
+
+    /// <summary>
+    /// Size of the log when the journal was created, where a run without a checkpoint starts over.
+    /// </summary>
+    uint64_t outputSize = 0;
+
+    /// <summary>
+    /// Whether the journal holds at least one checkpoint.
+    /// </summary>
+    bool hasCheckpoint = false;
+    JournalCheckpoint checkpoint;
+
+    /// <summary>
+    /// Length of the journal up to the end of the latest checkpoint. Records after it are dropped on resume,
+    /// as their commands are executed again.
+    /// </summary>
+    uint64_t checkpointEnd = 0;
+};
+
+/// <summary>
+/// Append-only binary journal of a file commander run.
+/// The journal starts with a header holding the input size and the log size, followed by records. Every executed
+/// command is a record holding the command byte, and for PLACE its arguments. Checkpoints hold the robot state,
+/// the input offset and the sizes of the outputs, protected by a checksum, and are flushed to the file so that a
+/// crashed run can resume from the last one. The outputs are flushed before every checkpoint, and cut back to it
+/// on resume, so the commands executed again do not repeat their output.
+/// </summary>
+class JournalWriter
+{
+public:
+    JournalWriter(std::string path, RobotBase& robot, const JournalOptions& options)
+        : m_path(std::move(path)),
+        m_robot(robot),
+        m_options(options)
+    {}
+
+    /// <summary>
+    /// Copy constructor is not allowed
+    /// </summary>
+    JournalWriter(const JournalWriter&) = delete;
+
+    /// <summary>
+    /// Flush the log and the result sink before every checkpoint, and keep their sizes in it. Either may be null.
+    /// Both must outlive the journal, and must be set before it is opened.
+    /// </summary>
+    void SetOutputs(FileLogger* logger, ResultSink* results)
+    {
+        m_logger = logger;
+        m_results = results;
+    }
+
+    /// <summary>
+    /// Open the journal for the commander's input. A new journal replaces any existing one. When resuming,
+    /// the robot and the input are put back to the latest checkpoint and the journal is continued from there.
+    /// </summary>
+    /// <param name="commander">Commander reading the input</param>
+    /// <param name="inputPath">Path of the input file</param>
+    /// <param name="resume">Resume from the existing journal instead of starting a new one</param>
+    /// <param name="finished">Set if the journaled run already quit, so there is nothing to execute</param>
+    /// <param name="error">Error message if the journal could not be opened</param>
+    /// <returns>[true] Journal is open. [false] Journal could not be opened or does not match the input.</returns>
+    bool TryOpen(FileCommander& commander, const std::string& inputPath, bool resume, bool& finished, std::string& error);
+
+    /// <summary>
+    /// Record an executed command, and write a checkpoint when one is due. Checkpoints stop at the first
+    /// block command, only the final one is written after it.
+    /// </summary>
+    /// <param name="cmd">The command</param>
+    /// <param name="args">Arguments of the command</param>
+    /// <param name="inputOffset">Input byte offset after the command's line</param>
+    void Record(Command cmd, std::string_view args, uint64_t inputOffset);
+
+    /// <summary>
+    /// Write the final checkpoint when the commander quits.
+    /// </summary>
+    void Finish(uint64_t inputOffset);
+
+    uint64_t CommandCount() const { return m_commandCount; }
+    uint64_t CheckpointCount() const { return m_checkpointCount; }
+
+    /// <summary>
+    /// Read a journal back and find its latest valid checkpoint.
+    /// </summary>
+    /// <returns>[true] Journal is read. [false] File could not be read or is not a journal.</returns>
+    static bool TryScan(const std::string& path, JournalScan& scan, std::string& error);
+
+    /// <summary>
+    /// Cut the log and the result file of a crashed run back to the latest checkpoint of its journal, before they
+    /// are opened again to resume it. Outputs of a finished run are left alone.
+    /// </summary>
+    /// <param name="path">Path of the journal</param>
+    /// <param name="outputPath">Path of the log</param>
+    /// <param name="resultsPath">Path of the result file. Empty when there is none.</param>
+    /// <param name="error">Error message if an output could not be cut</param>
+    /// <returns>[true] Outputs are ready to be continued. [false] Journal could not be read or does not match the outputs.</returns>
+    static bool TryRewindOutputs(const std::string& path, const std::string& outputPath, const std::string& resultsPath, std::string& error);
+
+private:
+    void Checkpoint(uint64_t inputOffset, bool finished);
+
+    std::string m_path;
+    RobotBase& m_robot;
+    JournalOptions m_options;
+    FileLogger* m_logger = nullptr;
+    ResultSink* m_results = nullptr;
+
+    std::ofstream m_file;
+    uint64_t m_commandCount = 0;
+    uint64_t m_checkpointCount = 0;
+    uint64_t m_lastCheckpointCommand = 0;
+    uint64_t m_lastCheckpointOffset = 0;
+    bool m_blockCommands = false;
+};
\ No newline at end of file
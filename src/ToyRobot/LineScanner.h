@@ -0,0 +1,111 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <string_view>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TOYROBOT_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/// <summary>
+/// Find the first new line character in the given range.
+/// Scans 16 bytes per step with SSE2 when available and falls back to memchr for the tail.
+/// </summary>
+/// <param name="begin">Start of the range</param>
+/// <param name="end">One past the end of the range</param>
+/// <returns>Pointer to the new line character, or end if there is none.</returns>
+inline const char* FindNewline(const char* begin, const char* end)
+{
+#if defined(TOYROBOT_HAS_SSE2)
+    const auto newline = _mm_set1_epi8('\n');
+    while (end - begin >= 16)
+    {
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        const auto mask = static_cast<unsigned long>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+        if (mask != 0)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return begin + index;
+#else
+            return begin + __builtin_ctzl(mask);
+#endif
+        }
+        begin += 16;
+    }
+#endif
+
+    const auto found = std::memchr(begin, '\n', end - begin);
+    return found != nullptr ? static_cast<const char*>(found) : end;
+}
+
+/// <summary>
+/// Splits an in-memory buffer into lines without copying.
+/// Returned views point straight into the buffer, so the buffer must outlive them.
+/// </summary>
+class LineScanner
+{
+public:
+    LineScanner() = default;
+
+    LineScanner(const char* begin, const char* end)
+        : m_position(begin),
+        m_end(end)
+    {}
+
+    /// <summary>
+    /// Try to get the next line from the buffer. Trailing carriage return is removed.
+    /// </summary>
+    /// <param name="line">View of the line, excluding the line terminator</param>
+    /// <returns>[true] Line is available. [false] End of the buffer is reached</returns>
+    bool TryNextLine(std::string_view& line)
+    {
+        if (m_position == m_end)
+            return false;
+
+        const auto newline = FindNewline(m_position, m_end);
+        auto lineEnd = newline;
+        if (lineEnd != m_position && *(lineEnd - 1) == '\r')
+            lineEnd--;
+
+        line = std::string_view(m_position, lineEnd - m_position);
+        m_position = newline == m_end ? m_end : newline + 1;
+
+        return true;
+    }
+
+    /// <summary>
+    /// Current read position within the buffer.
+    /// </summary>
+    const char* Position() const { return m_position; }
+
+private:
+    const char* m_position = nullptr;
+    const char* m_end = nullptr;
+};
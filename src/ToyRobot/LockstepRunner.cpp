@@ -0,0 +1,434 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LockstepRunner.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include "Board.h"
+#include "RobotTables.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TOYROBOT_HAS_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC accepts any intrinsic in any function, GCC and Clang need the instruction set enabled per function.
+#if defined(__GNUC__) || defined(__clang__)
+#define TOYROBOT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define TOYROBOT_TARGET(isa)
+#endif
+
+namespace
+{
+    const uint8_t MaxCoordinate = DefaultBoard::MaxX();
+
+    /// <summary>
+    /// Narrow a PLACE coordinate to a lane byte. Values outside 0-254 become 255, which is off the board,
+    /// so the lane rejects them like ToyRobot::Place does instead of wrapping them onto the board.
+    /// </summary>
+    uint8_t ToLaneCoordinate(int64_t value)
+    {
+        return value >= 0 && value < 255 ? static_cast<uint8_t>(value) : 255;
+    }
+
+    /// <summary>
+    /// Collects the REPORT output of a program run by the program runner. Nothing else is logged.
+    /// </summary>
+    class ReportLogger : public LoggerBase
+    {
+    public:
+        explicit ReportLogger(std::vector<std::string>& reports)
+            : m_reports(reports)
+        {
+            SetLevel(llNONE);
+        }
+
+    protected:
+        void Print(std::string_view /*msgType*/, std::string_view msg, std::string_view /*end*/) override
+        {
+            m_reports.emplace_back(msg);
+        }
+
+    private:
+        std::vector<std::string>& m_reports;
+    };
+
+    void StepScalar(const LockstepRunner::Lanes& lanes)
+    {
+        for (size_t idx = 0; idx < lanes.count; idx++)
+        {
+            const auto cmd = lanes.commands[idx];
+            const auto x = lanes.x[idx];
+            const auto y = lanes.y[idx];
+            const auto direction = lanes.facingDirection[idx];
+            const auto placed = lanes.placed[idx];
+
+            const uint8_t nextX = x + LaneDeltaX(direction);
+            const uint8_t nextY = y + LaneDeltaY(direction);
+            const uint8_t moved = (cmd == cmdMOVE) & placed & (nextX <= MaxCoordinate) & (nextY <= MaxCoordinate);
+            const uint8_t turnedLeft = (cmd == cmdTURN_LEFT) & placed;
+            const uint8_t turnedRight = (cmd == cmdTURN_RIGHT) & placed;
+            const uint8_t isPlaced = (cmd == cmdPLACE) & (placed ^ 1)
+                & (lanes.placeX[idx] <= MaxCoordinate) & (lanes.placeY[idx] <= MaxCoordinate);
+
+            lanes.x[idx] = LaneSelect(isPlaced, lanes.placeX[idx], LaneSelect(moved, nextX, x));
+            lanes.y[idx] = LaneSelect(isPlaced, lanes.placeY[idx], LaneSelect(moved, nextY, y));
+            lanes.facingDirection[idx] = LaneSelect(isPlaced, lanes.placeDirection[idx],
+                LaneSelect(turnedLeft, LaneLeftOf(direction), LaneSelect(turnedRight, LaneRightOf(direction), direction)));
+            lanes.placed[idx] = placed | isPlaced;
+        }
+    }
+
+#if defined(TOYROBOT_HAS_X86_SIMD)
+    // The vector kernels are the scalar kernel written with byte compares and blends.
+    // Unknown directions need no mask: their step is zero and they match no turning rule.
+
+    TOYROBOT_TARGET("sse4.1")
+    inline __m128i LessOrEqual(__m128i value, __m128i limit)
+    {
+        return _mm_cmpeq_epi8(_mm_min_epu8(value, limit), value);
+    }
+
+    TOYROBOT_TARGET("sse4.1")
+    void StepSse41(const LockstepRunner::Lanes& lanes)
+    {
+        const auto one = _mm_set1_epi8(1);
+        const auto limit = _mm_set1_epi8(MaxCoordinate);
+        const auto north = _mm_set1_epi8(fdNORTH);
+        const auto south = _mm_set1_epi8(fdSOUTH);
+        const auto east = _mm_set1_epi8(fdEAST);
+        const auto west = _mm_set1_epi8(fdWEST);
+
+        for (size_t idx = 0; idx < lanes.count; idx += 16)
+        {
+            const auto cmd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes.commands + idx));
+            const auto placeX = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes.placeX + idx));
+            const auto placeY = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes.placeY + idx));
+            const auto placeDirection = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes.placeDirection + idx));
+            auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes.x + idx));
+            auto y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes.y + idx));
+            auto direction = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes.facingDirection + idx));
+            auto placed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes.placed + idx));
+
+            const auto isPlaced = _mm_cmpeq_epi8(placed, one);
+            const auto isNorth = _mm_cmpeq_epi8(direction, north);
+            const auto isSouth = _mm_cmpeq_epi8(direction, south);
+            const auto isEast = _mm_cmpeq_epi8(direction, east);
+            const auto isWest = _mm_cmpeq_epi8(direction, west);
+
+            // Masks are all ones (-1) where set, so subtracting them adds one.
+            const auto nextX = _mm_add_epi8(_mm_sub_epi8(x, isEast), isWest);
+            const auto nextY = _mm_add_epi8(_mm_sub_epi8(y, isNorth), isSouth);
+            const auto moved = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(cmd, _mm_set1_epi8(cmdMOVE)), isPlaced),
+                _mm_and_si128(LessOrEqual(nextX, limit), LessOrEqual(nextY, limit)));
+
+            auto left = _mm_blendv_epi8(direction, west, isNorth);
+            left = _mm_blendv_epi8(left, east, isSouth);
+            left = _mm_blendv_epi8(left, north, isEast);
+            left = _mm_blendv_epi8(left, south, isWest);
+
+            auto right = _mm_blendv_epi8(direction, east, isNorth);
+            right = _mm_blendv_epi8(right, west, isSouth);
+            right = _mm_blendv_epi8(right, south, isEast);
+            right = _mm_blendv_epi8(right, north, isWest);
+
+            const auto turnedLeft = _mm_and_si128(_mm_cmpeq_epi8(cmd, _mm_set1_epi8(cmdTURN_LEFT)), isPlaced);
+            const auto turnedRight = _mm_and_si128(_mm_cmpeq_epi8(cmd, _mm_set1_epi8(cmdTURN_RIGHT)), isPlaced);
+            const auto placedNow = _mm_andnot_si128(isPlaced, _mm_and_si128(_mm_cmpeq_epi8(cmd, _mm_set1_epi8(cmdPLACE)),
+                _mm_and_si128(LessOrEqual(placeX, limit), LessOrEqual(placeY, limit))));
+
+            x = _mm_blendv_epi8(_mm_blendv_epi8(x, nextX, moved), placeX, placedNow);
+            y = _mm_blendv_epi8(_mm_blendv_epi8(y, nextY, moved), placeY, placedNow);
+            direction = _mm_blendv_epi8(direction, left, turnedLeft);
+            direction = _mm_blendv_epi8(direction, right, turnedRight);
+            direction = _mm_blendv_epi8(direction, placeDirection, placedNow);
+            placed = _mm_or_si128(placed, _mm_and_si128(placedNow, one));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.x + idx), x);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.y + idx), y);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.facingDirection + idx), direction);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.placed + idx), placed);
+        }
+    }
+
+    TOYROBOT_TARGET("avx2")
+    inline __m256i LessOrEqual(__m256i value, __m256i limit)
+    {
+        return _mm256_cmpeq_epi8(_mm256_min_epu8(value, limit), value);
+    }
+
+    TOYROBOT_TARGET("avx2")
+    void StepAvx2(const LockstepRunner::Lanes& lanes)
+    {
+        const auto one = _mm256_set1_epi8(1);
+        const auto limit = _mm256_set1_epi8(MaxCoordinate);
+        const auto north = _mm256_set1_epi8(fdNORTH);
+        const auto south = _mm256_set1_epi8(fdSOUTH);
+        const auto east = _mm256_set1_epi8(fdEAST);
+        const auto west = _mm256_set1_epi8(fdWEST);
+
+        for (size_t idx = 0; idx < lanes.count; idx += 32)
+        {
+            const auto cmd = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.commands + idx));
+            const auto placeX = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.placeX + idx));
+            const auto placeY = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.placeY + idx));
+            const auto placeDirection = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.placeDirection + idx));
+            auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.x + idx));
+            auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.y + idx));
+            auto direction = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.facingDirection + idx));
+            auto placed = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.placed + idx));
+
+            const auto isPlaced = _mm256_cmpeq_epi8(placed, one);
+            const auto isNorth = _mm256_cmpeq_epi8(direction, north);
+            const auto isSouth = _mm256_cmpeq_epi8(direction, south);
+            const auto isEast = _mm256_cmpeq_epi8(direction, east);
+            const auto isWest = _mm256_cmpeq_epi8(direction, west);
+
+            const auto nextX = _mm256_add_epi8(_mm256_sub_epi8(x, isEast), isWest);
+            const auto nextY = _mm256_add_epi8(_mm256_sub_epi8(y, isNorth), isSouth);
+            const auto moved = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(cmd, _mm256_set1_epi8(cmdMOVE)), isPlaced),
+                _mm256_and_si256(LessOrEqual(nextX, limit), LessOrEqual(nextY, limit)));
+
+            auto left = _mm256_blendv_epi8(direction, west, isNorth);
+            left = _mm256_blendv_epi8(left, east, isSouth);
+            left = _mm256_blendv_epi8(left, north, isEast);
+            left = _mm256_blendv_epi8(left, south, isWest);
+
+            auto right = _mm256_blendv_epi8(direction, east, isNorth);
+            right = _mm256_blendv_epi8(right, west, isSouth);
+            right = _mm256_blendv_epi8(right, south, isEast);
+            right = _mm256_blendv_epi8(right, north, isWest);
+
+            const auto turnedLeft = _mm256_and_si256(_mm256_cmpeq_epi8(cmd, _mm256_set1_epi8(cmdTURN_LEFT)), isPlaced);
+            const auto turnedRight = _mm256_and_si256(_mm256_cmpeq_epi8(cmd, _mm256_set1_epi8(cmdTURN_RIGHT)), isPlaced);
+            const auto placedNow = _mm256_andnot_si256(isPlaced, _mm256_and_si256(_mm256_cmpeq_epi8(cmd, _mm256_set1_epi8(cmdPLACE)),
+                _mm256_and_si256(LessOrEqual(placeX, limit), LessOrEqual(placeY, limit))));
+
+            x = _mm256_blendv_epi8(_mm256_blendv_epi8(x, nextX, moved), placeX, placedNow);
+            y = _mm256_blendv_epi8(_mm256_blendv_epi8(y, nextY, moved), placeY, placedNow);
+            direction = _mm256_blendv_epi8(direction, left, turnedLeft);
+            direction = _mm256_blendv_epi8(direction, right, turnedRight);
+            direction = _mm256_blendv_epi8(direction, placeDirection, placedNow);
+            placed = _mm256_or_si256(placed, _mm256_and_si256(placedNow, one));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.x + idx), x);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.y + idx), y);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.facingDirection + idx), direction);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.placed + idx), placed);
+        }
+    }
+#endif
+
+    const char* const FacingDirectionNames[] = { "UNKNOWN", "NORTH", "SOUTH", "EAST", "WEST" };
+}
+
+LockstepRunner::LockstepRunner(SimdLevel maxLevel)
+{
+    const auto detected = DetectSimdLevel();
+    m_level = maxLevel < detected ? maxLevel : detected;
+}
+
+SimdLevel LockstepRunner::DetectSimdLevel()
+{
+#if defined(TOYROBOT_HAS_X86_SIMD) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const auto maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    const auto sse41 = (info[2] & (1 << 19)) != 0;
+    const auto osxsave = (info[2] & (1 << 27)) != 0;
+    const auto avx = (info[2] & (1 << 28)) != 0;
+
+    // AVX registers are only usable when the operating system saves them on context switches.
+    auto avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6)
+    {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+
+    return avx2 ? slAVX2 : sse41 ? slSSE41 : slSCALAR;
+#elif defined(TOYROBOT_HAS_X86_SIMD)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? slAVX2 : __builtin_cpu_supports("sse4.1") ? slSSE41 : slSCALAR;
+#else
+    return slSCALAR;
+#endif
+}
+
+void LockstepRunner::Step(const Lanes& lanes) const
+{
+    switch (m_level)
+    {
+#if defined(TOYROBOT_HAS_X86_SIMD)
+    case slAVX2:
+        StepAvx2(lanes);
+        break;
+    case slSSE41:
+        StepSse41(lanes);
+        break;
+#endif
+    case slSCALAR:
+    default:
+        StepScalar(lanes);
+        break;
+    }
+}
+
+void LockstepRunner::Run(const std::vector<CommandProgram>& programs, std::vector<std::vector<std::string>>& reports)
+{
+    const auto count = (programs.size() + LaneBlock - 1) / LaneBlock * LaneBlock;
+
+    std::vector<uint8_t> x(count, 0);
+    std::vector<uint8_t> y(count, 0);
+    std::vector<uint8_t> facingDirection(count, fdUNKNOWN);
+    std::vector<uint8_t> placed(count, 0);
+    std::vector<uint8_t> commands(count, cmdUNKNOWN);
+    std::vector<uint8_t> placeX(count, 0);
+    std::vector<uint8_t> placeY(count, 0);
+    std::vector<uint8_t> placeDirection(count, fdUNKNOWN);
+
+    // The running programs fill the first lanes, lane by lane, with their program counters.
+    // A finished program hands its lane to the last running one, so the steps only cover the live lanes.
+    std::vector<size_t> programOf;
+    for (size_t program = 0; program < programs.size(); program++)
+    {
+        if (programs[program].Blocks().empty())
+            programOf.push_back(program);
+    }
+
+    std::vector<size_t> pcs(programs.size(), 0);
+    auto live = programOf.size();
+
+    // REPORT state is recorded as plain bytes while running and only formatted once all programs are done.
+    struct ReportRecord
+    {
+        uint32_t program;
+        uint8_t x;
+        uint8_t y;
+        uint8_t facingDirection;
+    };
+
+    std::vector<size_t> reporting;
+    std::vector<ReportRecord> records;
+
+    Lanes lanes = {
+        x.data(), y.data(), facingDirection.data(), placed.data(),
+        commands.data(), placeX.data(), placeY.data(), placeDirection.data(), count
+    };
+
+    while (live > 0)
+    {
+        // Decode the next opcode of every running program into its lane.
+        reporting.clear();
+        for (size_t lane = 0; lane < live;)
+        {
+            const auto& code = programs[programOf[lane]].Code();
+            auto& pc = pcs[programOf[lane]];
+
+            if (pc >= code.size() || code[pc] == cmdEXIT)
+            {
+                // The last running lane has not been decoded yet, it moves here and is decoded next.
+                live--;
+                programOf[lane] = programOf[live];
+                x[lane] = x[live];
+                y[lane] = y[live];
+                facingDirection[lane] = facingDirection[live];
+                placed[lane] = placed[live];
+                continue;
+            }
+
+            const auto cmd = static_cast<Command>(code[pc++]);
+            commands[lane] = static_cast<uint8_t>(cmd);
+
+            if (cmd == cmdPLACE)
+            {
+                int64_t placeAt[2];
+                std::memcpy(placeAt, code.data() + pc, sizeof(placeAt));
+                placeX[lane] = ToLaneCoordinate(placeAt[0]);
+                placeY[lane] = ToLaneCoordinate(placeAt[1]);
+                placeDirection[lane] = code[pc + sizeof(placeAt)];
+                pc += CommandProgram::PlacePayloadSize;
+            }
+            else if (cmd == cmdUNKNOWN)
+            {
+                pc += CommandProgram::ErrorPayloadSize;
+            }
+            else if (cmd == cmdREPORT)
+            {
+                reporting.push_back(lane);
+            }
+
+            lane++;
+        }
+
+        if (live == 0)
+            break;
+
+        // The lanes past the live ones up to the end of their block do nothing.
+        lanes.count = (live + LaneBlock - 1) / LaneBlock * LaneBlock;
+        std::fill(commands.begin() + live, commands.begin() + lanes.count, static_cast<uint8_t>(cmdUNKNOWN));
+        Step(lanes);
+
+        // REPORT does not change the lane, so the state after the step is the state it reports.
+        for (const auto lane : reporting)
+            records.push_back({ static_cast<uint32_t>(programOf[lane]), x[lane], y[lane], facingDirection[lane] });
+    }
+
+    std::vector<size_t> reportCounts(programs.size(), 0);
+    for (const auto& record : records)
+        reportCounts[record.program]++;
+
+    reports.assign(programs.size(), {});
+    for (size_t lane = 0; lane < programs.size(); lane++)
+        reports[lane].reserve(reportCounts[lane]);
+
+    for (const auto& record : records)
+    {
+        char buffer[32];
+        auto end = std::to_chars(buffer, buffer + sizeof(buffer), record.x).ptr;
+        *end++ = ',';
+        end = std::to_chars(end, buffer + sizeof(buffer), record.y).ptr;
+        *end++ = ',';
+
+        const auto name = FacingDirectionNames[record.facingDirection <= fdWEST ? record.facingDirection : static_cast<uint8_t>(fdUNKNOWN)];
+
+        auto& line = reports[record.program].emplace_back("Output: ");
+        line.append(buffer, end).append(name);
+    }
+
+    // A program with blocks does not decode one opcode per step. It runs on its own robot instead.
+    for (size_t lane = 0; lane < programs.size(); lane++)
+    {
+        if (programs[lane].Blocks().empty())
+            continue;
+
+        ReportLogger logger(reports[lane]);
+        ToyRobot robot(logger);
+        ProgramRunner runner(robot, logger);
+        runner.Run(programs[lane]);
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "CommandProgram.h"
+#include "SimdLevel.h"
+
+/// <summary>
+/// Runs many compiled programs in lockstep, each on its own fresh robot.
+/// The robots are packed into byte lanes (x, y, facing direction, placed). On every step each program's next
+/// opcode is decoded into its lane, then a single vector kernel applies all the lanes at once, with masked
+/// boundary checks instead of branches. Semantics are the same as ToyRobot; only REPORT output is collected.
+/// Programs with blocks are run one at a time by the program runner.
+/// </summary>
+class LockstepRunner
+{
+public:
+    /// <summary>
+    /// Create a runner using the best kernel supported by the CPU, but not above the given level.
+    /// </summary>
+    explicit LockstepRunner(SimdLevel maxLevel = slAVX2);
+
+    /// <summary>
+    /// Best SIMD level supported by this CPU and operating system.
+    /// </summary>
+    static SimdLevel DetectSimdLevel();
+
+    SimdLevel Level() const { return m_level; }
+
+    /// <summary>
+    /// Run all programs to completion.
+    /// </summary>
+    /// <param name="programs">Programs to run, one robot each</param>
+    /// <param name="reports">Receives the REPORT output lines of each program, in program order</param>
+    void Run(const std::vector<CommandProgram>& programs, std::vector<std::vector<std::string>>& reports);
+
+    /// <summary>
+    /// State and per-step input of the lanes, one byte per lane in each array.
+    /// </summary>
+    struct Lanes
+    {
+        uint8_t* x;
+        uint8_t* y;
+        uint8_t* facingDirection;
+        uint8_t* placed;
+        const uint8_t* commands;
+        const uint8_t* placeX;
+        const uint8_t* placeY;
+        const uint8_t* placeDirection;
+        size_t count;
+    };
+
+    /// <summary>
+    /// Lane counts given to Step must be a multiple of this (the widest vector).
+    /// </summary>
+    static constexpr size_t LaneBlock = 32;
+
+    /// <summary>
+    /// Apply one command per lane. Commands other than PLACE, MOVE, LEFT and RIGHT leave the lane unchanged.
+    /// PLACE takes its coordinates and facing direction from placeX, placeY and placeDirection.
+    /// </summary>
+    void Step(const Lanes& lanes) const;
+
+private:
+    SimdLevel m_level;
+};
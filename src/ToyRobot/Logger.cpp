@@ -20,39 +20,223 @@
 
 #include "Logger.h"
 #include <iostream>
-#include <iomanip>
 #include <ctime>
 #include <fstream>
-#include <sstream>
+#include <filesystem>
+#include <chrono>
 
-#pragma warning(disable : 4996) //_CRT_SECURE_NO_WARNINGS
-
-std::string LoggerBase::FormatLogMsg(std::string msgType, std::string msg)
+namespace
 {
-	std::stringstream sstream;
-	auto t = std::time(nullptr);
-	auto tm = *std::localtime(&t);
+	/// <summary>
+	/// Rendered "%d-%m-%Y %H-%M-%S" timestamp of the current second.
+	/// </summary>
+	struct TimestampCache
+	{
+		std::time_t second = -1;
+		char text[32] = {};
+		size_t length = 0;
+	};
+
+	std::string_view CurrentTimestamp()
+	{
+		thread_local TimestampCache cache;
+
+		const auto t = std::time(nullptr);
+		if (t != cache.second)
+		{
+			std::tm tm;
+#if defined(_WIN32)
+			localtime_s(&tm, &t);
+#else
+			localtime_r(&t, &tm);
+#endif
+			cache.length = std::strftime(cache.text, sizeof(cache.text), "%d-%m-%Y %H-%M-%S", &tm);
+			cache.second = t;
+		}
 
-	sstream
-		<< std::put_time(&tm, "%d-%m-%Y %H-%M-%S")
-		<< " - "
-		<< msgType
-		<< " - "
-		<< msg;
+		return std::string_view(cache.text, cache.length);
+	}
+}
+
+void LoggerBase::FormatLogMsg(std::string& buffer, std::string_view msgType, std::string_view msg)
+{
+	const auto timestamp = CurrentTimestamp();
 
-	return sstream.str();
+	buffer.clear();
+	buffer.reserve(timestamp.size() + msgType.size() + msg.size() + 6);
+	buffer
+		.append(timestamp)
+		.append(" - ")
+		.append(msgType)
+		.append(" - ")
+		.append(msg);
 }
 
+std::string_view LoggerBase::FormatLogMsg(std::string_view msgType, std::string_view msg)
+{
+	FormatLogMsg(m_buffer, msgType, msg);
+	return m_buffer;
+}
 
-void ConsoleLogger::Print(std::string msgType, std::string msg, std::string end)
+void ConsoleLogger::Print(std::string_view msgType, std::string_view msg, std::string_view end)
 {
 	std::cout << FormatLogMsg(msgType, msg) << end;
 }
 
-void FileLogger::Print(std::string msgType, std::string msg, std::string end)
+void BufferLogger::Print(std::string_view msgType, std::string_view msg, std::string_view end)
+{
+	m_output.append(FormatLogMsg(msgType, msg)).append(end);
+}
+
+FileLogger::FileLogger(std::string path, FileLoggerOptions options) :
+	m_path(path),
+	m_options(options),
+	m_stream(m_file),
+	m_queue(options.queueCapacity)
+{
+	m_wakeMask = m_queue.Capacity() / 2 - 1;
+	m_file.open(m_path, std::ios_base::app);
+	m_writer = std::thread(&FileLogger::WriterLoop, this);
+}
+
+FileLogger::FileLogger(std::ostream& stream, FileLoggerOptions options) :
+	m_options(options),
+	m_stream(stream),
+	m_queue(options.queueCapacity)
+{
+	m_wakeMask = m_queue.Capacity() / 2 - 1;
+	m_writer = std::thread(&FileLogger::WriterLoop, this);
+}
+
+FileLogger::~FileLogger()
+{
+	m_stop.store(true);
+	WakeWriter();
+	m_writer.join();
+}
+
+void FileLogger::Print(std::string_view msgType, std::string_view msg, std::string_view end)
 {
-	std::ofstream myfile;
-	myfile.open(m_path, std::ios_base::app);
-	myfile << FormatLogMsg(msgType, msg) << end;
-	myfile.close();
+	thread_local std::string record;
+	FormatLogMsg(record, msgType, msg);
+	record.append(end);
+
+	uint64_t position;
+	while (!m_queue.TryPush(record, position))
+	{
+		if (m_options.queueFullPolicy == qfDROP)
+		{
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		WakeWriter();
+		std::this_thread::yield();
+	}
+
+	const auto sync = (m_options.flushPolicy & fpSYNC_ERRORS) != 0 && msgType == "ERROR";
+	if (!sync)
+	{
+		// The writer polls on its flush interval, only wake it up early once the queue is half full.
+		if ((position & m_wakeMask) == m_wakeMask && m_writerSleeping.load())
+			WakeWriter();
+		return;
+	}
+
+	// Wait until the writer has flushed this record to the file.
+	std::unique_lock<std::mutex> lock(m_mutex);
+	WaitUntilFlushed(position + 1, lock);
+}
+
+uint64_t FileLogger::Flush()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		WaitUntilFlushed(m_queue.PushedCount(), lock);
+	}
+
+	if (m_path.empty())
+		return 0;
+
+	// Ask the file system, the stream may translate line breaks.
+	std::error_code ec;
+	const auto size = std::filesystem::file_size(m_path, ec);
+	return ec ? 0 : size;
+}
+
+void FileLogger::WaitUntilFlushed(uint64_t count, std::unique_lock<std::mutex>& lock)
+{
+	// The target only grows, so one flush answers every producer waiting for a record up to it.
+	if (m_syncTarget.load() < count)
+		m_syncTarget.store(count);
+	m_writerSignal.notify_one();
+	m_flushSignal.wait(lock, [&]() { return m_flushedCount >= count; });
+}
+
+void FileLogger::WakeWriter()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_writerSignal.notify_one();
+}
+
+void FileLogger::WriterLoop()
+{
+	const auto flushEveryRecords = (m_options.flushPolicy & fpEVERY_N_RECORDS) != 0 && m_options.flushRecords > 0;
+	const auto flushOnTimer = (m_options.flushPolicy & fpEVERY_T_MILLISECONDS) != 0;
+	const auto flushInterval = std::chrono::milliseconds(flushOnTimer ? m_options.flushMilliseconds : 1000);
+
+	auto lastFlush = std::chrono::steady_clock::now();
+	uint64_t unflushedRecords = 0;
+	std::string record;
+
+	const auto flush = [&]() {
+		m_stream.flush();
+		unflushedRecords = 0;
+		lastFlush = std::chrono::steady_clock::now();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_flushedCount = m_queue.PoppedCount();
+		m_flushSignal.notify_all();
+	};
+
+	for (;;)
+	{
+		while (m_queue.TryPop(record))
+		{
+			m_stream.write(record.data(), record.size());
+			unflushedRecords++;
+
+			if (flushEveryRecords && unflushedRecords >= m_options.flushRecords)
+				flush();
+		}
+
+		// Records a producer waits for may be popped after it set the target, so compare with what is popped.
+		if (IsSyncPending() && m_queue.PoppedCount() >= m_syncTarget.load())
+			flush();
+		else if (flushOnTimer && unflushedRecords > 0 && std::chrono::steady_clock::now() - lastFlush >= flushInterval)
+			flush();
+
+		if (m_stop.load())
+		{
+			// Producers are gone once the logger is being destroyed, drain what is left.
+			while (m_queue.TryPop(record))
+				m_stream.write(record.data(), record.size());
+			flush();
+			break;
+		}
+
+		if (IsSyncPending())
+		{
+			// A record before the target is still being pushed, its producer does not wake the writer.
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_writerSleeping.store(true);
+		m_writerSignal.wait_for(lock, flushInterval, [&]() {
+			return m_stop.load() || IsSyncPending() || !m_queue.IsEmpty();
+		});
+		m_writerSleeping.store(false);
+	}
 }
\ No newline at end of file
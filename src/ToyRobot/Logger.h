@@ -20,47 +20,263 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include "CommandStats.h"
+#include "LogLevel.h"
+#include "MpscRingBuffer.h"
+
+/// <summary>
+/// Compile time minimum log level. Calls below this level compile to nothing.
+/// </summary>
+#ifndef TOYROBOT_MIN_LOG_LEVEL
+#define TOYROBOT_MIN_LOG_LEVEL llINFO
+#endif
 
 class LoggerBase
 {
 public:
-    void Error(std::string msg, std::string end = "\n")
+    void Error(std::string_view msg, std::string_view end = "\n")
     { 
-        Print("ERROR", msg, end);
+        if (IsEnabled(llERROR))
+            Emit("ERROR", msg, end);
+    }
+
+    void Info(std::string_view msg, std::string_view end = "\n")
+    {
+        if (IsEnabled(llINFO))
+            Emit("INFO", msg, end);
+    }
+
+    void Warn(std::string_view msg, std::string_view end = "\n")
+    {
+        if (IsEnabled(llWARN))
+            Emit("WARN", msg, end);
+    }
+
+    /// <summary>
+    /// Lazy variants taking a callable that builds the message. It is only invoked when the level is enabled.
+    /// </summary>
+    template <typename TMessage, typename = std::enable_if_t<std::is_invocable_v<TMessage>>>
+    void Error(TMessage&& makeMessage, std::string_view end = "\n")
+    {
+        Log<llERROR>("ERROR", makeMessage, end);
+    }
+
+    template <typename TMessage, typename = std::enable_if_t<std::is_invocable_v<TMessage>>>
+    void Info(TMessage&& makeMessage, std::string_view end = "\n")
+    {
+        Log<llINFO>("INFO", makeMessage, end);
+    }
+
+    template <typename TMessage, typename = std::enable_if_t<std::is_invocable_v<TMessage>>>
+    void Warn(TMessage&& makeMessage, std::string_view end = "\n")
+    {
+        Log<llWARN>("WARN", makeMessage, end);
     }
 
-    void Info(std::string msg, std::string end = "\n")
+    /// <summary>
+    /// Print the output of a command, such as REPORT. Output is printed at any log level, with the INFO type.
+    /// </summary>
+    void Output(std::string_view msg, std::string_view end = "\n")
     {
-        Print("INFO", msg, end);
+        Emit("INFO", msg, end);
     }
 
-    void Warn(std::string msg, std::string end = "\n")
+    /// <summary>
+    /// Whether messages of the given level are printed. Cheap enough to be called before building a message.
+    /// </summary>
+    bool IsEnabled(LogLevel level) const
     {
-        Print("WARN", msg, end);
+        return level >= TOYROBOT_MIN_LOG_LEVEL && level >= m_level;
     }
 
+    /// <summary>
+    /// Set the runtime minimum log level.
+    /// </summary>
+    void SetLevel(LogLevel level) { m_level = level; }
+    LogLevel Level() const { return m_level; }
+
 protected:
-    void virtual Print(std::string msgType, std::string msg, std::string end) = 0;
-    std::string FormatLogMsg(std::string msgType, std::string msg);
+    void virtual Print(std::string_view msgType, std::string_view msg, std::string_view end) = 0;
+
+    /// <summary>
+    /// Format a log record into the logger's own buffer.
+    /// </summary>
+    /// <returns>View of the formatted record. It is valid until the next call.</returns>
+    std::string_view FormatLogMsg(std::string_view msgType, std::string_view msg);
+
+    /// <summary>
+    /// Format a log record into the given buffer. Safe to call from any thread.
+    /// The timestamp is rendered once per second and per thread, and then copied.
+    /// </summary>
+    /// <param name="buffer">Buffer receiving the record. Previous content is replaced.</param>
+    static void FormatLogMsg(std::string& buffer, std::string_view msgType, std::string_view msg);
+
+private:
+    template <LogLevel level, typename TMessage>
+    void Log(std::string_view msgType, TMessage& makeMessage, std::string_view end)
+    {
+        if constexpr (level >= TOYROBOT_MIN_LOG_LEVEL)
+        {
+            if (level >= m_level)
+                Emit(msgType, makeMessage(), end);
+        }
+    }
+
+    /// <summary>
+    /// Print a record, adding the time it took to the log ticks of the thread when statistics are enabled.
+    /// </summary>
+    void Emit(std::string_view msgType, std::string_view msg, std::string_view end)
+    {
+        if constexpr (StatsEnabled)
+        {
+            const auto start = CommandStats::Ticks();
+            Print(msgType, msg, end);
+            CommandStats::ThisThread().LogTicks() += CommandStats::Ticks() - start;
+        }
+        else
+        {
+            Print(msgType, msg, end);
+        }
+    }
+
+    std::string m_buffer;
+    LogLevel m_level = llINFO;
 };
 
 class ConsoleLogger : public LoggerBase
 {
 protected:
-    void Print(std::string msgType, std::string msg, std::string end) override;
+    void Print(std::string_view msgType, std::string_view msg, std::string_view end) override;
+};
+
+/// <summary>
+/// Logger keeping the formatted records in memory, for callers that write the whole output in one go.
+/// </summary>
+class BufferLogger : public LoggerBase
+{
+public:
+    const std::string& Buffer() const { return m_output; }
+
+protected:
+    void Print(std::string_view msgType, std::string_view msg, std::string_view end) override;
+
+private:
+    std::string m_output;
+};
+
+/// <summary>
+/// When the file logger flushes the written records to the file. Values can be combined.
+/// </summary>
+enum FlushPolicy
+{
+	fpON_EXIT = 0x0,
+	fpEVERY_N_RECORDS = 0x1,
+	fpEVERY_T_MILLISECONDS = 0x2,
+	fpSYNC_ERRORS = 0x4
+};
+
+/// <summary>
+/// What a producer does when the file logger queue is full.
+/// </summary>
+enum QueueFullPolicy
+{
+	qfBLOCK = 0,
+	qfDROP = 1
+};
+
+struct FileLoggerOptions
+{
+	/// <summary>
+	/// Combination of FlushPolicy values. Records are always flushed when the logger is destroyed.
+	/// </summary>
+	int flushPolicy = fpEVERY_T_MILLISECONDS;
+	size_t flushRecords = 1024;
+	unsigned int flushMilliseconds = 100;
+
+	/// <summary>
+	/// Maximum number of records waiting for the writer thread.
+	/// </summary>
+	size_t queueCapacity = 8192;
+	QueueFullPolicy queueFullPolicy = qfBLOCK;
 };
 
+/// <summary>
+/// File logger keeping the file open and writing on a background thread.
+/// Records are handed over through a bounded lock-free queue, so memory use is limited by the queue capacity.
+/// It can also write to a stream that outlives it, such as stdout.
+/// </summary>
 class FileLogger : public LoggerBase
 {
 public:
     FileLogger(std::string path) :
-        m_path(path)
+        FileLogger(path, FileLoggerOptions())
     {}
 
+    FileLogger(std::string path, FileLoggerOptions options);
+
+    /// <summary>
+    /// Write to the given stream instead of a file. Only the writer thread uses the stream until the logger is destroyed.
+    /// </summary>
+    FileLogger(std::ostream& stream, FileLoggerOptions options);
+
+    /// <summary>
+    /// Copy constructor is not allowed
+    /// </summary>
+    FileLogger(const FileLogger&) = delete;
+
+    /// <summary>
+    /// Write out every queued record, flush and close the file.
+    /// </summary>
+    ~FileLogger();
+
+    /// <summary>
+    /// Number of records dropped because the queue was full. Only used with the qfDROP policy.
+    /// </summary>
+    uint64_t DroppedRecords() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /// <summary>
+    /// Wait until every record logged so far is written and flushed.
+    /// </summary>
+    /// <returns>Size of the output file at that point. Zero when writing to a stream.</returns>
+    uint64_t Flush();
+
 protected:
-    void Print(std::string msgType, std::string msg, std::string end) override;
+    void Print(std::string_view msgType, std::string_view msg, std::string_view end) override;
 
 private:
+    void WriterLoop();
+    void WakeWriter();
+    void WaitUntilFlushed(uint64_t count, std::unique_lock<std::mutex>& lock);
+
+    /// <summary>
+    /// Whether a waiting producer needs a flush that has not happened yet. Only called on the writer thread.
+    /// </summary>
+    bool IsSyncPending() const { return m_syncTarget.load() > m_flushedCount; }
+
     const std::string m_path;
+    const FileLoggerOptions m_options;
+
+    std::ofstream m_file;
+    std::ostream& m_stream;
+    MpscRingBuffer<std::string> m_queue;
+
+    std::mutex m_mutex;
+    std::condition_variable m_writerSignal;
+    std::condition_variable m_flushSignal;
+    std::atomic<bool> m_writerSleeping{ false };
+    std::atomic<bool> m_stop{ false };
+    std::atomic<uint64_t> m_syncTarget{ 0 };
+    std::atomic<uint64_t> m_dropped{ 0 };
+    uint64_t m_flushedCount = 0;
+    uint64_t m_wakeMask = 0;
+
+    std::thread m_writer;
 };
\ No newline at end of file
@@ -0,0 +1,156 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// Bounded lock-free multi-producer single-consumer ring buffer.
+/// Each slot carries a sequence number telling whether it is free for the producer of a given
+/// position or filled for the consumer. Values are exchanged by swapping, so a producer gets back
+/// the storage of a previously consumed value and heap buffers are recycled instead of reallocated.
+/// </summary>
+template <typename T>
+class MpscRingBuffer
+{
+public:
+    /// <summary>
+    /// Create the ring buffer. Capacity is rounded up to a power of two.
+    /// </summary>
+    explicit MpscRingBuffer(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+
+        m_mask = size - 1;
+        m_slots = std::vector<Slot>(size);
+        for (size_t idx = 0; idx < size; idx++)
+            m_slots[idx].sequence.store(idx, std::memory_order_relaxed);
+    }
+
+    /// <summary>
+    /// Copy constructor is not allowed
+    /// </summary>
+    MpscRingBuffer(const MpscRingBuffer&) = delete;
+
+    /// <summary>
+    /// Try to push a value. Safe to call from any number of threads.
+    /// </summary>
+    /// <param name="value">Value to push. Receives the recycled content of the slot on success.</param>
+    /// <param name="position">Position of the pushed value in the overall stream.</param>
+    /// <returns>[true] Value is pushed. [false] Buffer is full.</returns>
+    bool TryPush(T& value, uint64_t& position)
+    {
+        auto pos = m_head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto& slot = m_slots[pos & m_mask];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+            if (diff == 0)
+            {
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    std::swap(slot.value, value);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    position = pos;
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Try to pop the oldest value. Must only be called from the single consumer thread.
+    /// </summary>
+    /// <param name="value">Receives the value. Its previous content is left in the slot for reuse.</param>
+    /// <returns>[true] Value is popped. [false] Buffer is empty.</returns>
+    bool TryPop(T& value)
+    {
+        auto& slot = m_slots[m_tail & m_mask];
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != m_tail + 1)
+            return false;
+
+        std::swap(slot.value, value);
+        slot.sequence.store(m_tail + m_mask + 1, std::memory_order_release);
+        m_tail++;
+
+        return true;
+    }
+
+    size_t Capacity() const { return m_mask + 1; }
+
+    /// <summary>
+    /// Whether there is nothing to pop. Must only be called from the single consumer thread.
+    /// </summary>
+    bool IsEmpty() const
+    {
+        return m_slots[m_tail & m_mask].sequence.load(std::memory_order_acquire) != m_tail + 1;
+    }
+
+    /// <summary>
+    /// Number of positions handed out to producers so far. The values at the last ones may still be being pushed.
+    /// </summary>
+    uint64_t PushedCount() const { return m_head.load(std::memory_order_relaxed); }
+
+    /// <summary>
+    /// Number of values popped so far. Only meaningful on the consumer thread.
+    /// </summary>
+    uint64_t PoppedCount() const { return m_tail; }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence{ 0 };
+        T value;
+
+        Slot() = default;
+        Slot(Slot&& other) noexcept
+            : sequence(other.sequence.load(std::memory_order_relaxed)),
+            value(std::move(other.value))
+        {}
+        Slot& operator=(Slot&& other) noexcept
+        {
+            sequence.store(other.sequence.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            value = std::move(other.value);
+            return *this;
+        }
+    };
+
+    std::vector<Slot> m_slots;
+    size_t m_mask = 0;
+
+    alignas(64) std::atomic<uint64_t> m_head{ 0 };
+    alignas(64) uint64_t m_tail = 0;
+};
@@ -0,0 +1,120 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "OccupancyIndex.h"
+#include "Commander.h"
+#include "LineScanner.h"
+#include "MappedFile.h"
+#include <fstream>
+#include <limits>
+
+DenseOccupancy::DenseOccupancy(uint64_t maxX, uint64_t maxY):
+	m_width(maxX + 1),
+	m_bits(((maxX + 1) * (maxY + 1) + 63) / 64, 0)
+{
+}
+
+size_t DenseOccupancy::Count() const
+{
+	size_t count = 0;
+	for (auto word : m_bits)
+	{
+		for (; word != 0; word &= word - 1)
+			count++;
+	}
+
+	return count;
+}
+
+bool DenseOccupancy::Fits(uint64_t maxX, uint64_t maxY, uint64_t maxBytes)
+{
+	const auto width = maxX + 1;
+	const auto height = maxY + 1;
+	if (height > std::numeric_limits<uint64_t>::max() / width)
+		return false;
+
+	return (width * height + 7) / 8 <= maxBytes;
+}
+
+namespace
+{
+	bool TryParseObstacle(std::string_view line, uint64_t maxX, uint64_t maxY, std::vector<std::pair<uint64_t, uint64_t>>& cells, std::string& error)
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.remove_suffix(1);
+
+		const auto begin = line.find_first_not_of(' ');
+		if (begin == std::string_view::npos || line[begin] == '#')
+			return true;
+
+		std::string_view tokens[2];
+		uint64_t x;
+		uint64_t y;
+		if (CommanderBase::Split(line.substr(begin), ',', tokens, 2) != 2
+			|| !CommanderBase::TryParseInt(tokens[0], x) || !CommanderBase::TryParseInt(tokens[1], y))
+		{
+			error = "Invalid obstacle: " + std::string(line);
+			return false;
+		}
+
+		if (x > maxX || y > maxY)
+		{
+			error = "Obstacle is outside the board: " + std::string(line);
+			return false;
+		}
+
+		cells.emplace_back(x, y);
+		return true;
+	}
+}
+
+bool TryReadObstacleMap(const std::string& path, uint64_t maxX, uint64_t maxY, std::vector<std::pair<uint64_t, uint64_t>>& cells, std::string& error)
+{
+	MappedFile mappedFile;
+	if (mappedFile.TryOpen(path))
+	{
+		LineScanner scanner(mappedFile.Data(), mappedFile.Data() + mappedFile.Size());
+
+		std::string_view line;
+		while (scanner.TryNextLine(line))
+		{
+			if (!TryParseObstacle(line, maxX, maxY, cells, error))
+				return false;
+		}
+
+		return true;
+	}
+
+	std::ifstream filestream(path);
+	if (!filestream.is_open())
+	{
+		error = "Unable to open the obstacle map: " + path;
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(filestream, line))
+	{
+		if (!TryParseObstacle(line, maxX, maxY, cells, error))
+			return false;
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// Occupied cells of a dense board, one bit per cell. Checking a cell is a single bit test.
+/// A 10^4 x 10^4 board takes 12.5 MB.
+/// </summary>
+class DenseOccupancy
+{
+public:
+	DenseOccupancy(uint64_t maxX, uint64_t maxY);
+
+	bool IsOccupied(uint64_t x, uint64_t y) const
+	{
+		const auto cell = Cell(x, y);
+		return (m_bits[cell >> 6] >> (cell & 63)) & 1;
+	}
+
+	void Occupy(uint64_t x, uint64_t y)
+	{
+		const auto cell = Cell(x, y);
+		m_bits[cell >> 6] |= uint64_t(1) << (cell & 63);
+	}
+
+	void Release(uint64_t x, uint64_t y)
+	{
+		const auto cell = Cell(x, y);
+		m_bits[cell >> 6] &= ~(uint64_t(1) << (cell & 63));
+	}
+
+	/// <summary>
+	/// Number of occupied cells.
+	/// </summary>
+	size_t Count() const;
+
+	/// <summary>
+	/// Whether the bitset of the given board fits in the given number of bytes.
+	/// </summary>
+	static bool Fits(uint64_t maxX, uint64_t maxY, uint64_t maxBytes);
+
+private:
+	uint64_t Cell(uint64_t x, uint64_t y) const
+	{
+		return y * m_width + x;
+	}
+
+	uint64_t m_width;
+	std::vector<uint64_t> m_bits;
+};
+
+/// <summary>
+/// Occupied cells of a board too large for a bitset, kept in a hash set.
+/// Memory grows with the number of robots and obstacles, not with the board.
+/// </summary>
+class SparseOccupancy
+{
+public:
+	bool IsOccupied(uint64_t x, uint64_t y) const
+	{
+		return m_cells.find({ x, y }) != m_cells.end();
+	}
+
+	void Occupy(uint64_t x, uint64_t y)
+	{
+		m_cells.insert({ x, y });
+	}
+
+	void Release(uint64_t x, uint64_t y)
+	{
+		m_cells.erase({ x, y });
+	}
+
+	size_t Count() const
+	{
+		return m_cells.size();
+	}
+
+	/// <summary>
+	/// Reserve room for the given number of occupied cells, so that placing them does not rehash.
+	/// </summary>
+	void Reserve(size_t count)
+	{
+		m_cells.reserve(count);
+	}
+
+private:
+	struct Cell
+	{
+		uint64_t x;
+		uint64_t y;
+
+		bool operator==(const Cell& other) const
+		{
+			return x == other.x && y == other.y;
+		}
+	};
+
+	struct CellHash
+	{
+		size_t operator()(const Cell& cell) const
+		{
+			// Multiplicative mix, so that neighbouring cells land in different buckets.
+			const auto hash = (cell.x * 0x9E3779B97F4A7C15ull) ^ (cell.y * 0xC2B2AE3D27D4EB4Full);
+			return static_cast<size_t>(hash ^ (hash >> 32));
+		}
+	};
+
+	std::unordered_set<Cell, CellHash> m_cells;
+};
+
+/// <summary>
+/// Occupancy policy of a robot alone on its board. Every cell is free, so the checks fold away.
+/// </summary>
+struct NoOccupancy
+{
+	static constexpr bool IsFree(uint64_t /*x*/, uint64_t /*y*/) { return true; }
+	static constexpr void Occupy(uint64_t /*x*/, uint64_t /*y*/) {}
+	static constexpr void Release(uint64_t /*x*/, uint64_t /*y*/) {}
+};
+
+/// <summary>
+/// Occupancy policy of robots sharing a board. Each robot marks its cell in the shared index when it is placed
+/// and moves the mark along with it, so a move is checked against every other robot and obstacle with one lookup.
+/// </summary>
+template <typename TIndex>
+class SharedOccupancy
+{
+public:
+	SharedOccupancy(TIndex& index)
+		: m_index(&index)
+	{}
+
+	bool IsFree(uint64_t x, uint64_t y) const { return !m_index->IsOccupied(x, y); }
+	void Occupy(uint64_t x, uint64_t y) { m_index->Occupy(x, y); }
+	void Release(uint64_t x, uint64_t y) { m_index->Release(x, y); }
+
+private:
+	TIndex* m_index;
+};
+
+/// <summary>
+/// Try to read the obstacles of a map file. Every line holds one obstacle as "x,y".
+/// Empty lines and lines starting with '#' are skipped.
+/// </summary>
+/// <param name="path">Path of the map file</param>
+/// <param name="maxX">Largest x coordinate of the board</param>
+/// <param name="maxY">Largest y coordinate of the board</param>
+/// <param name="cells">Obstacle cells, appended in file order</param>
+/// <param name="error">Error message if the reading failed</param>
+/// <returns>[true] Map is read. [false] File could not be opened or a line is invalid.</returns>
+bool TryReadObstacleMap(const std::string& path, uint64_t maxX, uint64_t maxY, std::vector<std::pair<uint64_t, uint64_t>>& cells, std::string& error);
\ No newline at end of file
@@ -0,0 +1,352 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Options.h"
+#include <charconv>
+
+namespace
+{
+    /// <summary>
+    /// Whether the argument is the given option in the form of --name=value.
+    /// </summary>
+    bool IsValueOption(const std::string& arg, const std::string& name)
+    {
+        return arg.rfind(name + "=", 0) == 0;
+    }
+
+    /// <summary>
+    /// Try to read the log level of an option in the form of --log-level=name.
+    /// </summary>
+    bool TryParseLogLevel(const std::string& arg, LogLevel& level)
+    {
+        const auto value = arg.substr(arg.find('=') + 1);
+        if (value == "info")
+            level = llINFO;
+        else if (value == "warn")
+            level = llWARN;
+        else if (value == "error")
+            level = llERROR;
+        else if (value == "none")
+            level = llNONE;
+        else
+            return false;
+
+        return true;
+    }
+
+    /// <summary>
+    /// Try to read the numeric value of an option in the form of --name=value.
+    /// </summary>
+    template <typename T>
+    bool TryParseValue(const std::string& arg, T& value)
+    {
+        const auto begin = arg.data() + arg.find('=') + 1;
+        const auto end = arg.data() + arg.size();
+        const auto result = std::from_chars(begin, end, value);
+        return begin != end && result.ec == std::errc() && result.ptr == end;
+    }
+
+    /// <summary>
+    /// Largest coordinate accepted by --board.
+    /// </summary>
+    const uint64_t MaxBoardCoordinate = uint64_t(1) << 32;
+
+    /// <summary>
+    /// Try to read the board of an option in the form of --board=XxY, where X and Y are the largest coordinates.
+    /// </summary>
+    bool TryParseBoard(const std::string& arg, uint64_t& maxX, uint64_t& maxY)
+    {
+        const auto separator = arg.find('x', arg.find('=') + 1);
+        if (separator == std::string::npos)
+            return false;
+
+        const auto begin = arg.data() + arg.find('=') + 1;
+        const auto middle = arg.data() + separator;
+        const auto end = arg.data() + arg.size();
+
+        const auto xresult = std::from_chars(begin, middle, maxX);
+        const auto yresult = std::from_chars(middle + 1, end, maxY);
+        return xresult.ec == std::errc() && xresult.ptr == middle && yresult.ec == std::errc() && yresult.ptr == end
+            && maxX > 0 && maxY > 0 && maxX <= MaxBoardCoordinate && maxY <= MaxBoardCoordinate;
+    }
+}
+
+bool TryParseOptions(int argc, char** argv, ProgramOptions& options, std::string& error)
+{
+    auto flushOnExit = false;
+    auto flushPeriodically = false;
+
+    for (int idx = 1; idx < argc; idx++)
+    {
+        const std::string arg(argv[idx]);
+        if (arg.rfind("--", 0) != 0)
+        {
+            options.files.push_back(arg);
+            continue;
+        }
+
+        auto& logOptions = options.logOptions;
+        auto valid = true;
+
+        if (arg == "--compile")
+        {
+            options.compile = true;
+        }
+        else if (arg == "--lazy")
+        {
+            options.compile = true;
+            options.lazy = true;
+        }
+        else if (arg == "--pipe")
+        {
+            options.pipe = true;
+        }
+        else if (arg == "--pipeline")
+        {
+            options.pipeline = true;
+        }
+        else if (arg == "--convert")
+        {
+            options.convert = true;
+        }
+        else if (arg == "--batch")
+        {
+            options.batch = true;
+        }
+        else if (arg == "--parallel")
+        {
+            options.parallel = true;
+        }
+        else if (IsValueOption(arg, "--parallel"))
+        {
+            options.parallel = true;
+            valid = TryParseValue(arg, options.threads) && options.threads > 0;
+        }
+        else if (arg == "--compose")
+        {
+            options.compose = true;
+        }
+        else if (IsValueOption(arg, "--compose"))
+        {
+            options.compose = true;
+            valid = TryParseValue(arg, options.threads) && options.threads > 0;
+        }
+        else if (arg == "--flush-on-exit")
+        {
+            flushOnExit = true;
+        }
+        else if (arg == "--sync-errors")
+        {
+            logOptions.flushPolicy |= fpSYNC_ERRORS;
+        }
+        else if (arg == "--log-drop")
+        {
+            logOptions.queueFullPolicy = qfDROP;
+        }
+        else if (IsValueOption(arg, "--board"))
+        {
+            valid = TryParseBoard(arg, options.boardMaxX, options.boardMaxY);
+        }
+        else if (IsValueOption(arg, "--obstacles"))
+        {
+            options.obstacleMap = arg.substr(arg.find('=') + 1);
+            valid = !options.obstacleMap.empty();
+        }
+        else if (arg == "--resume")
+        {
+            options.resume = true;
+        }
+        else if (IsValueOption(arg, "--journal"))
+        {
+            options.journal = arg.substr(arg.find('=') + 1);
+            valid = !options.journal.empty();
+        }
+        else if (IsValueOption(arg, "--checkpoint-commands"))
+        {
+            valid = TryParseValue(arg, options.journalOptions.checkpointCommands);
+        }
+        else if (IsValueOption(arg, "--checkpoint-bytes"))
+        {
+            valid = TryParseValue(arg, options.journalOptions.checkpointBytes);
+        }
+        else if (IsValueOption(arg, "--results"))
+        {
+            options.results = arg.substr(arg.find('=') + 1);
+            valid = !options.results.empty();
+        }
+        else if (IsValueOption(arg, "--results-format"))
+        {
+            const auto value = arg.substr(arg.find('=') + 1);
+            options.resultFormat = value == "binary" ? rfBINARY : rfCSV;
+            valid = value == "csv" || value == "binary";
+        }
+        else if (IsValueOption(arg, "--serve"))
+        {
+            options.server.address = arg.substr(arg.find('=') + 1);
+            valid = !options.server.address.empty();
+        }
+        else if (IsValueOption(arg, "--server-threads"))
+        {
+            valid = TryParseValue(arg, options.server.threads) && options.server.threads > 0;
+        }
+        else if (IsValueOption(arg, "--log-level"))
+        {
+            valid = TryParseLogLevel(arg, options.logLevel);
+        }
+        else if (IsValueOption(arg, "--flush-records"))
+        {
+            valid = TryParseValue(arg, logOptions.flushRecords);
+            logOptions.flushPolicy |= fpEVERY_N_RECORDS;
+            flushPeriodically = true;
+        }
+        else if (IsValueOption(arg, "--flush-ms"))
+        {
+            valid = TryParseValue(arg, logOptions.flushMilliseconds);
+            logOptions.flushPolicy |= fpEVERY_T_MILLISECONDS;
+            flushPeriodically = true;
+        }
+        else if (IsValueOption(arg, "--log-queue"))
+        {
+            valid = TryParseValue(arg, logOptions.queueCapacity) && logOptions.queueCapacity > 0;
+        }
+        else
+        {
+            error = "Unknown option: " + arg;
+            return false;
+        }
+
+        if (!valid)
+        {
+            error = "Invalid value: " + arg;
+            return false;
+        }
+    }
+
+    if (flushOnExit)
+    {
+        if (flushPeriodically)
+        {
+            error = "The --flush-on-exit option can not be used with --flush-ms or --flush-records.";
+            return false;
+        }
+
+        // Only the default timer is dropped, --sync-errors is kept whatever the order of the options.
+        options.logOptions.flushPolicy &= ~fpEVERY_T_MILLISECONDS;
+    }
+
+    if (options.batch && options.parallel)
+    {
+        error = "The --batch and --parallel options can not be used together.";
+        return false;
+    }
+
+    if ((options.batch || options.parallel) && (!options.IsDefaultBoard() || !options.obstacleMap.empty() || options.lazy))
+    {
+        error = "The --board, --obstacles and --lazy options can not be used with --batch or --parallel.";
+        return false;
+    }
+
+    if (options.convert && (options.compile || options.batch || options.parallel || !options.obstacleMap.empty() || !options.journal.empty() || options.files.size() != 2))
+    {
+        error = "The --convert option requires an input file and an output file, and can only be used with --board.";
+        return false;
+    }
+
+    if (options.pipe && (!options.files.empty() || options.compile || options.batch || options.parallel || options.convert || !options.journal.empty()))
+    {
+        error = "The --pipe option reads stdin. It can not be used with input files, --compile, --lazy, --batch, --parallel, --convert or --journal.";
+        return false;
+    }
+
+    if (options.pipeline && (options.compile || options.batch || options.parallel || options.convert || !options.journal.empty()
+        || !options.server.address.empty() || (options.files.empty() && !options.pipe)))
+    {
+        error = "The --pipeline option requires an input file and an output file, or --pipe. It can not be used with --compile, --lazy, --batch, --parallel, --convert, --journal or --serve.";
+        return false;
+    }
+
+    if (!options.server.address.empty() && (!options.files.empty() || options.compile || options.batch || options.parallel
+        || options.convert || options.pipe || !options.journal.empty() || !options.IsDefaultBoard() || !options.obstacleMap.empty()))
+    {
+        error = "The --serve option only takes --server-threads and --log-level.";
+        return false;
+    }
+
+    if (options.resume && options.journal.empty())
+    {
+        error = "The --resume option requires a --journal.";
+        return false;
+    }
+
+    if (!options.journal.empty() && (options.compile || options.batch || options.parallel || options.files.empty()))
+    {
+        error = "The --journal option requires an input file and an output file, and can not be used with --compile, --lazy, --batch or --parallel.";
+        return false;
+    }
+
+    if (options.compose && (options.files.size() != 2 || options.batch || options.parallel || options.pipe || options.pipeline || options.convert
+        || !options.journal.empty() || !options.results.empty() || !options.IsDefaultBoard() || !options.obstacleMap.empty()))
+    {
+        error = "The --compose option requires an input file and an output file on the default board. It can not be used with --batch, --parallel, --pipe, --pipeline, --convert, --journal, --results, --board or --obstacles.";
+        return false;
+    }
+
+    if (!options.results.empty() && (options.batch || options.parallel || options.convert || !options.server.address.empty()))
+    {
+        error = "The --results option can not be used with --batch, --parallel, --convert or --serve.";
+        return false;
+    }
+
+    if (options.parallel)
+    {
+        if (options.files.size() < 2)
+        {
+            error = "The --parallel option requires one or more input files, directories or patterns and an output directory.";
+            return false;
+        }
+
+        return true;
+    }
+
+    if (options.batch)
+    {
+        if (options.files.size() < 2)
+        {
+            error = "The --batch option requires one or more input files and an output file.";
+            return false;
+        }
+
+        return true;
+    }
+
+    if (!options.files.empty() && options.files.size() != 2)
+    {
+        error = "Invalid number of arguments. Console aruments should be in the form of '>toyrobot.exe [options] inputfile.txt outputfile.txt'";
+        return false;
+    }
+
+    if (options.compile && options.files.empty())
+    {
+        error = "The --compile and --lazy options require an input file and an output file.";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,160 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Board.h"
+#include "Journal.h"
+#include "ResultSink.h"
+#include "RobotServer.h"
+#include "Logger.h"
+
+/// <summary>
+/// Command line options of the toy robot.
+/// </summary>
+struct ProgramOptions
+{
+    /// <summary>
+    /// Compile the whole input file before executing it (--compile).
+    /// </summary>
+    bool compile = false;
+
+    /// <summary>
+    /// Run the compiled program with runs of MOVE and turn commands coalesced (--lazy). Implies --compile.
+    /// </summary>
+    bool lazy = false;
+
+    /// <summary>
+    /// Read the commands piped into stdin in large chunks, without prompts, and quit at its end (--pipe).
+    /// </summary>
+    bool pipe = false;
+
+    /// <summary>
+    /// Read, parse and execute the commands on threads of their own, with the output written by another one (--pipeline).
+    /// Used with an input file and an output file, or with --pipe.
+    /// </summary>
+    bool pipeline = false;
+
+    /// <summary>
+    /// Serve robot sessions to network clients instead of running a single robot (--serve=address, --server-threads=N).
+    /// The address is kept empty when the server is not asked for.
+    /// </summary>
+    ServerOptions server;
+
+    /// <summary>
+    /// Convert the input file between the text and the binary (.trb) command formats instead of running it (--convert).
+    /// An output file ending in .trb is written in the binary format, any other in the text format.
+    /// </summary>
+    bool convert = false;
+
+    /// <summary>
+    /// Run every input file on its own robot, all in lockstep (--batch). Only REPORT output is written.
+    /// </summary>
+    bool batch = false;
+
+    /// <summary>
+    /// Run every input file on a thread pool, each into its own output file (--parallel or --parallel=threads).
+    /// </summary>
+    bool parallel = false;
+
+    /// <summary>
+    /// Run a single input file as chunks on a thread pool, composing their transitions (--compose or --compose=threads).
+    /// </summary>
+    bool compose = false;
+
+    /// <summary>
+    /// Number of worker threads for --parallel and --compose. Zero uses the number of hardware threads.
+    /// </summary>
+    size_t threads = 0;
+
+    /// <summary>
+    /// Largest x and y coordinate of the board (--board=XxY). The default board runs on the compile time
+    /// sized robot, any other size on the runtime sized one. Coordinates up to 2^32 are supported.
+    /// </summary>
+    uint64_t boardMaxX = DefaultBoard::MaxX();
+    uint64_t boardMaxY = DefaultBoard::MaxY();
+
+    /// <summary>
+    /// Map file of the static obstacles on the board (--obstacles=path). Moves into an obstacle are rejected.
+    /// </summary>
+    std::string obstacleMap;
+
+    /// <summary>
+    /// Binary journal of the run with periodic checkpoints of the robot state (--journal=path).
+    /// </summary>
+    std::string journal;
+
+    /// <summary>
+    /// Resume the run from the latest checkpoint of the journal instead of starting over (--resume).
+    /// </summary>
+    bool resume = false;
+
+    /// <summary>
+    /// Checkpoint interval of the journal (--checkpoint-commands=N, --checkpoint-bytes=N).
+    /// </summary>
+    JournalOptions journalOptions;
+
+    /// <summary>
+    /// File receiving the REPORT results instead of the log (--results=path). The log keeps the diagnostics.
+    /// </summary>
+    std::string results;
+
+    /// <summary>
+    /// Format of the result file (--results-format=csv|binary).
+    /// </summary>
+    ResultFormat resultFormat = rfCSV;
+
+    /// <summary>
+    /// Runtime minimum log level (--log-level=info|warn|error|none).
+    /// </summary>
+    LogLevel logLevel = llINFO;
+
+    /// <summary>
+    /// Options of the file logger (--flush-records=N, --flush-ms=T, --flush-on-exit, --sync-errors, --log-queue=N, --log-drop).
+    /// </summary>
+    FileLoggerOptions logOptions;
+
+    /// <summary>
+    /// Positional arguments. Either empty (console mode) or input and output files.
+    /// In batch mode any number of input files followed by the output file. In parallel mode any number of
+    /// input files, directories or wildcard patterns followed by the output directory.
+    /// </summary>
+    std::vector<std::string> files;
+
+    /// <summary>
+    /// Whether the board is the default one, handled by ToyRobot.
+    /// </summary>
+    bool IsDefaultBoard() const
+    {
+        return boardMaxX == DefaultBoard::MaxX() && boardMaxY == DefaultBoard::MaxY();
+    }
+};
+
+/// <summary>
+/// Try to parse the command line options.
+/// </summary>
+/// <param name="argc">Number of arguments</param>
+/// <param name="argv">Arguments</param>
+/// <param name="options">Parsed options</param>
+/// <param name="error">Error message if the parsing failed</param>
+/// <returns>[true] Options are valid. [false] Options are invalid.</returns>
+bool TryParseOptions(int argc, char** argv, ProgramOptions& options, std::string& error);
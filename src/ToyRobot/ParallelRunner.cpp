@@ -0,0 +1,215 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ParallelRunner.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <set>
+#include "CommandProgram.h"
+#include "Commander.h"
+#include "Logger.h"
+#include "ToyRobot.h"
+#include "WorkStealingPool.h"
+
+namespace fs = std::filesystem;
+
+bool MatchesWildcard(const std::string& name, const std::string& pattern)
+{
+    // Greedy matching, going back to the last * on a mismatch.
+    size_t n = 0;
+    size_t p = 0;
+    size_t star = std::string::npos;
+    size_t starMatch = 0;
+
+    while (n < name.size())
+    {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n]))
+        {
+            n++;
+            p++;
+        }
+        else if (p < pattern.size() && pattern[p] == '*')
+        {
+            star = p++;
+            starMatch = n;
+        }
+        else if (star != std::string::npos)
+        {
+            p = star + 1;
+            n = ++starMatch;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*')
+        p++;
+
+    return p == pattern.size();
+}
+
+bool TryExpandInputs(const std::vector<std::string>& inputs, std::vector<std::string>& files, std::string& error)
+{
+    for (const auto& input : inputs)
+    {
+        const fs::path path(input);
+        const auto name = path.filename().string();
+        std::error_code ec;
+
+        if (name.find_first_of("*?") != std::string::npos)
+        {
+            const auto directory = path.has_parent_path() ? path.parent_path() : fs::path(".");
+            std::vector<std::string> matches;
+            for (const auto& entry : fs::directory_iterator(directory, ec))
+            {
+                if (entry.is_regular_file(ec) && MatchesWildcard(entry.path().filename().string(), name))
+                    matches.push_back(entry.path().string());
+            }
+
+            if (matches.empty())
+            {
+                error = "No files match: " + input;
+                return false;
+            }
+
+            std::sort(matches.begin(), matches.end());
+            files.insert(files.end(), matches.begin(), matches.end());
+        }
+        else if (fs::is_directory(path, ec))
+        {
+            std::vector<std::string> entries;
+            for (const auto& entry : fs::directory_iterator(path, ec))
+            {
+                if (entry.is_regular_file(ec))
+                    entries.push_back(entry.path().string());
+            }
+
+            std::sort(entries.begin(), entries.end());
+            files.insert(files.end(), entries.begin(), entries.end());
+        }
+        else if (fs::is_regular_file(path, ec))
+        {
+            files.push_back(input);
+        }
+        else
+        {
+            error = "Input file not found: " + input;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<FileRunResult> ParallelRunner::Run(const std::vector<std::string>& files, const std::string& outputDirectory)
+{
+    std::vector<FileRunResult> results(files.size());
+
+    std::error_code ec;
+    fs::create_directories(outputDirectory, ec);
+
+    // Output names are the input file names. Files with the same name from different directories get a number.
+    std::set<std::string> usedNames;
+    for (size_t idx = 0; idx < files.size(); idx++)
+    {
+        auto& result = results[idx];
+        result.inputFile = files[idx];
+        result.size = fs::file_size(files[idx], ec);
+        if (ec)
+            result.size = 0;
+
+        const auto name = fs::path(files[idx]).filename().string();
+        auto outputName = name + ".out";
+        for (size_t suffix = 2; !usedNames.insert(outputName).second; suffix++)
+            outputName = name + "." + std::to_string(suffix) + ".out";
+
+        result.outputFile = (fs::path(outputDirectory) / outputName).string();
+    }
+
+    std::vector<size_t> order(files.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&results](size_t left, size_t right) {
+        return results[left].size > results[right].size;
+    });
+
+    WorkStealingPool pool(m_threads);
+    for (const auto idx : order)
+        pool.Submit([this, &results, idx]() { RunFile(results[idx]); });
+
+    pool.Wait();
+    m_stolen = pool.StolenCount();
+
+    return results;
+}
+
+void ParallelRunner::RunFile(FileRunResult& result) const
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    BufferLogger logger;
+    logger.SetLevel(m_level);
+    ToyRobot robot(logger);
+
+    if (m_compile)
+    {
+        CommandProgram program;
+        result.succeeded = program.TryCompileFile(result.inputFile);
+        if (result.succeeded)
+        {
+            logger.Info("Toy robot starting..");
+            ProgramRunner runner(robot, logger);
+            runner.Run(program);
+            logger.Info("Toy robot quitting..");
+        }
+    }
+    else
+    {
+        StatementRunner<ToyRobot> statementRunner(robot);
+        FileCommander commander(result.inputFile, robot, logger);
+        commander.SetStatementRunner(&statementRunner);
+        result.succeeded = commander.IsOpen();
+        if (result.succeeded)
+            commander.Launch();
+    }
+
+    if (!result.succeeded)
+    {
+        result.error = "Unable to open the input file";
+    }
+    else
+    {
+        std::ofstream output(result.outputFile, std::ios_base::app);
+        output.write(logger.Buffer().data(), static_cast<std::streamsize>(logger.Buffer().size()));
+        output.close();
+
+        if (!output)
+        {
+            result.succeeded = false;
+            result.error = "Unable to write the output file";
+        }
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
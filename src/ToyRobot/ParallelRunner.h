@@ -0,0 +1,97 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "LogLevel.h"
+
+/// <summary>
+/// Outcome of running one input file.
+/// </summary>
+struct FileRunResult
+{
+    std::string inputFile;
+    std::string outputFile;
+    uintmax_t size = 0;
+    bool succeeded = false;
+    std::string error;
+    double seconds = 0;
+};
+
+/// <summary>
+/// Expand the input arguments into the list of files to run.
+/// Regular files are taken as they are, directories give the regular files directly in them, and names
+/// with * or ? in their file name part give the matching files of their directory.
+/// </summary>
+/// <param name="inputs">Input arguments</param>
+/// <param name="files">Receives the files, in the order of the arguments</param>
+/// <param name="error">Error message if an argument matched nothing</param>
+/// <returns>[true] Inputs are expanded. [false] An input does not exist or matched no files.</returns>
+bool TryExpandInputs(const std::vector<std::string>& inputs, std::vector<std::string>& files, std::string& error);
+
+/// <summary>
+/// Whether the file name matches a wildcard pattern with * and ?.
+/// </summary>
+bool MatchesWildcard(const std::string& name, const std::string& pattern);
+
+/// <summary>
+/// Runs many command files at once on a work-stealing thread pool.
+/// Every file gets its own robot and logger. The log is kept in memory and written to the output file
+/// once the file is done. Files are scheduled largest first, so that the biggest scripts do not start last.
+/// </summary>
+class ParallelRunner
+{
+public:
+    /// <summary>
+    /// Create the runner.
+    /// </summary>
+    /// <param name="threads">Number of worker threads. Zero uses the number of hardware threads</param>
+    /// <param name="compile">Compile each file before running it, as with --compile</param>
+    /// <param name="level">Log level of the per-file loggers</param>
+    ParallelRunner(size_t threads, bool compile, LogLevel level)
+        : m_threads(threads),
+        m_compile(compile),
+        m_level(level)
+    {}
+
+    /// <summary>
+    /// Run every file and write its output into the output directory, as the input file name with ".out".
+    /// </summary>
+    /// <param name="files">Input files</param>
+    /// <param name="outputDirectory">Output directory. Created if it does not exist</param>
+    /// <returns>Result per input file, in the order of the input files</returns>
+    std::vector<FileRunResult> Run(const std::vector<std::string>& files, const std::string& outputDirectory);
+
+    /// <summary>
+    /// Number of files run by a worker that stole them, in the last run.
+    /// </summary>
+    size_t StolenCount() const { return m_stolen; }
+
+private:
+    void RunFile(FileRunResult& result) const;
+
+    size_t m_threads;
+    bool m_compile;
+    LogLevel m_level;
+    size_t m_stolen = 0;
+};
@@ -0,0 +1,271 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PipelinedCommander.h"
+#include "CommandProgram.h"
+#include "LineScanner.h"
+#include <chrono>
+
+namespace
+{
+    const size_t ChunkQueueCapacity = 8;
+    const size_t BatchQueueCapacity = 16;
+
+    /// <summary>
+    /// Wait of a stage whose neighbour is behind. Yields first, then sleeps, so that a stage waiting on a slow
+    /// input does not keep a core busy.
+    /// </summary>
+    void Backoff(unsigned& attempts)
+    {
+        if (++attempts < 64)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+PipelinedCommander::PipelinedCommander(std::istream& input, RobotRef robot, LoggerBase& logger, size_t chunkSize)
+    : CommanderBase(robot, logger),
+    m_input(input.rdbuf()),
+    m_chunkSize(chunkSize > 0 ? chunkSize : DefaultChunkSize),
+    m_showsPrompt(false),
+    m_chunks(ChunkQueueCapacity),
+    m_batches(BatchQueueCapacity)
+{
+}
+
+PipelinedCommander::PipelinedCommander(const std::string& path, RobotRef robot, LoggerBase& logger)
+    : CommanderBase(robot, logger),
+    m_file(path, std::ios::binary),
+    m_input(m_file.is_open() ? m_file.rdbuf() : nullptr),
+    m_chunkSize(DefaultChunkSize),
+    m_showsPrompt(true),
+    m_chunks(ChunkQueueCapacity),
+    m_batches(BatchQueueCapacity)
+{
+}
+
+PipelinedCommander::~PipelinedCommander()
+{
+    Stop();
+}
+
+bool PipelinedCommander::TryReadLine(std::string_view& /*input*/)
+{
+    return false;
+}
+
+Command PipelinedCommander::GetCommand(std::string_view& args)
+{
+    Start();
+
+    while (m_next == m_batch.count)
+    {
+        // The executed batch goes back to the parser through the slot it is swapped with.
+        if (m_batch.last || !Pop(m_batches, m_batch))
+            return cmdEXIT;
+
+        m_next = 0;
+    }
+
+    const auto& decoded = m_batch.commands[m_next++];
+    args = std::string_view(m_batch.text).substr(decoded.argsOffset, decoded.argsLength);
+    m_place = decoded.place;
+    m_placeIsValid = decoded.placeIsValid;
+    return decoded.cmd;
+}
+
+void PipelinedCommander::OnQuit()
+{
+    Stop();
+}
+
+void PipelinedCommander::Start()
+{
+    if (m_started)
+        return;
+
+    m_started = true;
+    m_reader = std::thread(&PipelinedCommander::ReaderLoop, this);
+    m_parser = std::thread(&PipelinedCommander::ParserLoop, this);
+}
+
+void PipelinedCommander::Stop()
+{
+    m_stop.store(true, std::memory_order_relaxed);
+    if (m_reader.joinable())
+        m_reader.join();
+    if (m_parser.joinable())
+        m_parser.join();
+}
+
+void PipelinedCommander::ReaderLoop()
+{
+    InputChunk chunk;
+    for (;;)
+    {
+        chunk.data.resize(m_chunkSize);
+        const auto count = m_input != nullptr ? m_input->sgetn(chunk.data.data(), static_cast<std::streamsize>(m_chunkSize)) : 0;
+        chunk.size = count > 0 ? static_cast<size_t>(count) : 0;
+        chunk.last = chunk.size == 0;
+
+        // Pushing swaps in a recycled chunk, so whether this one was the last is checked before.
+        const auto last = chunk.last;
+        if (!Push(m_chunks, chunk) || last)
+            return;
+    }
+}
+
+void PipelinedCommander::ParserLoop()
+{
+    InputChunk chunk;
+    CommandBatch batch;
+    std::string partial;
+
+    const auto reset = [](CommandBatch& recycled) {
+        recycled.commands.resize(BatchSize);
+        recycled.count = 0;
+        recycled.text.clear();
+        recycled.last = false;
+    };
+
+    reset(batch);
+    for (;;)
+    {
+        if (!Pop(m_chunks, chunk))
+            return;
+
+        auto exited = false;
+        const char* begin = chunk.data.data();
+        const char* const end = begin + chunk.size;
+        while (begin != end && !exited)
+        {
+            const auto newline = FindNewline(begin, end);
+            if (newline == end && !chunk.last)
+            {
+                // The line goes on in the next chunk.
+                partial.append(begin, end);
+                break;
+            }
+
+            std::string_view line(begin, static_cast<size_t>(newline - begin));
+            if (!partial.empty())
+            {
+                partial.append(line);
+                line = partial;
+            }
+
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+
+            exited = Decode(line, batch) == cmdEXIT;
+            partial.clear();
+            begin = newline == end ? end : newline + 1;
+
+            if (batch.count == BatchSize && !exited)
+            {
+                if (!Push(m_batches, batch))
+                    return;
+
+                reset(batch);
+            }
+        }
+
+        if (chunk.last && !exited && !partial.empty())
+        {
+            std::string_view line(partial);
+            if (line.back() == '\r')
+                line.remove_suffix(1);
+
+            exited = Decode(line, batch) == cmdEXIT;
+        }
+
+        // A partly filled batch is handed over at the end of every chunk, rather than waiting for the next chunk.
+        const auto last = chunk.last || exited;
+        batch.last = last;
+        if (batch.count > 0 || last)
+        {
+            if (!Push(m_batches, batch) || last)
+                return;
+
+            reset(batch);
+        }
+    }
+}
+
+Command PipelinedCommander::Decode(std::string_view line, CommandBatch& batch)
+{
+    auto& decoded = batch.commands[batch.count++];
+    std::string_view args;
+    decoded.cmd = ParseCommand(line, args);
+    decoded.placeIsValid = false;
+    decoded.argsOffset = 0;
+    decoded.argsLength = 0;
+
+    if (decoded.cmd == cmdPLACE)
+    {
+        std::string error;
+        decoded.placeIsValid = TryParsePlace(args, decoded.place, error);
+        if (!decoded.placeIsValid)
+        {
+            decoded.argsOffset = batch.text.size();
+            decoded.argsLength = args.size();
+            batch.text.append(args);
+        }
+    }
+    else if (CommandProgram::IsBlockCommand(decoded.cmd))
+    {
+        decoded.argsOffset = batch.text.size();
+        decoded.argsLength = args.size();
+        batch.text.append(args);
+    }
+
+    return decoded.cmd;
+}
+
+template <typename T>
+bool PipelinedCommander::Push(SpscRingBuffer<T>& queue, T& value)
+{
+    unsigned attempts = 0;
+    while (!queue.TryPush(value))
+    {
+        if (m_stop.load(std::memory_order_relaxed))
+            return false;
+
+        Backoff(attempts);
+    }
+
+    return true;
+}
+
+template <typename T>
+bool PipelinedCommander::Pop(SpscRingBuffer<T>& queue, T& value)
+{
+    unsigned attempts = 0;
+    while (!queue.TryPop(value))
+    {
+        if (m_stop.load(std::memory_order_relaxed))
+            return false;
+
+        Backoff(attempts);
+    }
+
+    return true;
+}
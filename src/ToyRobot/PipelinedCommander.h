@@ -0,0 +1,157 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "Commander.h"
+#include "SpscRingBuffer.h"
+
+/// <summary>
+/// Commander overlapping the reading, the parsing and the execution of the commands on three threads.
+/// A reader thread reads the input in chunks, a parser thread splits them into lines and decodes them into
+/// fixed-size batches of commands, and the thread calling Launch executes the batches on the robot. The stages
+/// hand over through single-producer single-consumer ring buffers, and the chunks and batches go back and forth
+/// between them instead of being reallocated.
+/// Commands are executed and logged in input order, so the output is the one of the pipe or file commander.
+/// Give it an asynchronous logger such as FileLogger to move the writing of the output to a thread of its own.
+/// </summary>
+class PipelinedCommander : public CommanderBase
+{
+public:
+    static const size_t DefaultChunkSize = 64 * 1024;
+    static const size_t BatchSize = 1024;
+
+    /// <summary>
+    /// Read the commands from a stream, such as stdin, without prompts. The stream must outlive the commander.
+    /// </summary>
+    PipelinedCommander(std::istream& input, RobotRef robot, LoggerBase& logger, size_t chunkSize = DefaultChunkSize);
+
+    /// <summary>
+    /// Read the commands from a file, logging a prompt before every command as the file commander does.
+    /// </summary>
+    PipelinedCommander(const std::string& path, RobotRef robot, LoggerBase& logger);
+
+    /// <summary>
+    /// Copy constructor is not allowed
+    /// </summary>
+    PipelinedCommander(const PipelinedCommander&) = delete;
+
+    /// <summary>
+    /// Stop and join the reader and parser threads. A reader blocked on a stream that neither delivers data
+    /// nor ends is only joined once it does.
+    /// </summary>
+    ~PipelinedCommander();
+
+protected:
+    /// <summary>
+    /// Lines are never read here, the commands come decoded from the parser thread through GetCommand.
+    /// </summary>
+    bool TryReadLine(std::string_view& input) override;
+    Command GetCommand(std::string_view& args) override;
+    const PlaceArgs* ParsedPlace() const override { return m_placeIsValid ? &m_place : nullptr; }
+    void OnQuit() override;
+    bool ShowsPrompt() const override { return m_showsPrompt; }
+
+private:
+    /// <summary>
+    /// Bytes of the input read in one go. The last chunk is empty.
+    /// </summary>
+    struct InputChunk
+    {
+        std::vector<char> data;
+        size_t size = 0;
+        bool last = false;
+    };
+
+    /// <summary>
+    /// A command as the executor needs it. The raw arguments of a PLACE that does not parse are kept in the
+    /// text of the batch, so the executor logs the same error as the other commanders. So are the arguments
+    /// of a block command, which the executor compiles.
+    /// </summary>
+    struct DecodedCommand
+    {
+        Command cmd = cmdUNKNOWN;
+        bool placeIsValid = false;
+        PlaceArgs place;
+        size_t argsOffset = 0;
+        size_t argsLength = 0;
+    };
+
+    struct CommandBatch
+    {
+        std::vector<DecodedCommand> commands;
+        size_t count = 0;
+        std::string text;
+
+        /// <summary>
+        /// No batch follows, because the input ended or an EXIT was decoded.
+        /// </summary>
+        bool last = false;
+    };
+
+    void Start();
+    void Stop();
+    void ReaderLoop();
+    void ParserLoop();
+
+    /// <summary>
+    /// Decode a line into the next slot of the batch.
+    /// </summary>
+    /// <returns>The command</returns>
+    static Command Decode(std::string_view line, CommandBatch& batch);
+
+    /// <summary>
+    /// Hand a value to the next stage, waiting while its queue is full.
+    /// </summary>
+    /// <returns>[true] Value is pushed. [false] The commander is stopping.</returns>
+    template <typename T>
+    bool Push(SpscRingBuffer<T>& queue, T& value);
+
+    /// <summary>
+    /// Take a value from the previous stage, waiting while its queue is empty.
+    /// </summary>
+    /// <returns>[true] Value is popped. [false] The commander is stopping.</returns>
+    template <typename T>
+    bool Pop(SpscRingBuffer<T>& queue, T& value);
+
+    std::ifstream m_file;
+    std::streambuf* m_input;
+    const size_t m_chunkSize;
+    const bool m_showsPrompt;
+
+    SpscRingBuffer<InputChunk> m_chunks;
+    SpscRingBuffer<CommandBatch> m_batches;
+    std::atomic<bool> m_stop{ false };
+    bool m_started = false;
+    std::thread m_reader;
+    std::thread m_parser;
+
+    CommandBatch m_batch;
+    size_t m_next = 0;
+    PlaceArgs m_place;
+    bool m_placeIsValid = false;
+};
@@ -0,0 +1,216 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ResultSink.h"
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <string_view>
+
+namespace
+{
+    const char* const FacingDirectionNames[] = { "UNKNOWN", "NORTH", "SOUTH", "EAST", "WEST" };
+    const size_t FacingDirectionLengths[] = { 7, 5, 5, 4, 4 };
+
+    const char CsvHeader[] = "x,y,facing\n";
+
+    bool TryParseDirection(std::string_view name, FacingDirection& facingDirection)
+    {
+        for (uint8_t idx = fdUNKNOWN; idx <= fdWEST; idx++)
+        {
+            if (name == FacingDirectionNames[idx])
+            {
+                facingDirection = static_cast<FacingDirection>(idx);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool TryParseRow(std::string_view row, ResultRecord& record)
+    {
+        const auto end = row.data() + row.size();
+        const auto xresult = std::from_chars(row.data(), end, record.x);
+        if (xresult.ec != std::errc() || xresult.ptr == end || *xresult.ptr != ',')
+            return false;
+
+        const auto yresult = std::from_chars(xresult.ptr + 1, end, record.y);
+        if (yresult.ec != std::errc() || yresult.ptr == end || *yresult.ptr != ',')
+            return false;
+
+        return TryParseDirection(std::string_view(yresult.ptr + 1, end - yresult.ptr - 1), record.facingDirection);
+    }
+}
+
+size_t FormatPosition(char* buffer, uint64_t x, uint64_t y, FacingDirection facingDirection)
+{
+    const auto direction = facingDirection <= fdWEST ? facingDirection : fdUNKNOWN;
+
+    auto pos = std::to_chars(buffer, buffer + 20, x).ptr;
+    *pos++ = ',';
+    pos = std::to_chars(pos, pos + 20, y).ptr;
+    *pos++ = ',';
+    std::memcpy(pos, FacingDirectionNames[direction], FacingDirectionLengths[direction]);
+
+    return static_cast<size_t>(pos - buffer) + FacingDirectionLengths[direction];
+}
+
+ResultSink::ResultSink(const std::string& path, ResultFormat format, ResultOpenMode mode, size_t bufferSize)
+    : m_format(format),
+    m_buffer(bufferSize < MaxRecordLength ? MaxRecordLength : bufferSize)
+{
+    if (mode == roCONTINUE)
+    {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(path, ec);
+        m_flushedSize = ec ? 0 : size;
+    }
+
+    // Records reach the file in whole buffers, a second buffer in the stream would only copy them again.
+    m_file.rdbuf()->pubsetbuf(nullptr, 0);
+    m_file.open(path, std::ios::binary | (mode == roCONTINUE ? std::ios::app : std::ios::trunc));
+    if (m_file.is_open())
+        m_stream = &m_file;
+
+    if (m_flushedSize == 0)
+        WriteHeader();
+}
+
+ResultSink::ResultSink(std::ostream& stream, ResultFormat format, size_t bufferSize)
+    : m_stream(&stream),
+    m_format(format),
+    m_buffer(bufferSize < MaxRecordLength ? MaxRecordLength : bufferSize)
+{
+    WriteHeader();
+}
+
+ResultSink::~ResultSink()
+{
+    Flush();
+}
+
+void ResultSink::Flush()
+{
+    if (m_stream != nullptr && m_used != 0)
+    {
+        m_stream->write(m_buffer.data(), static_cast<std::streamsize>(m_used));
+        m_stream->flush();
+        m_flushedSize += m_used;
+    }
+
+    m_used = 0;
+}
+
+bool ResultSink::TryReadFile(const std::string& path, std::vector<ResultRecord>& records, std::string& error)
+{
+    records.clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        error = "Unable to open the result file: " + path;
+        return false;
+    }
+
+    const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() >= ResultHeaderSize && std::memcmp(data.data(), ResultMagic, sizeof(ResultMagic)) == 0)
+    {
+        if (static_cast<uint8_t>(data[sizeof(ResultMagic)]) != ResultVersion || (data.size() - ResultHeaderSize) % ResultRecordSize != 0)
+        {
+            error = "Unsupported or truncated result file: " + path;
+            return false;
+        }
+
+        for (size_t pos = ResultHeaderSize; pos < data.size(); pos += ResultRecordSize)
+        {
+            ResultRecord record;
+            std::memcpy(&record.x, data.data() + pos, sizeof(uint64_t));
+            std::memcpy(&record.y, data.data() + pos + sizeof(uint64_t), sizeof(uint64_t));
+            record.facingDirection = static_cast<FacingDirection>(data[pos + 2 * sizeof(uint64_t)]);
+            records.push_back(record);
+        }
+
+        return true;
+    }
+
+    const std::string_view text(data);
+    if (text.compare(0, sizeof(CsvHeader) - 1, CsvHeader) != 0)
+    {
+        error = "Not a result file: " + path;
+        return false;
+    }
+
+    size_t pos = sizeof(CsvHeader) - 1;
+    while (pos < text.size())
+    {
+        const auto end = text.find('\n', pos);
+        if (end == std::string_view::npos)
+        {
+            error = "Truncated result file: " + path;
+            return false;
+        }
+
+        ResultRecord record;
+        if (!TryParseRow(text.substr(pos, end - pos), record))
+        {
+            error = "Invalid record in the result file: " + std::string(text.substr(pos, end - pos));
+            return false;
+        }
+
+        records.push_back(record);
+        pos = end + 1;
+    }
+
+    return true;
+}
+
+void ResultSink::WriteHeader()
+{
+    if (m_format == rfBINARY)
+    {
+        std::memcpy(m_buffer.data(), ResultMagic, sizeof(ResultMagic));
+        m_buffer[sizeof(ResultMagic)] = static_cast<char>(ResultVersion);
+        m_used = ResultHeaderSize;
+    }
+    else
+    {
+        std::memcpy(m_buffer.data(), CsvHeader, sizeof(CsvHeader) - 1);
+        m_used = sizeof(CsvHeader) - 1;
+    }
+}
+
+size_t ResultSink::EncodeRecord(char* buffer, uint64_t x, uint64_t y, FacingDirection facingDirection)
+{
+    std::memcpy(buffer, &x, sizeof(x));
+    std::memcpy(buffer + sizeof(x), &y, sizeof(y));
+    buffer[2 * sizeof(uint64_t)] = static_cast<char>(facingDirection);
+
+    return ResultRecordSize;
+}
+
+size_t ResultSink::FormatRow(char* buffer, uint64_t x, uint64_t y, FacingDirection facingDirection)
+{
+    const auto length = FormatPosition(buffer, x, y, facingDirection);
+    buffer[length] = '\n';
+
+    return length + 1;
+}
@@ -0,0 +1,172 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <fstream>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "FacingDirection.h"
+
+/// <summary>
+/// Format of the records written by a result sink.
+/// </summary>
+enum ResultFormat
+{
+    rfCSV = 0,
+    rfBINARY = 1
+};
+
+/// <summary>
+/// How a result sink opens its file.
+/// </summary>
+enum ResultOpenMode
+{
+    roREPLACE = 0,
+    roCONTINUE = 1
+};
+
+/// <summary>
+/// Binary result file (--results-format=binary).
+///
+/// The file starts with the "TRR" magic and a version byte. Every REPORT follows as a fixed 17 byte record:
+/// the x and y coordinates as 64 bit integers in the byte order of the machine, then the facing direction byte.
+/// </summary>
+const char ResultMagic[3] = { 'T', 'R', 'R' };
+const uint8_t ResultVersion = 1;
+const size_t ResultHeaderSize = sizeof(ResultMagic) + 1;
+const size_t ResultRecordSize = 2 * sizeof(uint64_t) + 1;
+
+/// <summary>
+/// Longest text of a position, "x,y,DIRECTION" with both coordinates at 20 digits.
+/// </summary>
+const size_t MaxPositionLength = 2 * 20 + 2 + 7;
+
+/// <summary>
+/// Write the position in the form of "x,y,NORTH", as REPORT prints it.
+/// </summary>
+/// <param name="buffer">Output buffer of at least MaxPositionLength characters</param>
+/// <returns>Number of characters written</returns>
+size_t FormatPosition(char* buffer, uint64_t x, uint64_t y, FacingDirection facingDirection);
+
+/// <summary>
+/// A single REPORT read back from a result file.
+/// </summary>
+struct ResultRecord
+{
+    uint64_t x = 0;
+    uint64_t y = 0;
+    FacingDirection facingDirection = fdUNKNOWN;
+};
+
+/// <summary>
+/// Machine readable destination of the REPORT results, kept apart from the log.
+/// Records are formatted straight into a buffer without timestamps or levels, and the buffer is written out
+/// in one call once it fills up, on Flush and when the sink is destroyed. The CSV format starts with the
+/// "x,y,facing" header line, followed by one "x,y,NORTH" line per record.
+/// </summary>
+class ResultSink
+{
+public:
+    static const size_t DefaultBufferSize = 64 * 1024;
+
+    /// <summary>
+    /// Write the records to a file, replacing it.
+    /// </summary>
+    ResultSink(const std::string& path, ResultFormat format, size_t bufferSize = DefaultBufferSize)
+        : ResultSink(path, format, roREPLACE, bufferSize)
+    {}
+
+    /// <summary>
+    /// Write the records to a file, replacing it or adding to its end, e.g. when resuming a journaled run.
+    /// The header is only written to an empty file.
+    /// </summary>
+    ResultSink(const std::string& path, ResultFormat format, ResultOpenMode mode, size_t bufferSize = DefaultBufferSize);
+
+    /// <summary>
+    /// Write the records to a stream. The stream must outlive the sink.
+    /// </summary>
+    ResultSink(std::ostream& stream, ResultFormat format, size_t bufferSize = DefaultBufferSize);
+
+    /// <summary>
+    /// Copy constructor is not allowed
+    /// </summary>
+    ResultSink(const ResultSink&) = delete;
+
+    ~ResultSink();
+
+    /// <summary>
+    /// Whether the output file could be created.
+    /// </summary>
+    bool IsOpen() const { return m_stream != nullptr; }
+
+    /// <summary>
+    /// Append a record.
+    /// </summary>
+    void Write(uint64_t x, uint64_t y, FacingDirection facingDirection)
+    {
+        if (m_buffer.size() - m_used < MaxRecordLength)
+            Flush();
+
+        m_used += m_format == rfBINARY
+            ? EncodeRecord(m_buffer.data() + m_used, x, y, facingDirection)
+            : FormatRow(m_buffer.data() + m_used, x, y, facingDirection);
+        m_recordCount++;
+    }
+
+    /// <summary>
+    /// Write the buffered records to the output.
+    /// </summary>
+    void Flush();
+
+    ResultFormat Format() const { return m_format; }
+    uint64_t RecordCount() const { return m_recordCount; }
+
+    /// <summary>
+    /// Size of the output written out so far, including what a continued file held before. Buffered records are not counted.
+    /// </summary>
+    uint64_t FlushedSize() const { return m_flushedSize; }
+
+    /// <summary>
+    /// Try to read back the records of a result file of either format.
+    /// </summary>
+    /// <returns>[true] File is read. [false] File can not be read, or is not a complete result file.</returns>
+    static bool TryReadFile(const std::string& path, std::vector<ResultRecord>& records, std::string& error);
+
+private:
+    /// <summary>
+    /// Longest record of either format, a CSV row with its line break.
+    /// </summary>
+    static constexpr size_t MaxRecordLength = MaxPositionLength + 1;
+
+    void WriteHeader();
+    static size_t EncodeRecord(char* buffer, uint64_t x, uint64_t y, FacingDirection facingDirection);
+    static size_t FormatRow(char* buffer, uint64_t x, uint64_t y, FacingDirection facingDirection);
+
+    std::ofstream m_file;
+    std::ostream* m_stream = nullptr;
+    ResultFormat m_format;
+    std::vector<char> m_buffer;
+    size_t m_used = 0;
+    uint64_t m_recordCount = 0;
+    uint64_t m_flushedSize = 0;
+};
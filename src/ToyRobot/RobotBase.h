@@ -0,0 +1,67 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "FacingDirection.h"
+
+/// <summary>
+/// Complete state of a robot, as saved in journal checkpoints.
+/// </summary>
+struct RobotState
+{
+	uint64_t x = 0;
+	uint64_t y = 0;
+	FacingDirection facingDirection = fdUNKNOWN;
+	bool placed = false;
+};
+
+/// <summary>
+/// Interface of a robot independent of the board it is placed on, for the journal and for robots chosen at runtime.
+/// Commanders call a robot of a known type directly, see RobotRef.
+/// Coordinates are passed as 64 bit integers. Out of range values are rejected by the robot, not truncated.
+/// </summary>
+class RobotBase
+{
+public:
+	virtual ~RobotBase() = default;
+
+	virtual bool TryPlace(int64_t x, int64_t y, FacingDirection facingDirection) = 0;
+	virtual bool TryMove() = 0;
+	virtual bool TryTurnRight() = 0;
+	virtual bool TryTurnLeft() = 0;
+
+	/// <summary>
+	/// Current position and facing direction, widened to 64 bits.
+	/// </summary>
+	virtual void ReportPosition(uint64_t& x, uint64_t& y, FacingDirection& facingDirection) const = 0;
+
+	/// <summary>
+	/// Snapshot of the position, facing direction and whether the robot is placed.
+	/// </summary>
+	virtual RobotState SaveState() const = 0;
+
+	/// <summary>
+	/// Put the robot back into a saved state.
+	/// </summary>
+	/// <returns>[true] State is restored. [false] The position is off the board or occupied, the robot is unchanged.</returns>
+	virtual bool TryRestoreState(const RobotState& state) = 0;
+};
\ No newline at end of file
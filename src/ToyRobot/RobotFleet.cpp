@@ -0,0 +1,209 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "RobotFleet.h"
+
+RobotFleet::RobotFleet(size_t size):
+	m_x(size, 0),
+	m_y(size, 0),
+	m_facingDirection(size, fdUNKNOWN),
+	m_placed(size, 0)
+{
+}
+
+RobotResult RobotFleet::Place(size_t robot, uint8_t x, uint8_t y, FacingDirection facingDirection)
+{
+	if (m_placed[robot])
+		return rrALREADY_PLACED;
+
+	if (x > m_xmax)
+		return rrINVALID_X;
+
+	if (y > m_ymax)
+		return rrINVALID_Y;
+
+	m_x[robot] = x;
+	m_y[robot] = y;
+	m_facingDirection[robot] = static_cast<uint8_t>(facingDirection);
+	m_placed[robot] = 1;
+
+	return rrSUCCESS;
+}
+
+size_t RobotFleet::Place(const uint8_t* __restrict xs, const uint8_t* __restrict ys, const uint8_t* __restrict facingDirections, uint8_t* __restrict results)
+{
+	const auto count = Size();
+	const auto xmax = m_xmax;
+	const auto ymax = m_ymax;
+	auto* __restrict x = m_x.data();
+	auto* __restrict y = m_y.data();
+	auto* __restrict facingDirection = m_facingDirection.data();
+	auto* __restrict placed = m_placed.data();
+
+	uint32_t succeeded = 0;
+	for (size_t idx = 0; idx < count; idx++)
+	{
+		const uint8_t result = LaneSelect(placed[idx], rrALREADY_PLACED,
+			LaneSelect(xs[idx] > xmax, rrINVALID_X,
+			LaneSelect(ys[idx] > ymax, rrINVALID_Y, rrSUCCESS)));
+		const uint8_t ok = result == rrSUCCESS;
+
+		x[idx] = LaneSelect(ok, xs[idx], x[idx]);
+		y[idx] = LaneSelect(ok, ys[idx], y[idx]);
+		facingDirection[idx] = LaneSelect(ok, facingDirections[idx], facingDirection[idx]);
+		placed[idx] = placed[idx] | ok;
+
+		results[idx] = result;
+		succeeded += ok;
+	}
+
+	return succeeded;
+}
+
+size_t RobotFleet::Move(uint8_t* __restrict results)
+{
+	const auto count = Size();
+	const auto xmax = m_xmax;
+	const auto ymax = m_ymax;
+	auto* __restrict x = m_x.data();
+	auto* __restrict y = m_y.data();
+	const auto* __restrict facingDirection = m_facingDirection.data();
+	const auto* __restrict placed = m_placed.data();
+
+	uint32_t succeeded = 0;
+	for (size_t idx = 0; idx < count; idx++)
+	{
+		const auto direction = facingDirection[idx];
+		const uint8_t nextX = x[idx] + LaneDeltaX(direction);
+		const uint8_t nextY = y[idx] + LaneDeltaY(direction);
+		const uint8_t inside = (nextX <= xmax) & (nextY <= ymax) & LaneIsKnown(direction);
+		const uint8_t ok = placed[idx] & inside;
+
+		x[idx] = LaneSelect(ok, nextX, x[idx]);
+		y[idx] = LaneSelect(ok, nextY, y[idx]);
+
+		results[idx] = LaneSelect(placed[idx], LaneSelect(inside, rrSUCCESS, LaneBlockedResult(direction)), rrNOT_PLACED);
+		succeeded += ok;
+	}
+
+	return succeeded;
+}
+
+size_t RobotFleet::TurnLeft(uint8_t* results)
+{
+	return Turn(true, results);
+}
+
+size_t RobotFleet::TurnRight(uint8_t* results)
+{
+	return Turn(false, results);
+}
+
+size_t RobotFleet::Turn(bool left, uint8_t* __restrict results)
+{
+	const auto count = Size();
+	auto* __restrict facingDirection = m_facingDirection.data();
+	const auto* __restrict placed = m_placed.data();
+
+	uint32_t succeeded = 0;
+	for (size_t idx = 0; idx < count; idx++)
+	{
+		const auto direction = facingDirection[idx];
+		const uint8_t known = LaneIsKnown(direction);
+		const uint8_t ok = placed[idx] & known;
+
+		const auto turned = LaneSelect(left, LaneLeftOf(direction), LaneRightOf(direction));
+		facingDirection[idx] = LaneSelect(ok, turned, direction);
+
+		results[idx] = LaneSelect(placed[idx], LaneSelect(known, rrSUCCESS, rrUNKNOWN_DIRECTION), rrNOT_PLACED);
+		succeeded += ok;
+	}
+
+	return succeeded;
+}
+
+size_t RobotFleet::Step(const uint8_t* __restrict commands, uint8_t* __restrict results)
+{
+	const auto count = Size();
+	const auto xmax = m_xmax;
+	const auto ymax = m_ymax;
+	auto* __restrict x = m_x.data();
+	auto* __restrict y = m_y.data();
+	auto* __restrict facingDirection = m_facingDirection.data();
+	const auto* __restrict placed = m_placed.data();
+
+	uint32_t succeeded = 0;
+	for (size_t idx = 0; idx < count; idx++)
+	{
+		const auto command = commands[idx];
+		const uint8_t isMove = command == cmdMOVE;
+		const uint8_t isLeft = command == cmdTURN_LEFT;
+		const uint8_t isTurn = isLeft | (command == cmdTURN_RIGHT);
+
+		const auto direction = facingDirection[idx];
+		const uint8_t known = LaneIsKnown(direction);
+		const uint8_t nextX = x[idx] + LaneDeltaX(direction);
+		const uint8_t nextY = y[idx] + LaneDeltaY(direction);
+		const uint8_t inside = (nextX <= xmax) & (nextY <= ymax) & known;
+		const uint8_t moved = isMove & placed[idx] & inside;
+		const uint8_t turned = isTurn & placed[idx] & known;
+
+		x[idx] = LaneSelect(moved, nextX, x[idx]);
+		y[idx] = LaneSelect(moved, nextY, y[idx]);
+		facingDirection[idx] = LaneSelect(turned, LaneSelect(isLeft, LaneLeftOf(direction), LaneRightOf(direction)), direction);
+
+		const uint8_t outcome = LaneSelect(isMove,
+			LaneSelect(inside, rrSUCCESS, LaneBlockedResult(direction)),
+			LaneSelect(known, rrSUCCESS, rrUNKNOWN_DIRECTION));
+		const uint8_t result = LaneSelect(isMove | isTurn, LaneSelect(placed[idx], outcome, rrNOT_PLACED), rrSUCCESS);
+
+		results[idx] = result;
+		succeeded += result == rrSUCCESS;
+	}
+
+	return succeeded;
+}
+
+bool RobotFleet::Report(size_t robot, uint8_t& x, uint8_t& y, FacingDirection& facingDirection) const
+{
+	if (!m_placed[robot])
+		return false;
+
+	x = m_x[robot];
+	y = m_y[robot];
+	facingDirection = static_cast<FacingDirection>(m_facingDirection[robot]);
+
+	return true;
+}
+
+void RobotFleet::ToSuccessMask(const uint8_t* results, size_t count, uint64_t* mask)
+{
+	for (size_t word = 0; word * 64 < count; word++)
+	{
+		const auto begin = word * 64;
+		const auto end = begin + 64 < count ? begin + 64 : count;
+
+		uint64_t bits = 0;
+		for (auto idx = begin; idx < end; idx++)
+			bits |= static_cast<uint64_t>(results[idx] == rrSUCCESS) << (idx - begin);
+
+		mask[word] = bits;
+	}
+}
@@ -0,0 +1,119 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "Board.h"
+#include "Commands.h"
+#include "FacingDirection.h"
+#include "RobotResult.h"
+#include "RobotTables.h"
+
+/// <summary>
+/// Simulates many robots at once, with the same rules as ToyRobot.
+/// The state of the fleet is kept in separate arrays (x, y, direction and placed flag), so that whole fleet
+/// steps walk contiguous memory and can be vectorised by the compiler.
+/// Results are reported as arrays of RobotResult codes (one byte per robot) instead of log messages.
+/// </summary>
+class RobotFleet
+{
+public:
+	/// <summary>
+	/// Create a fleet of robots that are not placed yet.
+	/// </summary>
+	/// <param name="size">Number of robots</param>
+	explicit RobotFleet(size_t size);
+
+	size_t Size() const { return m_placed.size(); }
+
+	/// <summary>
+	/// Place a single robot. Same rules as ToyRobot::Place.
+	/// </summary>
+	RobotResult Place(size_t robot, uint8_t x, uint8_t y, FacingDirection facingDirection);
+
+	/// <summary>
+	/// Place every robot of the fleet.
+	/// </summary>
+	/// <param name="xs">X coordinate per robot</param>
+	/// <param name="ys">Y coordinate per robot</param>
+	/// <param name="facingDirections">Facing direction per robot (FacingDirection values)</param>
+	/// <param name="results">Receives the RobotResult of each robot</param>
+	/// <returns>Number of robots placed successfully</returns>
+	size_t Place(const uint8_t* xs, const uint8_t* ys, const uint8_t* facingDirections, uint8_t* results);
+
+	/// <summary>
+	/// Move every robot one unit forward.
+	/// </summary>
+	/// <param name="results">Receives the RobotResult of each robot</param>
+	/// <returns>Number of robots moved</returns>
+	size_t Move(uint8_t* results);
+
+	/// <summary>
+	/// Turn every robot 90 degrees to the left.
+	/// </summary>
+	size_t TurnLeft(uint8_t* results);
+
+	/// <summary>
+	/// Turn every robot 90 degrees to the right.
+	/// </summary>
+	size_t TurnRight(uint8_t* results);
+
+	/// <summary>
+	/// Apply one command per robot. MOVE, LEFT and RIGHT are applied; any other command leaves the robot
+	/// unchanged and reports rrSUCCESS (PLACE needs coordinates and goes through Place).
+	/// </summary>
+	/// <param name="commands">Command per robot (Command values)</param>
+	/// <param name="results">Receives the RobotResult of each robot</param>
+	/// <returns>Number of robots that succeeded</returns>
+	size_t Step(const uint8_t* commands, uint8_t* results);
+
+	/// <summary>
+	/// Get the position of a single robot.
+	/// </summary>
+	/// <returns>[true] Robot is placed. [false] Robot is not placed yet and the output is not set</returns>
+	bool Report(size_t robot, uint8_t& x, uint8_t& y, FacingDirection& facingDirection) const;
+
+	/// <summary>
+	/// Pack results into a bitmask, one bit per robot, set when the result is rrSUCCESS.
+	/// </summary>
+	/// <param name="results">Result per robot</param>
+	/// <param name="count">Number of results</param>
+	/// <param name="mask">Receives (count + 63) / 64 words</param>
+	static void ToSuccessMask(const uint8_t* results, size_t count, uint64_t* mask);
+
+	const uint8_t* X() const { return m_x.data(); }
+	const uint8_t* Y() const { return m_y.data(); }
+	const uint8_t* FacingDirections() const { return m_facingDirection.data(); }
+	const uint8_t* Placed() const { return m_placed.data(); }
+
+private:
+	size_t Turn(bool left, uint8_t* results);
+
+	std::vector<uint8_t> m_x;
+	std::vector<uint8_t> m_y;
+	std::vector<uint8_t> m_facingDirection;
+	std::vector<uint8_t> m_placed;
+
+	const uint8_t m_xmax = DefaultBoard::MaxX();
+	const uint8_t m_ymax = DefaultBoard::MaxY();
+};
@@ -0,0 +1,627 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "RobotServer.h"
+#include "Commander.h"
+#include "LineScanner.h"
+#include "ToyRobot.h"
+#include <cstring>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    /// <summary>
+    /// Logger of a session, appending the records to the session's output buffer.
+    /// </summary>
+    class SessionLogger : public LoggerBase
+    {
+    public:
+        explicit SessionLogger(std::string& output)
+            : m_output(output)
+        {}
+
+    protected:
+        void Print(std::string_view msgType, std::string_view msg, std::string_view end) override
+        {
+            m_output.append(FormatLogMsg(msgType, msg)).append(end);
+        }
+
+    private:
+        std::string& m_output;
+    };
+
+    /// <summary>
+    /// Commander of a session. Lines are handed over by the event loop as they arrive.
+    /// </summary>
+    class SessionCommander : public CommanderBase
+    {
+    public:
+        SessionCommander(RobotRef robot, LoggerBase& logger)
+            : CommanderBase(robot, logger)
+        {}
+
+        Command ExecuteLine(std::string_view line)
+        {
+            std::string_view args;
+            if constexpr (StatsEnabled)
+            {
+                const auto start = CommandStats::Ticks();
+                const auto cmd = ParseCommand(line, args);
+                ExecuteMeasured(cmd, args, start, start, CommandStats::Ticks());
+                return cmd;
+            }
+            else
+            {
+                const auto cmd = ParseCommand(line, args);
+                Execute(cmd, args);
+                return cmd;
+            }
+        }
+
+    protected:
+        bool TryReadLine(std::string_view& /*input*/) override
+        {
+            return false;
+        }
+    };
+
+    /// <summary>
+    /// State of one client connection.
+    /// </summary>
+    struct Session
+    {
+        Session(int socket, LogLevel level)
+            : socket(socket),
+            logger(output),
+            robot(logger),
+            statementRunner(robot),
+            commander(robot, logger)
+        {
+            logger.SetLevel(level);
+            commander.SetStatementRunner(&statementRunner);
+        }
+
+        int socket;
+
+        /// <summary>
+        /// Start of a line whose end has not arrived yet.
+        /// </summary>
+        std::string input;
+
+        /// <summary>
+        /// Output not sent yet, from outputSent on.
+        /// </summary>
+        std::string output;
+        size_t outputSent = 0;
+
+        SessionLogger logger;
+        ToyRobot robot;
+        StatementRunner<ToyRobot> statementRunner;
+        SessionCommander commander;
+
+        /// <summary>
+        /// The client sent EXIT or closed its side. The session is closed once its output is sent.
+        /// </summary>
+        bool closing = false;
+        uint32_t events = 0;
+    };
+}
+
+bool TryResolveServerAddress(const std::string& address, ServerAddress& resolved, std::string& error)
+{
+    if (address.rfind("unix:", 0) == 0)
+    {
+        const auto path = address.substr(5);
+        sockaddr_un unixAddress{};
+        if (path.empty() || path.size() >= sizeof(unixAddress.sun_path))
+        {
+            error = "Invalid unix socket path: " + path;
+            return false;
+        }
+
+        unixAddress.sun_family = AF_UNIX;
+        std::memcpy(unixAddress.sun_path, path.data(), path.size());
+        std::memcpy(resolved.storage, &unixAddress, sizeof(unixAddress));
+        resolved.family = AF_UNIX;
+        resolved.length = sizeof(unixAddress);
+        return true;
+    }
+
+    const auto separator = address.rfind(':');
+    if (address.rfind("tcp:", 0) != 0 || separator < 4)
+    {
+        error = "Invalid server address: " + address + ". Expected tcp:host:port or unix:path.";
+        return false;
+    }
+
+    auto host = address.substr(4, separator - 4);
+    const auto port = address.substr(separator + 1);
+    if (port.empty() || port.size() > 5 || port.find_first_not_of("0123456789") != std::string::npos || std::stoul(port) > UINT16_MAX)
+    {
+        error = "Invalid port of the server address: " + address;
+        return false;
+    }
+
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']')
+        host = host.substr(1, host.size() - 2);
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    addrinfo* results = nullptr;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &results) != 0 || results == nullptr)
+    {
+        error = "Unable to resolve the server address: " + address;
+        return false;
+    }
+
+    std::memcpy(resolved.storage, results->ai_addr, results->ai_addrlen);
+    resolved.family = results->ai_family;
+    resolved.length = static_cast<uint32_t>(results->ai_addrlen);
+    freeaddrinfo(results);
+    return true;
+}
+
+class RobotServer::EventLoop
+{
+public:
+    EventLoop(RobotServer& server)
+        : m_server(server),
+        m_epoll(epoll_create1(EPOLL_CLOEXEC)),
+        m_wake(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+        m_readBuffer(64 * 1024)
+    {
+        // Every loop waits on the listening socket. EPOLLEXCLUSIVE wakes only one of them per connection.
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLEXCLUSIVE;
+        event.data.ptr = nullptr;
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_server.m_listenSocket, &event);
+
+        event.events = EPOLLIN;
+        event.data.ptr = this;
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wake, &event);
+    }
+
+    ~EventLoop()
+    {
+        for (auto& entry : m_sessions)
+            close(entry.first);
+
+        m_server.m_counters.activeSessions -= m_sessions.size();
+        close(m_wake);
+        close(m_epoll);
+    }
+
+    EventLoop(const EventLoop&) = delete;
+
+    bool IsValid() const { return m_epoll >= 0 && m_wake >= 0; }
+
+    void Run()
+    {
+        epoll_event events[256];
+        for (;;)
+        {
+            const auto count = epoll_wait(m_epoll, events, 256, -1);
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return;
+            }
+
+            for (int idx = 0; idx < count; idx++)
+            {
+                const auto& event = events[idx];
+                if (event.data.ptr == nullptr)
+                {
+                    Accept();
+                    continue;
+                }
+
+                if (event.data.ptr == this)
+                    return;
+
+                auto& session = *static_cast<Session*>(event.data.ptr);
+                auto open = (event.events & EPOLLERR) == 0;
+                if (open && (event.events & (EPOLLIN | EPOLLHUP)) != 0)
+                    open = Read(session);
+                if (open)
+                    open = Flush(session);
+                if (!open)
+                    Close(session);
+            }
+        }
+    }
+
+    void Wake()
+    {
+        const uint64_t one = 1;
+        [[maybe_unused]] const auto written = write(m_wake, &one, sizeof(one));
+    }
+
+private:
+    /// <summary>
+    /// Accept a few pending connections. The rest are left to the next wake up, possibly of another loop,
+    /// so that a burst of connections is spread over the loops.
+    /// </summary>
+    void Accept()
+    {
+        for (int idx = 0; idx < 32; idx++)
+        {
+            const auto socket = accept4(m_server.m_listenSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (socket < 0)
+                return;
+
+            if (m_server.m_tcp)
+            {
+                // Answers are small and come in request order, do not hold them back.
+                const int noDelay = 1;
+                setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            }
+
+            auto session = std::make_unique<Session>(socket, m_server.m_options.logLevel);
+            session->events = EPOLLIN;
+
+            epoll_event event{};
+            event.events = session->events;
+            event.data.ptr = session.get();
+            if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &event) != 0)
+            {
+                close(socket);
+                continue;
+            }
+
+            m_sessions.emplace(socket, std::move(session));
+            m_server.m_counters.sessions++;
+            m_server.m_counters.activeSessions++;
+        }
+    }
+
+    /// <summary>
+    /// Read what the client sent and execute the complete lines.
+    /// </summary>
+    /// <returns>[true] Session stays open. [false] Session is to be closed.</returns>
+    bool Read(Session& session)
+    {
+        if (session.closing)
+            return true;
+
+        const auto count = read(session.socket, m_readBuffer.data(), m_readBuffer.size());
+        if (count < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+        if (count == 0)
+        {
+            // The client is done sending. Answer what it sent before closing, including a last line without a line break.
+            if (!session.input.empty() && Execute(session, session.input))
+                session.input.clear();
+
+            session.closing = true;
+            return true;
+        }
+
+        m_server.m_counters.bytesIn += static_cast<uint64_t>(count);
+
+        // Lines are executed straight from the read buffer. Only a line split over two reads is copied.
+        const char* begin = m_readBuffer.data();
+        const char* const end = begin + count;
+        if (!session.input.empty())
+        {
+            const auto newline = FindNewline(begin, end);
+            session.input.append(begin, newline);
+            if (newline == end)
+                return session.input.size() <= m_server.m_options.maxLineLength;
+
+            begin = newline + 1;
+            if (!Execute(session, session.input))
+                return true;
+
+            session.input.clear();
+        }
+
+        while (begin != end)
+        {
+            const auto newline = FindNewline(begin, end);
+            if (newline == end)
+            {
+                session.input.assign(begin, end);
+                return session.input.size() <= m_server.m_options.maxLineLength;
+            }
+
+            const std::string_view line(begin, newline - begin);
+            begin = newline + 1;
+            if (!Execute(session, line))
+                return true;
+        }
+
+        return true;
+    }
+
+    /// <summary>
+    /// Execute one line of the session.
+    /// </summary>
+    /// <returns>[true] Session takes more commands. [false] Session quit.</returns>
+    bool Execute(Session& session, std::string_view line)
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+
+        m_server.m_counters.commands++;
+        if (session.commander.ExecuteLine(line) != cmdEXIT)
+            return true;
+
+        session.closing = true;
+        session.input.clear();
+        return false;
+    }
+
+    /// <summary>
+    /// Send as much of the pending output as the socket takes, and wait for the events the session needs next.
+    /// </summary>
+    /// <returns>[true] Session stays open. [false] Session is to be closed.</returns>
+    bool Flush(Session& session)
+    {
+        while (session.outputSent < session.output.size())
+        {
+            const auto count = send(session.socket, session.output.data() + session.outputSent,
+                session.output.size() - session.outputSent, MSG_NOSIGNAL);
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    break;
+                return false;
+            }
+
+            session.outputSent += static_cast<size_t>(count);
+            m_server.m_counters.bytesOut += static_cast<uint64_t>(count);
+        }
+
+        const auto pending = session.output.size() - session.outputSent;
+        if (pending == 0)
+        {
+            session.output.clear();
+            session.outputSent = 0;
+            if (session.closing)
+                return false;
+        }
+        else if (session.outputSent >= pending)
+        {
+            session.output.erase(0, session.outputSent);
+            session.outputSent = 0;
+        }
+
+        uint32_t events = 0;
+        if (!session.closing && pending <= m_server.m_options.maxPendingOutput)
+            events |= EPOLLIN;
+        if (pending > 0)
+            events |= EPOLLOUT;
+
+        if (events != session.events)
+        {
+            epoll_event event{};
+            event.events = events;
+            event.data.ptr = &session;
+            if (epoll_ctl(m_epoll, EPOLL_CTL_MOD, session.socket, &event) != 0)
+                return false;
+
+            session.events = events;
+        }
+
+        return true;
+    }
+
+    void Close(Session& session)
+    {
+        const auto socket = session.socket;
+        epoll_ctl(m_epoll, EPOLL_CTL_DEL, socket, nullptr);
+        close(socket);
+        m_sessions.erase(socket);
+        m_server.m_counters.activeSessions--;
+    }
+
+    RobotServer& m_server;
+    int m_epoll;
+    int m_wake;
+    std::vector<char> m_readBuffer;
+    std::unordered_map<int, std::unique_ptr<Session>> m_sessions;
+};
+
+bool RobotServer::TryStart(std::string& error)
+{
+    ServerAddress address;
+    if (!TryResolveServerAddress(m_options.address, address, error))
+        return false;
+
+    // Every session holds a socket, so allow as many open files as the hard limit does.
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    m_tcp = address.family != AF_UNIX;
+    m_listenSocket = socket(address.family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listenSocket < 0)
+    {
+        error = "Unable to create the server socket.";
+        return false;
+    }
+
+    if (m_tcp)
+    {
+        const int reuse = 1;
+        setsockopt(m_listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    }
+    else
+    {
+        // A socket file left over by a previous run would fail the bind.
+        m_unixPath = m_options.address.substr(5);
+        unlink(m_unixPath.c_str());
+    }
+
+    if (bind(m_listenSocket, reinterpret_cast<const sockaddr*>(address.storage), address.length) != 0
+        || listen(m_listenSocket, SOMAXCONN) != 0)
+    {
+        error = "Unable to listen on " + m_options.address + ": " + std::strerror(errno);
+        close(m_listenSocket);
+        m_listenSocket = -1;
+        return false;
+    }
+
+    if (m_tcp)
+    {
+        sockaddr_storage bound{};
+        socklen_t length = sizeof(bound);
+        getsockname(m_listenSocket, reinterpret_cast<sockaddr*>(&bound), &length);
+        m_port = ntohs(bound.ss_family == AF_INET6
+            ? reinterpret_cast<const sockaddr_in6*>(&bound)->sin6_port
+            : reinterpret_cast<const sockaddr_in*>(&bound)->sin_port);
+    }
+
+    auto threads = m_options.threads != 0 ? m_options.threads : std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+
+    for (size_t idx = 0; idx < threads; idx++)
+    {
+        m_loops.push_back(std::make_unique<EventLoop>(*this));
+        if (!m_loops.back()->IsValid())
+        {
+            error = "Unable to create the event loops.";
+            Stop();
+            return false;
+        }
+    }
+
+    for (auto& loop : m_loops)
+        m_threads.emplace_back([&loop]() { loop->Run(); });
+
+    return true;
+}
+
+void RobotServer::Stop()
+{
+    for (auto& loop : m_loops)
+        loop->Wake();
+
+    for (auto& thread : m_threads)
+        thread.join();
+
+    m_threads.clear();
+    m_loops.clear();
+
+    if (m_listenSocket >= 0)
+    {
+        close(m_listenSocket);
+        m_listenSocket = -1;
+        if (!m_unixPath.empty())
+            unlink(m_unixPath.c_str());
+    }
+}
+
+void RobotServer::BlockShutdownSignals()
+{
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+}
+
+void RobotServer::WaitForShutdownSignal()
+{
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+
+    int received;
+    sigwait(&signals, &received);
+}
+
+#else
+
+bool TryResolveServerAddress(const std::string& /*address*/, ServerAddress& /*resolved*/, std::string& error)
+{
+    error = "The robot server is only supported on Linux.";
+    return false;
+}
+
+class RobotServer::EventLoop
+{
+};
+
+bool RobotServer::TryStart(std::string& error)
+{
+    error = "The robot server is only supported on Linux.";
+    return false;
+}
+
+void RobotServer::Stop()
+{
+}
+
+void RobotServer::BlockShutdownSignals()
+{
+}
+
+void RobotServer::WaitForShutdownSignal()
+{
+}
+
+#endif
+
+RobotServer::RobotServer(const ServerOptions& options)
+    : m_options(options)
+{
+}
+
+RobotServer::~RobotServer()
+{
+    Stop();
+}
+
+ServerStats RobotServer::Stats() const
+{
+    ServerStats stats;
+    stats.sessions = m_counters.sessions;
+    stats.activeSessions = m_counters.activeSessions;
+    stats.commands = m_counters.commands;
+    stats.bytesIn = m_counters.bytesIn;
+    stats.bytesOut = m_counters.bytesOut;
+    return stats;
+}
\ No newline at end of file
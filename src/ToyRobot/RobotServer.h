@@ -0,0 +1,165 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "LogLevel.h"
+
+/// <summary>
+/// Options of the robot server.
+/// </summary>
+struct ServerOptions
+{
+    /// <summary>
+    /// Address to listen on, "tcp:host:port" or "unix:path" (--serve=address). Port 0 picks a free port.
+    /// </summary>
+    std::string address;
+
+    /// <summary>
+    /// Number of event loop threads (--server-threads=N). Zero uses the number of hardware threads.
+    /// </summary>
+    size_t threads = 0;
+
+    /// <summary>
+    /// Log level of the sessions (--log-level).
+    /// </summary>
+    LogLevel logLevel = llINFO;
+
+    /// <summary>
+    /// A session whose unsent output grows past this many bytes is not read until the client catches up.
+    /// </summary>
+    size_t maxPendingOutput = 1024 * 1024;
+
+    /// <summary>
+    /// A session sending a line longer than this is disconnected.
+    /// </summary>
+    size_t maxLineLength = 64 * 1024;
+};
+
+/// <summary>
+/// Counters of a running server.
+/// </summary>
+struct ServerStats
+{
+    uint64_t sessions = 0;
+    uint64_t activeSessions = 0;
+    uint64_t commands = 0;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+};
+
+/// <summary>
+/// Resolved socket address of a server.
+/// </summary>
+struct ServerAddress
+{
+    int family = 0;
+    uint32_t length = 0;
+
+    /// <summary>
+    /// The sockaddr of the address, as large and aligned as a sockaddr_storage.
+    /// </summary>
+    alignas(8) unsigned char storage[128] = {};
+};
+
+/// <summary>
+/// Try to resolve a server address in the form of "tcp:host:port" or "unix:path".
+/// </summary>
+/// <returns>[true] Address is resolved. [false] Address is invalid, or sockets are not supported on the platform.</returns>
+bool TryResolveServerAddress(const std::string& address, ServerAddress& resolved, std::string& error);
+
+/// <summary>
+/// Long-running server giving every client connection its own robot session.
+/// A session speaks the text protocol of the console: one command per line, answered with the log records of
+/// the command, without prompts. EXIT closes the session once its output is sent.
+/// Connections are spread over a few event loop threads. Every thread waits on its own epoll set, all of them
+/// sharing the listening socket, and serves its sessions with non-blocking reads and writes through per-session
+/// input and output buffers. Only available on Linux, TryStart fails elsewhere.
+/// </summary>
+class RobotServer
+{
+public:
+    explicit RobotServer(const ServerOptions& options);
+    ~RobotServer();
+
+    /// <summary>
+    /// Copy constructor is not allowed
+    /// </summary>
+    RobotServer(const RobotServer&) = delete;
+
+    /// <summary>
+    /// Bind the address and start the event loop threads.
+    /// </summary>
+    /// <returns>[true] Server is running. [false] Address could not be bound.</returns>
+    bool TryStart(std::string& error);
+
+    /// <summary>
+    /// Stop the event loops and close every session. Waits for the threads to finish.
+    /// </summary>
+    void Stop();
+
+    /// <summary>
+    /// Bound TCP port, useful when port 0 was asked for. Zero for unix sockets.
+    /// </summary>
+    uint16_t Port() const { return m_port; }
+
+    ServerStats Stats() const;
+
+    /// <summary>
+    /// Block SIGINT and SIGTERM in the calling thread and in the threads it starts afterwards,
+    /// so that WaitForShutdownSignal receives them. Call before TryStart.
+    /// </summary>
+    static void BlockShutdownSignals();
+
+    /// <summary>
+    /// Wait until SIGINT or SIGTERM is received.
+    /// </summary>
+    static void WaitForShutdownSignal();
+
+private:
+    class EventLoop;
+
+    /// <summary>
+    /// Counters updated by the event loops.
+    /// </summary>
+    struct Counters
+    {
+        std::atomic<uint64_t> sessions{ 0 };
+        std::atomic<uint64_t> activeSessions{ 0 };
+        std::atomic<uint64_t> commands{ 0 };
+        std::atomic<uint64_t> bytesIn{ 0 };
+        std::atomic<uint64_t> bytesOut{ 0 };
+    };
+
+    ServerOptions m_options;
+    int m_listenSocket = -1;
+    bool m_tcp = false;
+    std::string m_unixPath;
+    uint16_t m_port = 0;
+    Counters m_counters;
+    std::vector<std::unique_ptr<EventLoop>> m_loops;
+    std::vector<std::thread> m_threads;
+};
\ No newline at end of file
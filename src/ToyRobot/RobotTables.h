@@ -0,0 +1,170 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <stdint.h>
+#include "FacingDirection.h"
+#include "RobotResult.h"
+
+/// <summary>
+/// Lookup tables for the robot state machine, generated at compile time.
+/// Every table is indexed by (facing direction & 7), so that an out of range value behaves as fdUNKNOWN.
+/// </summary>
+using DirectionTable = std::array<uint8_t, 8>;
+
+template <typename TFunc>
+constexpr DirectionTable MakeDirectionTable(TFunc valueOf)
+{
+	DirectionTable table{};
+	for (uint8_t direction = 0; direction < table.size(); direction++)
+		table[direction] = valueOf(static_cast<FacingDirection>(direction));
+
+	return table;
+}
+
+/// <summary>
+/// Whether the direction is one of the four compass directions.
+/// </summary>
+inline constexpr DirectionTable IsKnownDirection = MakeDirectionTable([](FacingDirection direction) -> uint8_t {
+	return direction >= fdNORTH && direction <= fdWEST;
+});
+
+/// <summary>
+/// Step along x and y, as unsigned bytes. Stepping below zero wraps to 255, so a single unsigned
+/// comparison against the board limit catches both edges.
+/// </summary>
+inline constexpr DirectionTable DeltaX = MakeDirectionTable([](FacingDirection direction) -> uint8_t {
+	return direction == fdEAST ? 1 : direction == fdWEST ? 255 : 0;
+});
+
+inline constexpr DirectionTable DeltaY = MakeDirectionTable([](FacingDirection direction) -> uint8_t {
+	return direction == fdNORTH ? 1 : direction == fdSOUTH ? 255 : 0;
+});
+
+/// <summary>
+/// Result of a move that would leave the board.
+/// </summary>
+inline constexpr DirectionTable BlockedResult = MakeDirectionTable([](FacingDirection direction) -> uint8_t {
+	switch (direction)
+	{
+	case fdNORTH: return rrNORTH_EDGE;
+	case fdSOUTH: return rrSOUTH_EDGE;
+	case fdEAST: return rrEAST_EDGE;
+	case fdWEST: return rrWEST_EDGE;
+	default: return rrUNKNOWN_DIRECTION;
+	}
+});
+
+/// <summary>
+/// Direction after turning 90 degrees. Unknown directions are left as they are.
+/// </summary>
+inline constexpr DirectionTable LeftOf = MakeDirectionTable([](FacingDirection direction) -> uint8_t {
+	switch (direction)
+	{
+	case fdNORTH: return fdWEST;
+	case fdSOUTH: return fdEAST;
+	case fdEAST: return fdNORTH;
+	case fdWEST: return fdSOUTH;
+	default: return direction;
+	}
+});
+
+inline constexpr DirectionTable RightOf = MakeDirectionTable([](FacingDirection direction) -> uint8_t {
+	switch (direction)
+	{
+	case fdNORTH: return fdEAST;
+	case fdSOUTH: return fdWEST;
+	case fdEAST: return fdSOUTH;
+	case fdWEST: return fdNORTH;
+	default: return direction;
+	}
+});
+
+static_assert(LeftOf[RightOf[fdNORTH]] == fdNORTH && LeftOf[LeftOf[LeftOf[LeftOf[fdEAST]]]] == fdEAST,
+	"Turning tables are not consistent");
+static_assert(static_cast<uint8_t>(0 + DeltaX[fdWEST]) == 255, "Moving west from x=0 must leave the board");
+
+// Branch-free forms of the tables above, built from compares and masks, for loops that are meant to be
+// vectorised (byte table lookups and branches can not be). Both forms are checked to agree below.
+
+/// <summary>
+/// Branch-free select. The condition must be 0 or 1.
+/// </summary>
+inline constexpr uint8_t LaneSelect(uint8_t condition, uint8_t whenTrue, uint8_t whenFalse)
+{
+	const auto mask = static_cast<uint8_t>(-condition);
+	return static_cast<uint8_t>((whenTrue & mask) | (whenFalse & ~mask));
+}
+
+inline constexpr uint8_t LaneIsKnown(uint8_t direction)
+{
+	return static_cast<uint8_t>(direction - fdNORTH) < 4;
+}
+
+inline constexpr uint8_t LaneDeltaX(uint8_t direction)
+{
+	return static_cast<uint8_t>((direction == fdEAST) - (direction == fdWEST));
+}
+
+inline constexpr uint8_t LaneDeltaY(uint8_t direction)
+{
+	return static_cast<uint8_t>((direction == fdNORTH) - (direction == fdSOUTH));
+}
+
+inline constexpr uint8_t LaneBlockedResult(uint8_t direction)
+{
+	return LaneSelect(LaneIsKnown(direction), static_cast<uint8_t>(direction + (rrNORTH_EDGE - fdNORTH)), rrUNKNOWN_DIRECTION);
+}
+
+inline constexpr uint8_t LaneLeftOf(uint8_t direction)
+{
+	return LaneSelect(direction == fdNORTH, fdWEST,
+		LaneSelect(direction == fdSOUTH, fdEAST,
+		LaneSelect(direction == fdEAST, fdNORTH,
+		LaneSelect(direction == fdWEST, fdSOUTH, direction))));
+}
+
+inline constexpr uint8_t LaneRightOf(uint8_t direction)
+{
+	return LaneSelect(direction == fdNORTH, fdEAST,
+		LaneSelect(direction == fdSOUTH, fdWEST,
+		LaneSelect(direction == fdEAST, fdSOUTH,
+		LaneSelect(direction == fdWEST, fdNORTH, direction))));
+}
+
+inline constexpr bool LanesMatchTables()
+{
+	for (uint8_t direction = 0; direction < 8; direction++)
+	{
+		if (LaneIsKnown(direction) != IsKnownDirection[direction]
+			|| LaneDeltaX(direction) != DeltaX[direction]
+			|| LaneDeltaY(direction) != DeltaY[direction]
+			|| LaneBlockedResult(direction) != BlockedResult[direction]
+			|| LaneLeftOf(direction) != LeftOf[direction]
+			|| LaneRightOf(direction) != RightOf[direction])
+			return false;
+	}
+
+	return true;
+}
+
+static_assert(LanesMatchTables(), "Lane transitions do not match the tables");
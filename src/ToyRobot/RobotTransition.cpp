@@ -0,0 +1,355 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "RobotTransition.h"
+#include "ToyRobot.h"
+
+namespace
+{
+    const size_t Width = DefaultBoard::MaxX() + 1;
+
+    /// <summary>
+    /// The tables are built without logging, the robot only needs a logger to be constructed.
+    /// </summary>
+    class NullLogger : public LoggerBase
+    {
+    protected:
+        void Print(std::string_view /*msgType*/, std::string_view /*msg*/, std::string_view /*end*/) override {}
+    };
+
+    LoggerBase& NullLog()
+    {
+        static NullLogger logger;
+        return logger;
+    }
+
+    /// <summary>
+    /// Level of the record the robot logs for the outcome of a command, zero when it logs none.
+    /// This is LogRobotResult's choice of level, which is not called here so that the failures are not counted.
+    /// </summary>
+    uint8_t RecordLevel(Command cmd, RobotResult result, FacingDirection facingDirection)
+    {
+        switch (result)
+        {
+        case rrSUCCESS:
+            return (cmd == cmdTURN_LEFT || cmd == cmdTURN_RIGHT) && facingDirection != fdUNKNOWN ? elINFO : 0;
+        case rrALREADY_PLACED:
+        case rrNORTH_EDGE:
+        case rrSOUTH_EDGE:
+        case rrEAST_EDGE:
+        case rrWEST_EDGE:
+            return elWARN;
+        case rrOCCUPIED:
+            return cmd == cmdMOVE ? elWARN : elERROR;
+        default:
+            return elERROR;
+        }
+    }
+
+    RobotTransition MakeCommandTransition(Command cmd)
+    {
+        RobotTransition transition;
+        ToyRobot robot(NullLog());
+        for (size_t state = 0; state < RobotTransition::StateCount; state++)
+        {
+            robot.TryRestoreState(RobotTransition::Decode(static_cast<RobotTransition::State>(state)));
+            switch (cmd)
+            {
+            case cmdMOVE: robot.Move(); break;
+            case cmdTURN_LEFT: robot.TurnLeft(); break;
+            case cmdTURN_RIGHT: robot.TurnRight(); break;
+            default: break;
+            }
+
+            transition.Set(static_cast<RobotTransition::State>(state), RobotTransition::Encode(robot.SaveState()));
+        }
+
+        return transition;
+    }
+}
+
+RobotTransition::RobotTransition()
+{
+    for (size_t state = 0; state < StateCount; state++)
+        m_next[state] = static_cast<State>(state);
+}
+
+RobotTransition::State RobotTransition::Encode(const RobotState& state)
+{
+    if (!state.placed)
+        return Unplaced;
+
+    return static_cast<State>(1 + (state.y * Width + state.x) * DirectionCount + state.facingDirection);
+}
+
+RobotState RobotTransition::Decode(State state)
+{
+    RobotState decoded;
+    if (state == Unplaced)
+        return decoded;
+
+    const size_t cell = (state - 1) / DirectionCount;
+    decoded.x = cell % Width;
+    decoded.y = cell / Width;
+    decoded.facingDirection = static_cast<FacingDirection>((state - 1) % DirectionCount);
+    decoded.placed = true;
+
+    return decoded;
+}
+
+const RobotTransition& RobotTransition::Of(Command cmd)
+{
+    static const RobotTransition identity;
+    static const RobotTransition move = MakeCommandTransition(cmdMOVE);
+    static const RobotTransition left = MakeCommandTransition(cmdTURN_LEFT);
+    static const RobotTransition right = MakeCommandTransition(cmdTURN_RIGHT);
+
+    switch (cmd)
+    {
+    case cmdMOVE: return move;
+    case cmdTURN_LEFT: return left;
+    case cmdTURN_RIGHT: return right;
+    default: return identity;
+    }
+}
+
+RobotTransition RobotTransition::Place(int64_t x, int64_t y, FacingDirection facingDirection)
+{
+    RobotTransition transition;
+    State placed;
+    if (TryPlace(x, y, facingDirection, placed))
+        transition.Set(Unplaced, placed);
+
+    return transition;
+}
+
+bool RobotTransition::TryPlace(int64_t x, int64_t y, FacingDirection facingDirection, State& placed)
+{
+    ToyRobot robot(NullLog());
+    if (robot.Place(x, y, facingDirection) != rrSUCCESS)
+        return false;
+
+    placed = Encode(robot.SaveState());
+    return true;
+}
+
+RobotTransition RobotTransition::Then(const RobotTransition& next) const
+{
+    RobotTransition transition;
+    for (size_t state = 0; state < StateCount; state++)
+        transition.m_next[state] = next.m_next[m_next[state]];
+
+    return transition;
+}
+
+const RobotEffect& RobotEffect::Of(Command cmd)
+{
+    static const RobotEffect identity;
+    static const RobotEffect move = Measure(cmdMOVE, 0, 0, fdUNKNOWN);
+    static const RobotEffect left = Measure(cmdTURN_LEFT, 0, 0, fdUNKNOWN);
+    static const RobotEffect right = Measure(cmdTURN_RIGHT, 0, 0, fdUNKNOWN);
+    static const RobotEffect report = Measure(cmdREPORT, 0, 0, fdUNKNOWN);
+    static const RobotEffect error = Measure(cmdUNKNOWN, 0, 0, fdUNKNOWN);
+
+    switch (cmd)
+    {
+    case cmdMOVE: return move;
+    case cmdTURN_LEFT: return left;
+    case cmdTURN_RIGHT: return right;
+    case cmdREPORT: return report;
+    case cmdUNKNOWN: return error;
+    default: return identity;
+    }
+}
+
+RobotEffect RobotEffect::Place(int64_t x, int64_t y, FacingDirection facingDirection)
+{
+    return Measure(cmdPLACE, x, y, facingDirection);
+}
+
+RobotEffect RobotEffect::Then(const RobotEffect& next) const
+{
+    auto effect = *this;
+    effect.Append(next);
+    return effect;
+}
+
+void RobotEffect::Append(const RobotEffect& next)
+{
+    for (size_t state = 0; state < RobotTransition::StateCount; state++)
+    {
+        const auto from = static_cast<State>(state);
+        const auto middle = m_transition.Apply(from);
+        m_levels[state] |= next.m_levels[middle];
+        m_transition.Set(from, next.m_transition.Apply(middle));
+    }
+}
+
+RobotEffect RobotEffect::Measure(Command cmd, int64_t x, int64_t y, FacingDirection facingDirection)
+{
+    RobotEffect effect;
+    ToyRobot robot(NullLog());
+    for (size_t state = 0; state < RobotTransition::StateCount; state++)
+    {
+        const auto from = static_cast<State>(state);
+        robot.TryRestoreState(RobotTransition::Decode(from));
+
+        // A rejected command logs the robot's record followed by the failure message at ERROR, as in the runner.
+        auto result = rrSUCCESS;
+        switch (cmd)
+        {
+        case cmdPLACE: result = robot.Place(x, y, facingDirection); break;
+        case cmdMOVE: result = robot.Move(); break;
+        case cmdTURN_LEFT: result = robot.TurnLeft(); break;
+        case cmdTURN_RIGHT: result = robot.TurnRight(); break;
+        case cmdREPORT: effect.m_levels[state] = elOUTPUT; break;
+        default: effect.m_levels[state] = elERROR; break;
+        }
+
+        const auto after = robot.SaveState();
+        effect.m_levels[state] |= RecordLevel(cmd, result, after.facingDirection);
+        if (result != rrSUCCESS)
+            effect.m_levels[state] |= elERROR;
+
+        effect.m_transition.Set(from, RobotTransition::Encode(after));
+    }
+
+    return effect;
+}
+
+TransitionBuilder::TransitionBuilder()
+{
+    m_tables.fill(&RobotTransition::Of(cmdUNKNOWN));
+    m_tables[cmdMOVE] = &RobotTransition::Of(cmdMOVE);
+    m_tables[cmdTURN_LEFT] = &RobotTransition::Of(cmdTURN_LEFT);
+    m_tables[cmdTURN_RIGHT] = &RobotTransition::Of(cmdTURN_RIGHT);
+
+    // Every starting state is a class of its own until two of them meet. A robot placed facing UNKNOWN can
+    // neither move nor turn, those states are left out instead of being followed as 36 classes that never merge.
+    for (size_t state = 0; state < RobotTransition::StateCount; state++)
+    {
+        const auto from = static_cast<State>(state);
+        const auto fixed = from != RobotTransition::Unplaced && m_tables[cmdMOVE]->Apply(from) == from
+            && m_tables[cmdTURN_LEFT]->Apply(from) == from && m_tables[cmdTURN_RIGHT]->Apply(from) == from;
+        if (fixed)
+        {
+            m_classOf[state] = FixedClass;
+        }
+        else
+        {
+            m_classOf[state] = static_cast<uint8_t>(m_count);
+            m_states[m_count++] = from;
+        }
+    }
+}
+
+void TransitionBuilder::ApplyPlace(int64_t x, int64_t y, FacingDirection facingDirection)
+{
+    State placed;
+    if (!RobotTransition::TryPlace(x, y, facingDirection, placed))
+        return;
+
+    // Only the unplaced class moves. It merges with the class already at the placed state, if there is one.
+    auto merged = false;
+    for (size_t idx = 0; idx < m_count; idx++)
+        merged |= m_states[idx] == placed;
+
+    for (size_t idx = 0; idx < m_count; idx++)
+    {
+        if (m_states[idx] == RobotTransition::Unplaced)
+        {
+            m_states[idx] = placed;
+            if (merged)
+                Merge();
+            return;
+        }
+    }
+}
+
+void TransitionBuilder::Apply(const RobotTransition& transition)
+{
+    if (m_count == 1)
+    {
+        m_states[0] = transition.Apply(m_states[0]);
+        return;
+    }
+
+    const auto generation = NextGeneration();
+    auto merged = false;
+    for (size_t idx = 0; idx < m_count; idx++)
+    {
+        const auto state = transition.Apply(m_states[idx]);
+        m_states[idx] = state;
+        merged |= m_seen[state] == generation;
+        m_seen[state] = generation;
+    }
+
+    if (merged)
+        Merge();
+}
+
+RobotTransition TransitionBuilder::Transition() const
+{
+    RobotTransition transition;
+    for (size_t state = 0; state < RobotTransition::StateCount; state++)
+        transition.Set(static_cast<State>(state), m_classOf[state] == FixedClass ? static_cast<State>(state) : m_states[m_classOf[state]]);
+
+    return transition;
+}
+
+void TransitionBuilder::Merge()
+{
+    // Renumber the classes by the first class holding each state. A new number is never above the old one,
+    // so the states can be compacted in place.
+    std::array<uint8_t, RobotTransition::StateCount> renumbered;
+    const auto generation = NextGeneration();
+    size_t count = 0;
+    for (size_t idx = 0; idx < m_count; idx++)
+    {
+        const auto state = m_states[idx];
+        if (m_seen[state] != generation)
+        {
+            m_seen[state] = generation;
+            m_slot[state] = static_cast<uint8_t>(count);
+            m_states[count++] = state;
+        }
+
+        renumbered[idx] = m_slot[state];
+    }
+
+    for (auto& classIndex : m_classOf)
+    {
+        if (classIndex != FixedClass)
+            classIndex = renumbered[classIndex];
+    }
+
+    m_count = count;
+}
+
+uint32_t TransitionBuilder::NextGeneration()
+{
+    if (++m_generation == 0)
+    {
+        m_seen.fill(0);
+        m_generation = 1;
+    }
+
+    return m_generation;
+}
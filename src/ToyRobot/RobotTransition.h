@@ -0,0 +1,232 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+#include "Board.h"
+#include "Commands.h"
+#include "FacingDirection.h"
+#include "RobotBase.h"
+
+/// <summary>
+/// Effect of a command sequence on a robot alone on the default board, as a function of the state it starts in.
+/// The robot is either not placed, or placed on one of the 6x6 cells facing one of the four compass directions
+/// or UNKNOWN, which PLACE accepts as well: 181 states in all. Composing transitions is associative, so the
+/// effect of a long script can be put together from the effects of its parts in any grouping.
+/// Single commands are applied to a real ToyRobot to build their tables, so the semantics are the robot's own.
+/// </summary>
+class RobotTransition
+{
+public:
+    using State = uint8_t;
+
+    static constexpr size_t DirectionCount = fdWEST + 1;
+    static constexpr size_t StateCount = 1 + (DefaultBoard::MaxX() + 1) * (DefaultBoard::MaxY() + 1) * DirectionCount;
+    static constexpr State Unplaced = 0;
+
+    static_assert(StateCount <= 256, "States of the default board must fit in a byte");
+
+    /// <summary>
+    /// The identity, the transition of an empty sequence.
+    /// </summary>
+    RobotTransition();
+
+    /// <summary>
+    /// State of a robot on the default board. The state must be one the robot can be in.
+    /// </summary>
+    static State Encode(const RobotState& state);
+    static RobotState Decode(State state);
+
+    /// <summary>
+    /// Transition of a single MOVE, LEFT or RIGHT. Any other command leaves every state as it is.
+    /// </summary>
+    static const RobotTransition& Of(Command cmd);
+
+    /// <summary>
+    /// Transition of a PLACE with parsed arguments. Only the unplaced state changes, and only when the
+    /// coordinates are on the board.
+    /// </summary>
+    static RobotTransition Place(int64_t x, int64_t y, FacingDirection facingDirection);
+
+    /// <summary>
+    /// Try to place an unplaced robot.
+    /// </summary>
+    /// <param name="placed">State of the placed robot</param>
+    /// <returns>[true] Robot is placed. [false] The PLACE is rejected and the robot stays unplaced.</returns>
+    static bool TryPlace(int64_t x, int64_t y, FacingDirection facingDirection, State& placed);
+
+    /// <summary>
+    /// This transition followed by the next one.
+    /// </summary>
+    RobotTransition Then(const RobotTransition& next) const;
+
+    State Apply(State state) const { return m_next[state]; }
+    void Set(State from, State to) { m_next[from] = to; }
+
+    bool operator==(const RobotTransition& other) const { return m_next == other.m_next; }
+    bool operator!=(const RobotTransition& other) const { return m_next != other.m_next; }
+
+private:
+    std::array<State, StateCount> m_next;
+};
+
+/// <summary>
+/// Log levels a command sequence writes records at, as a bit mask.
+/// </summary>
+enum EffectLevel
+{
+    elINFO = 1,
+    elWARN = 2,
+    elERROR = 4,
+    elOUTPUT = 8
+};
+
+/// <summary>
+/// Transition of a command sequence together with the levels it logs at from every starting state, as the
+/// program runner logs them. The sequence writes nothing at a log level when none of its levels are enabled,
+/// and can then be applied as a whole from its transition without changing the log. Effects compose like
+/// transitions do, so repeating a sequence n times is put together from O(log n) of its powers.
+/// </summary>
+class RobotEffect
+{
+public:
+    using State = RobotTransition::State;
+
+    /// <summary>
+    /// The identity, the effect of an empty sequence.
+    /// </summary>
+    RobotEffect()
+    {
+        m_levels.fill(0);
+    }
+
+    /// <summary>
+    /// Effect of a single MOVE, LEFT, RIGHT or REPORT, or of a line that failed to compile for cmdUNKNOWN.
+    /// </summary>
+    static const RobotEffect& Of(Command cmd);
+
+    /// <summary>
+    /// Effect of a PLACE with parsed arguments.
+    /// </summary>
+    static RobotEffect Place(int64_t x, int64_t y, FacingDirection facingDirection);
+
+    /// <summary>
+    /// This effect followed by the next one.
+    /// </summary>
+    RobotEffect Then(const RobotEffect& next) const;
+
+    /// <summary>
+    /// Follow this effect by the next one in place.
+    /// </summary>
+    void Append(const RobotEffect& next);
+
+    const RobotTransition& Transition() const { return m_transition; }
+
+    /// <summary>
+    /// Levels logged from the given starting state, a mask of EffectLevel values.
+    /// </summary>
+    uint8_t Levels(State state) const { return m_levels[state]; }
+
+    bool operator==(const RobotEffect& other) const { return m_transition == other.m_transition && m_levels == other.m_levels; }
+    bool operator!=(const RobotEffect& other) const { return !(*this == other); }
+
+private:
+    /// <summary>
+    /// Apply a single command to a real ToyRobot from every state.
+    /// </summary>
+    static RobotEffect Measure(Command cmd, int64_t x, int64_t y, FacingDirection facingDirection);
+
+    RobotTransition m_transition;
+    std::array<uint8_t, RobotTransition::StateCount> m_levels;
+};
+
+/// <summary>
+/// Builds the transition of a command sequence one command at a time.
+/// Starting states that end up in the same state are merged into one class and followed together from then
+/// on, so a command costs one table lookup per class left. Moves against the edges merge classes quickly, down
+/// to one class per facing direction after a few dozen commands in most scripts, as turns never merge them.
+/// </summary>
+class TransitionBuilder
+{
+public:
+    TransitionBuilder();
+
+    /// <summary>
+    /// Apply a MOVE, LEFT or RIGHT. Other commands leave the state as it is.
+    /// </summary>
+    void Apply(Command cmd)
+    {
+        if (cmd == cmdMOVE || cmd == cmdTURN_LEFT || cmd == cmdTURN_RIGHT)
+            Apply(*m_tables[cmd]);
+    }
+
+    /// <summary>
+    /// Apply a PLACE with parsed arguments.
+    /// </summary>
+    void ApplyPlace(int64_t x, int64_t y, FacingDirection facingDirection);
+
+    /// <summary>
+    /// Apply the transition of a whole sequence.
+    /// </summary>
+    void Apply(const RobotTransition& transition);
+
+    /// <summary>
+    /// Number of distinct states the starting states are in.
+    /// </summary>
+    size_t ClassCount() const { return m_count; }
+
+    /// <summary>
+    /// Transition of the commands applied so far.
+    /// </summary>
+    RobotTransition Transition() const;
+
+private:
+    using State = RobotTransition::State;
+
+    /// <summary>
+    /// Merge the classes that reached the same state.
+    /// </summary>
+    void Merge();
+    uint32_t NextGeneration();
+
+    std::array<const RobotTransition*, cmdTURN_RIGHT + 1> m_tables;
+
+    /// <summary>
+    /// Class of the starting states that no command changes.
+    /// </summary>
+    static constexpr uint8_t FixedClass = 0xFF;
+
+    /// <summary>
+    /// Class of every starting state, and the current state of every class.
+    /// </summary>
+    std::array<uint8_t, RobotTransition::StateCount> m_classOf;
+    std::array<State, RobotTransition::StateCount> m_states;
+    size_t m_count = 0;
+
+    /// <summary>
+    /// Generation stamp of every state, to find the classes sharing a state without clearing a table.
+    /// </summary>
+    std::array<uint32_t, RobotTransition::StateCount> m_seen{};
+    std::array<uint8_t, RobotTransition::StateCount> m_slot{};
+    uint32_t m_generation = 0;
+};
@@ -0,0 +1,107 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// Bounded lock-free single-producer single-consumer ring buffer.
+/// The producer only writes the head and the consumer only writes the tail, each on its own cache line, and
+/// both keep a cached copy of the other index so the shared line is only read when the buffer looks full or empty.
+/// Values are exchanged by swapping, as in MpscRingBuffer, so buffers travel back to the producer for reuse.
+/// </summary>
+template <typename T>
+class SpscRingBuffer
+{
+public:
+    /// <summary>
+    /// Create the ring buffer. Capacity is rounded up to a power of two.
+    /// </summary>
+    explicit SpscRingBuffer(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+
+        m_mask = size - 1;
+        m_slots = std::vector<T>(size);
+    }
+
+    /// <summary>
+    /// Copy constructor is not allowed
+    /// </summary>
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+
+    /// <summary>
+    /// Try to push a value. Must only be called from the single producer thread.
+    /// </summary>
+    /// <param name="value">Value to push. Receives the recycled content of the slot on success.</param>
+    /// <returns>[true] Value is pushed. [false] Buffer is full.</returns>
+    bool TryPush(T& value)
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail > m_mask)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cachedTail > m_mask)
+                return false;
+        }
+
+        std::swap(m_slots[head & m_mask], value);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// <summary>
+    /// Try to pop the oldest value. Must only be called from the single consumer thread.
+    /// </summary>
+    /// <param name="value">Receives the value. Its previous content is left in the slot for reuse.</param>
+    /// <returns>[true] Value is popped. [false] Buffer is empty.</returns>
+    bool TryPop(T& value)
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cachedHead)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail == m_cachedHead)
+                return false;
+        }
+
+        std::swap(m_slots[tail & m_mask], value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t Capacity() const { return m_mask + 1; }
+
+private:
+    std::vector<T> m_slots;
+    size_t m_mask = 0;
+
+    alignas(64) std::atomic<uint64_t> m_head{ 0 };
+    uint64_t m_cachedTail = 0;
+
+    alignas(64) std::atomic<uint64_t> m_tail{ 0 };
+    uint64_t m_cachedHead = 0;
+};
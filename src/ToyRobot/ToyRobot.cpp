@@ -19,159 +19,84 @@
  */
 
 #include "ToyRobot.h"
-#include "Logger.h"
 
-ToyRobot::ToyRobot(LoggerBase& logger):
-	m_logger(logger)
+void LogRobotResult(LoggerBase& logger, Command cmd, RobotResult result, FacingDirection facingDirection, uint64_t maxX, uint64_t maxY)
 {
-}
-
-bool ToyRobot::TryPlace(uint8_t x, uint8_t y, FacingDirection facingDirection)
-{
-	if (m_placed)
-	{
-		m_logger.Warn("Robot is already placed. Ignoring the command");
-		return false;
-	}
-
-	if (x < 0 || x > m_xmax)
+	// Successes are counted by the commander, not every robot reports them here.
+	if constexpr (StatsEnabled)
 	{
-		m_logger.Error("Invalid x coordinate. X should be in between 0-" + std::to_string(m_xmax));
-		return false;
+		if (result != rrSUCCESS)
+			CommandStats::ThisThread().CountResult(cmd, result);
 	}
 
-	if (y < 0 || y > m_ymax)
-	{
-		m_logger.Error("Invalid y coordinate. Y should be in between 0-" + std::to_string(m_ymax));
-		return false;
-	}
-
-	m_x = x;
-	m_y = y;
-	m_facingDirection = facingDirection;
-	m_placed = true;
-
-	return true;
-}
-
-bool ToyRobot::TryMove()
-{
-	if (!m_placed)
+	switch (result)
 	{
-		m_logger.Error("Robot is not placed. Please place the robot before moving.");
-		return false;
-	}
+	case rrSUCCESS:
+		if (cmd != cmdTURN_LEFT && cmd != cmdTURN_RIGHT)
+			return;
 
-	switch (m_facingDirection)
-	{	
-	case fdNORTH:
-		if (m_y + 1 > m_ymax)
-		{
-			m_logger.Warn("Robot going to move over the north edge. Command is ignored for safety.");
-			return false;
-		}
-		m_y++;
-		return true;
-	case fdSOUTH:
-		if (m_y - 1 < 0)
-		{
-			m_logger.Warn("Robot going to move over the south edge. Command is ignored for safety.");
-			return false;
-		}
-		m_y--;
-		return true;
-	case fdEAST:
-		if (m_x + 1 > m_xmax)
-		{
-			m_logger.Warn("Robot going to move over the east edge. Command is ignored for safety.");
-			return false;
-		}
-		m_x++;
-		return true;
-	case fdWEST:
-		if (m_x - 1 < 0)
+		switch (facingDirection)
 		{
-			m_logger.Warn("Robot going to move over the west edge. Command is ignored for safety.");
-			return false;
+		case fdNORTH:
+			logger.Info("Robot is now facing NORTH");
+			return;
+		case fdSOUTH:
+			logger.Info("Robot is now facing SOUTH");
+			return;
+		case fdEAST:
+			logger.Info("Robot is now facing EAST");
+			return;
+		case fdWEST:
+			logger.Info("Robot is now facing WEST");
+			return;
+		default:
+			return;
 		}
-		m_x--;
-		return true;
-	case fdUNKNOWN:
+	case rrALREADY_PLACED:
+		logger.Warn("Robot is already placed. Ignoring the command");
+		return;
+	case rrINVALID_X:
+		logger.Error([maxX]() { return "Invalid x coordinate. X should be in between 0-" + std::to_string(maxX); });
+		return;
+	case rrINVALID_Y:
+		logger.Error([maxY]() { return "Invalid y coordinate. Y should be in between 0-" + std::to_string(maxY); });
+		return;
+	case rrNOT_PLACED:
+		if (cmd == cmdMOVE)
+			logger.Error("Robot is not placed. Please place the robot before moving.");
+		else
+			logger.Error("Robot is not placed.");
+		return;
+	case rrNORTH_EDGE:
+		logger.Warn("Robot going to move over the north edge. Command is ignored for safety.");
+		return;
+	case rrSOUTH_EDGE:
+		logger.Warn("Robot going to move over the south edge. Command is ignored for safety.");
+		return;
+	case rrEAST_EDGE:
+		logger.Warn("Robot going to move over the east edge. Command is ignored for safety.");
+		return;
+	case rrWEST_EDGE:
+		logger.Warn("Robot going to move over the west edge. Command is ignored for safety.");
+		return;
+	case rrOCCUPIED:
+		if (cmd == cmdMOVE)
+			logger.Warn("Robot going to move into an occupied cell. Command is ignored for safety.");
+		else
+			logger.Error("The cell is occupied. Robot can not be placed there.");
+		return;
+	case rrUNKNOWN_DIRECTION:
 	default:
-		m_logger.Error("Robot is facing an unknown direction.");
-		return false;
+		if (cmd == cmdMOVE)
+			logger.Error("Robot is facing an unknown direction.");
+		else
+			logger.Error("Robot is now facing an unknown direction.");
+		return;
 	}
 }
 
-bool ToyRobot::TryTurnLeft()
-{
-	if (!m_placed)
-	{
-		m_logger.Error("Robot is not placed.");
-		return false;
-	}
-
-	switch (m_facingDirection)
-	{
-	case fdNORTH:
-		m_facingDirection = fdWEST;
-		m_logger.Info("Robot is now facing WEST");
-		return true;
-	case fdSOUTH:
-		m_facingDirection = fdEAST;
-		m_logger.Info("Robot is now facing EAST");
-		return true;
-	case fdEAST:
-		m_facingDirection = fdNORTH;
-		m_logger.Info("Robot is now facing NORTH");
-		return true;
-	case fdWEST:
-		m_facingDirection = fdSOUTH;
-		m_logger.Info("Robot is now facing SOUTH");
-		return true;
-	case fdUNKNOWN:
-	default:
-		m_logger.Error("Robot is now facing an unknown direction.");
-		return false;
-	}
-}
-
-bool ToyRobot::TryTurnRight()
-{
-	if (!m_placed)
-	{
-		m_logger.Error("Robot is not placed.");
-		return false;
-	}
-
-	switch (m_facingDirection)
-	{
-	case fdNORTH:
-		m_facingDirection = fdEAST;
-		m_logger.Info("Robot is now facing EAST");
-		return true;
-	case fdSOUTH:
-		m_facingDirection = fdWEST;
-		m_logger.Info("Robot is now facing WEST");
-		return true;
-	case fdEAST:
-		m_facingDirection = fdSOUTH;
-		m_logger.Info("Robot is now facing SOUTH");
-		return true;
-	case fdWEST:
-		m_facingDirection = fdNORTH;
-		m_logger.Info("Robot is now facing NORTH");
-		return true;
-	case fdUNKNOWN:
-	default:
-		m_logger.Error("Robot is now facing an unknown direction.");
-		return false;
-	}
-}
-
-void ToyRobot::Report(uint8_t& x, uint8_t& y, FacingDirection& facingDirection)
-{
-	x = m_x;
-	y = m_y;
-	facingDirection = m_facingDirection;
-}
+// The members are defined in ToyRobot.h, the robots used by the program are compiled once here.
+template class BasicToyRobot<DefaultBoard>;
+template class BasicToyRobot<RuntimeBoard>;
+template class BasicToyRobot<RuntimeBoard, SharedOccupancy<DenseOccupancy>>;
+template class BasicToyRobot<RuntimeBoard, SharedOccupancy<SparseOccupancy>>;
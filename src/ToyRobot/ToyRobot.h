@@ -21,28 +21,339 @@
 #pragma once
 
 #include <stdint.h>
+#include <string>
+#include <type_traits>
+#include "Board.h"
+#include "Commands.h"
 #include "FacingDirection.h"
 #include "Logger.h"
+#include "OccupancyIndex.h"
+#include "RobotBase.h"
+#include "RobotResult.h"
+#include "RobotTables.h"
 
-class ToyRobot
+/// <summary>
+/// Log the outcome of a robot command: the new facing direction after a turn, or why the command was rejected.
+/// Rejections are also counted in the command statistics of the thread.
+/// </summary>
+/// <param name="facingDirection">Facing direction of the robot after the command</param>
+/// <param name="maxX">Largest x coordinate of the board, quoted when x is invalid</param>
+/// <param name="maxY">Largest y coordinate of the board, quoted when y is invalid</param>
+void LogRobotResult(LoggerBase& logger, Command cmd, RobotResult result, FacingDirection facingDirection, uint64_t maxX, uint64_t maxY);
+
+/// <summary>
+/// Toy robot moving on the board given by TBoard. The board is a private base, so a StaticBoard adds no state
+/// and the robot stays at two coordinates, a direction and a flag.
+/// TOccupancy decides which cells are taken by other robots or obstacles. With NoOccupancy the robot is alone
+/// on the board and the checks compile away.
+/// The class is final, so a commander driving it through RobotRef calls it without virtual dispatch.
+/// </summary>
+template <typename TBoard, typename TOccupancy = NoOccupancy>
+class BasicToyRobot final : public RobotBase, private TBoard, private TOccupancy
 {
 public:
-	ToyRobot(LoggerBase& logger);
-	bool TryPlace(uint8_t x, uint8_t y, FacingDirection facingDirection);
-	bool TryMove();
-	bool TryTurnRight();
-	bool TryTurnLeft();
-	void Report(uint8_t& x, uint8_t& y, FacingDirection& facingDirection);
+	using Board = TBoard;
+	using Occupancy = TOccupancy;
+	using Coordinate = typename TBoard::Coordinate;
+
+	BasicToyRobot(LoggerBase& logger, const TBoard& board = TBoard(), const TOccupancy& occupancy = TOccupancy())
+		: TBoard(board),
+		TOccupancy(occupancy),
+		m_logger(logger)
+	{}
+
+	bool TryPlace(int64_t x, int64_t y, FacingDirection facingDirection) override;
+	bool TryMove() override;
+	bool TryTurnRight() override;
+	bool TryTurnLeft() override;
+	void ReportPosition(uint64_t& x, uint64_t& y, FacingDirection& facingDirection) const override;
+	void Report(Coordinate& x, Coordinate& y, FacingDirection& facingDirection) const;
+	RobotState SaveState() const override;
+	bool TryRestoreState(const RobotState& state) override;
+
+	Coordinate MaxX() const { return TBoard::MaxX(); }
+	Coordinate MaxY() const { return TBoard::MaxY(); }
+
+	/// <summary>
+	/// Place the robot without logging. Used by the fast execution paths.
+	/// Coordinates outside the board are rejected before they are narrowed to Coordinate.
+	/// </summary>
+	RobotResult Place(int64_t x, int64_t y, FacingDirection facingDirection)
+	{
+		if (m_placed)
+			return rrALREADY_PLACED;
+
+		if (x < 0 || static_cast<uint64_t>(x) > TBoard::MaxX())
+			return rrINVALID_X;
+
+		if (y < 0 || static_cast<uint64_t>(y) > TBoard::MaxY())
+			return rrINVALID_Y;
+
+		if (!TOccupancy::IsFree(x, y))
+			return rrOCCUPIED;
+
+		TOccupancy::Occupy(x, y);
+		m_x = static_cast<Coordinate>(x);
+		m_y = static_cast<Coordinate>(y);
+		m_facingDirection = facingDirection;
+		m_placed = true;
+
+		return rrSUCCESS;
+	}
+
+	/// <summary>
+	/// Move the robot one unit forward without logging.
+	/// The step and the edge check come from RobotTables, so there is no branch on the facing direction.
+	/// The step is sign extended to Coordinate, stepping below zero wraps to a value past the board limit.
+	/// A cell on the board is then checked against the occupancy, and the robot's mark moves along with it.
+	/// </summary>
+	RobotResult Move()
+	{
+		if (!m_placed)
+			return rrNOT_PLACED;
+
+		const auto direction = m_facingDirection & 7;
+		const auto nextX = static_cast<Coordinate>(m_x + static_cast<Coordinate>(static_cast<int8_t>(DeltaX[direction])));
+		const auto nextY = static_cast<Coordinate>(m_y + static_cast<Coordinate>(static_cast<int8_t>(DeltaY[direction])));
+		const bool inside = (nextX <= TBoard::MaxX()) & (nextY <= TBoard::MaxY()) & (IsKnownDirection[direction] != 0);
+		const bool free = inside && TOccupancy::IsFree(nextX, nextY);
+
+		if (free)
+		{
+			TOccupancy::Release(m_x, m_y);
+			TOccupancy::Occupy(nextX, nextY);
+		}
+
+		m_x = free ? nextX : m_x;
+		m_y = free ? nextY : m_y;
+
+		return free ? rrSUCCESS : inside ? rrOCCUPIED : static_cast<RobotResult>(BlockedResult[direction]);
+	}
+
+	/// <summary>
+	/// Move the robot forward steps times without logging, with the same outcome as calling Move steps times.
+	/// Alone on the board the distance to the edge is computed directly, so a run of any length takes constant time.
+	/// With other robots or obstacles the run is walked step by step until the first rejected move.
+	/// </summary>
+	/// <param name="steps">Number of moves</param>
+	/// <param name="rejected">Number of rejected moves. They are always the last ones of the run</param>
+	/// <returns>Result of the rejected moves, or rrSUCCESS if every move succeeded</returns>
+	RobotResult MoveRun(uint64_t steps, uint64_t& rejected)
+	{
+		if constexpr (std::is_same_v<TOccupancy, NoOccupancy>)
+		{
+			if (!m_placed)
+			{
+				rejected = steps;
+				return rrNOT_PLACED;
+			}
+
+			uint64_t moved;
+			switch (m_facingDirection)
+			{
+			case fdNORTH:
+				moved = Clamp(steps, TBoard::MaxY() - m_y);
+				m_y = static_cast<Coordinate>(m_y + moved);
+				break;
+			case fdSOUTH:
+				moved = Clamp(steps, m_y);
+				m_y = static_cast<Coordinate>(m_y - moved);
+				break;
+			case fdEAST:
+				moved = Clamp(steps, TBoard::MaxX() - m_x);
+				m_x = static_cast<Coordinate>(m_x + moved);
+				break;
+			case fdWEST:
+				moved = Clamp(steps, m_x);
+				m_x = static_cast<Coordinate>(m_x - moved);
+				break;
+			default:
+				rejected = steps;
+				return rrUNKNOWN_DIRECTION;
+			}
+
+			rejected = steps - moved;
+			return rejected == 0 ? rrSUCCESS : static_cast<RobotResult>(BlockedResult[m_facingDirection & 7]);
+		}
+		else
+		{
+			for (uint64_t step = 0; step < steps; step++)
+			{
+				const auto result = Move();
+				if (result != rrSUCCESS)
+				{
+					rejected = steps - step;
+					return result;
+				}
+			}
+
+			rejected = 0;
+			return rrSUCCESS;
+		}
+	}
+
+	/// <summary>
+	/// Turn the robot 90 degrees to the left without logging.
+	/// </summary>
+	RobotResult TurnLeft()
+	{
+		return Turn(LeftOf);
+	}
+
+	/// <summary>
+	/// Turn the robot 90 degrees to the right without logging.
+	/// </summary>
+	RobotResult TurnRight()
+	{
+		return Turn(RightOf);
+	}
+
+	/// <summary>
+	/// Log the outcome of a command, exactly as the Try* functions do.
+	/// </summary>
+	/// <param name="cmd">Command that was applied</param>
+	/// <param name="result">Result of the command</param>
+	void LogResult(Command cmd, RobotResult result);
 
 private:
-	uint8_t m_x = 0;
-	uint8_t m_y = 0;
+	static uint64_t Clamp(uint64_t steps, uint64_t room)
+	{
+		return steps < room ? steps : room;
+	}
 
-	const uint8_t m_xmax = 5;
-	const uint8_t m_ymax = 5;
+	RobotResult Turn(const DirectionTable& successor)
+	{
+		if (!m_placed)
+			return rrNOT_PLACED;
+
+		const auto direction = m_facingDirection & 7;
+		m_facingDirection = static_cast<FacingDirection>(successor[direction]);
+
+		return IsKnownDirection[direction] ? rrSUCCESS : rrUNKNOWN_DIRECTION;
+	}
+
+	Coordinate m_x = 0;
+	Coordinate m_y = 0;
 
 	FacingDirection m_facingDirection = fdUNKNOWN;
 	bool m_placed = false;
 
 	LoggerBase& m_logger;
 };
+
+template <typename TBoard, typename TOccupancy>
+bool BasicToyRobot<TBoard, TOccupancy>::TryPlace(int64_t x, int64_t y, FacingDirection facingDirection)
+{
+	const auto result = Place(x, y, facingDirection);
+	LogResult(cmdPLACE, result);
+
+	return result == rrSUCCESS;
+}
+
+template <typename TBoard, typename TOccupancy>
+bool BasicToyRobot<TBoard, TOccupancy>::TryMove()
+{
+	const auto result = Move();
+	LogResult(cmdMOVE, result);
+
+	return result == rrSUCCESS;
+}
+
+template <typename TBoard, typename TOccupancy>
+bool BasicToyRobot<TBoard, TOccupancy>::TryTurnLeft()
+{
+	const auto result = TurnLeft();
+	LogResult(cmdTURN_LEFT, result);
+
+	return result == rrSUCCESS;
+}
+
+template <typename TBoard, typename TOccupancy>
+bool BasicToyRobot<TBoard, TOccupancy>::TryTurnRight()
+{
+	const auto result = TurnRight();
+	LogResult(cmdTURN_RIGHT, result);
+
+	return result == rrSUCCESS;
+}
+
+template <typename TBoard, typename TOccupancy>
+void BasicToyRobot<TBoard, TOccupancy>::ReportPosition(uint64_t& x, uint64_t& y, FacingDirection& facingDirection) const
+{
+	x = m_x;
+	y = m_y;
+	facingDirection = m_facingDirection;
+}
+
+template <typename TBoard, typename TOccupancy>
+void BasicToyRobot<TBoard, TOccupancy>::Report(Coordinate& x, Coordinate& y, FacingDirection& facingDirection) const
+{
+	x = m_x;
+	y = m_y;
+	facingDirection = m_facingDirection;
+}
+
+template <typename TBoard, typename TOccupancy>
+RobotState BasicToyRobot<TBoard, TOccupancy>::SaveState() const
+{
+	return { m_x, m_y, m_facingDirection, m_placed };
+}
+
+template <typename TBoard, typename TOccupancy>
+bool BasicToyRobot<TBoard, TOccupancy>::TryRestoreState(const RobotState& state)
+{
+	if (state.x > TBoard::MaxX() || state.y > TBoard::MaxY())
+		return false;
+
+	if (m_placed)
+		TOccupancy::Release(m_x, m_y);
+
+	if (state.placed && !TOccupancy::IsFree(state.x, state.y))
+	{
+		if (m_placed)
+			TOccupancy::Occupy(m_x, m_y);
+		return false;
+	}
+
+	if (state.placed)
+		TOccupancy::Occupy(state.x, state.y);
+
+	m_x = static_cast<Coordinate>(state.x);
+	m_y = static_cast<Coordinate>(state.y);
+	m_facingDirection = state.facingDirection;
+	m_placed = state.placed;
+
+	return true;
+}
+
+template <typename TBoard, typename TOccupancy>
+void BasicToyRobot<TBoard, TOccupancy>::LogResult(Command cmd, RobotResult result)
+{
+	// Only turns log on success, and only at INFO, so the common case returns without a call.
+	if (result == rrSUCCESS && ((cmd != cmdTURN_LEFT && cmd != cmdTURN_RIGHT) || !m_logger.IsEnabled(llINFO)))
+		return;
+
+	LogRobotResult(m_logger, cmd, result, m_facingDirection, TBoard::MaxX(), TBoard::MaxY());
+}
+
+/// <summary>
+/// Robot on the classic 5x5 board.
+/// </summary>
+using ToyRobot = BasicToyRobot<DefaultBoard>;
+
+/// <summary>
+/// Robot on a board sized at runtime.
+/// </summary>
+using RuntimeToyRobot = BasicToyRobot<RuntimeBoard>;
+
+/// <summary>
+/// Robots sharing a board sized at runtime, with collisions and obstacles tracked in a bitset or a hash set.
+/// </summary>
+using DenseSharedToyRobot = BasicToyRobot<RuntimeBoard, SharedOccupancy<DenseOccupancy>>;
+using SparseSharedToyRobot = BasicToyRobot<RuntimeBoard, SharedOccupancy<SparseOccupancy>>;
+
+// Compiled once in ToyRobot.cpp. Other boards are instantiated where they are used.
+extern template class BasicToyRobot<DefaultBoard>;
+extern template class BasicToyRobot<RuntimeBoard>;
+extern template class BasicToyRobot<RuntimeBoard, SharedOccupancy<DenseOccupancy>>;
+extern template class BasicToyRobot<RuntimeBoard, SharedOccupancy<SparseOccupancy>>;
@@ -0,0 +1,246 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TransitionRunner.h"
+#include "CommandProgram.h"
+#include "MappedFile.h"
+#include "RobotTransition.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    struct Chunk
+    {
+        CommandProgram program;
+        RobotTransition transition;
+        RobotTransition::State start = RobotTransition::Unplaced;
+        std::unique_ptr<BufferLogger> logger;
+    };
+
+    /// <summary>
+    /// Cut the script into pieces of about chunkSize bytes, each ending with a line break or at the end of the script.
+    /// </summary>
+    std::vector<std::string_view> SplitScript(std::string_view script, size_t chunkSize)
+    {
+        std::vector<std::string_view> pieces;
+        size_t begin = 0;
+        while (begin < script.size())
+        {
+            auto end = chunkSize < script.size() - begin ? script.find('\n', begin + chunkSize - 1) : std::string_view::npos;
+            end = end == std::string_view::npos ? script.size() : end + 1;
+            pieces.push_back(script.substr(begin, end - begin));
+            begin = end;
+        }
+
+        return pieces;
+    }
+
+    /// <summary>
+    /// Transition of a compiled program, from every state the robot could start in.
+    /// </summary>
+    RobotTransition BuildTransition(const CommandProgram& program)
+    {
+        TransitionBuilder builder;
+
+        const auto& code = program.Code();
+        const uint8_t* pc = code.data();
+        const uint8_t* const end = pc + code.size();
+        while (pc < end)
+        {
+            const auto cmd = static_cast<Command>(*pc++);
+            switch (cmd)
+            {
+            case cmdMOVE:
+            case cmdTURN_LEFT:
+            case cmdTURN_RIGHT:
+                builder.Apply(cmd);
+                break;
+            case cmdREPORT:
+                break;
+            case cmdPLACE:
+            {
+                int64_t x;
+                int64_t y;
+                std::memcpy(&x, pc, sizeof(x));
+                std::memcpy(&y, pc + sizeof(x), sizeof(y));
+                builder.ApplyPlace(x, y, static_cast<FacingDirection>(pc[2 * sizeof(int64_t)]));
+                pc += CommandProgram::PlacePayloadSize;
+                break;
+            }
+            case cmdCALL:
+            {
+                uint32_t index;
+                std::memcpy(&index, pc, sizeof(index));
+                builder.Apply(program.Blocks()[index].powers[0].Transition());
+                pc += CommandProgram::CallPayloadSize;
+                break;
+            }
+            case cmdREPEAT:
+            {
+                uint64_t count;
+                uint32_t index;
+                std::memcpy(&count, pc, sizeof(count));
+                std::memcpy(&index, pc + sizeof(count), sizeof(index));
+                builder.Apply(program.RepeatEffect(index, count).Transition());
+                pc += CommandProgram::RepeatPayloadSize;
+                break;
+            }
+            case cmdUNKNOWN:
+            default:
+                pc += CommandProgram::ErrorPayloadSize;
+                break;
+            }
+        }
+
+        return builder.Transition();
+    }
+
+    void Write(std::ostream& output, const BufferLogger& logger)
+    {
+        output.write(logger.Buffer().data(), static_cast<std::streamsize>(logger.Buffer().size()));
+    }
+}
+
+void TransitionRunner::Run(std::string_view script, std::ostream& output)
+{
+    const auto pieces = SplitScript(script, m_chunkSize);
+    std::vector<Chunk> chunks(pieces.size());
+
+    WorkStealingPool pool(m_threads);
+    for (size_t idx = 0; idx < chunks.size(); idx++)
+    {
+        pool.Submit([&chunks, &pieces, idx]() {
+            auto& chunk = chunks[idx];
+            chunk.program.CompileText(pieces[idx]);
+            chunk.transition = BuildTransition(chunk.program);
+        });
+    }
+
+    pool.Wait();
+
+    // Blocks and macros can span chunks, a script using them is compiled and run as a single chunk.
+    const auto hasBlockCommands = std::any_of(chunks.begin(), chunks.end(), [](const Chunk& chunk) { return chunk.program.HasBlockCommands(); });
+    if (hasBlockCommands)
+    {
+        chunks.clear();
+        chunks.emplace_back();
+        chunks[0].program.CompileText(script);
+    }
+
+    // Every chunk starts in the state the previous one leaves the robot in. Nothing runs after an EXIT.
+    auto state = RobotTransition::Unplaced;
+    m_chunkCount = chunks.size();
+    for (size_t idx = 0; idx < chunks.size(); idx++)
+    {
+        chunks[idx].start = state;
+        state = chunks[idx].transition.Apply(state);
+        if (chunks[idx].program.IsExited())
+        {
+            m_chunkCount = idx + 1;
+            break;
+        }
+    }
+
+    BufferLogger starting;
+    starting.SetLevel(m_level);
+    starting.Info("Toy robot starting..");
+    Write(output, starting);
+
+    const auto window = 2 * pool.ThreadCount();
+    for (size_t first = 0; first < m_chunkCount; first += window)
+    {
+        const auto last = std::min(first + window, m_chunkCount);
+        for (auto idx = first; idx < last; idx++)
+        {
+            pool.Submit([this, &chunks, idx]() {
+                auto& chunk = chunks[idx];
+                chunk.logger = std::make_unique<BufferLogger>();
+                chunk.logger->SetLevel(m_level);
+
+                ToyRobot robot(*chunk.logger);
+                robot.TryRestoreState(RobotTransition::Decode(chunk.start));
+                ProgramRunner runner(robot, *chunk.logger);
+                if (m_lazy)
+                    runner.RunLazy(chunk.program);
+                else
+                    runner.Run(chunk.program);
+            });
+        }
+
+        pool.Wait();
+
+        for (auto idx = first; idx < last; idx++)
+        {
+            Write(output, *chunks[idx].logger);
+            chunks[idx] = Chunk();
+        }
+    }
+
+    BufferLogger quitting;
+    quitting.SetLevel(m_level);
+    quitting.Info("Toy robot quitting..");
+    Write(output, quitting);
+}
+
+bool TransitionRunner::TryRun(const std::string& inputPath, const std::string& outputPath, std::string& error)
+{
+    MappedFile mappedFile;
+    std::string buffer;
+    std::string_view script;
+    if (mappedFile.TryOpen(inputPath))
+    {
+        script = std::string_view(mappedFile.Data(), mappedFile.Size());
+    }
+    else
+    {
+        std::ifstream input(inputPath, std::ios::binary);
+        if (!input.is_open())
+        {
+            error = "Unable to open the input file: " + inputPath;
+            return false;
+        }
+
+        buffer.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        script = buffer;
+    }
+
+    std::ofstream output(outputPath, std::ios_base::app);
+    if (!output.is_open())
+    {
+        error = "Unable to open the output file: " + outputPath;
+        return false;
+    }
+
+    Run(script, output);
+    output.close();
+    if (!output)
+    {
+        error = "Unable to write the output file: " + outputPath;
+        return false;
+    }
+
+    return true;
+}
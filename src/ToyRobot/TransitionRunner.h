@@ -0,0 +1,80 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include "LogLevel.h"
+
+/// <summary>
+/// Runs one long script on a single robot of the default board, spread over a thread pool (--compose).
+/// The script is cut into chunks at line boundaries. Every chunk is compiled and turned into its transition,
+/// the state it leaves the robot in for each of the 181 states it could start in, all chunks in parallel.
+/// A scan over the transitions then gives the state every chunk really starts in, and the chunks are run
+/// again from those states, in parallel, each into its own log buffer. The buffers are written in chunk
+/// order, so the output is the one of --compile, record for record.
+/// Chunks are run a window at a time, so only the logs of one window are held in memory.
+/// A script with block commands is run as a single chunk, as a block or macro can span chunks.
+/// </summary>
+class TransitionRunner
+{
+public:
+    static const size_t DefaultChunkSize = 4 * 1024 * 1024;
+
+    /// <summary>
+    /// Create the runner.
+    /// </summary>
+    /// <param name="threads">Number of worker threads. Zero uses the number of hardware threads</param>
+    /// <param name="level">Log level of the run</param>
+    /// <param name="lazy">Run the chunks with runs of MOVE and turn commands coalesced, as with --lazy</param>
+    /// <param name="chunkSize">Approximate size of a chunk of the script in bytes</param>
+    TransitionRunner(size_t threads, LogLevel level, bool lazy = false, size_t chunkSize = DefaultChunkSize)
+        : m_threads(threads),
+        m_level(level),
+        m_lazy(lazy),
+        m_chunkSize(chunkSize > 0 ? chunkSize : 1)
+    {}
+
+    /// <summary>
+    /// Run the script and write its log to the stream.
+    /// </summary>
+    void Run(std::string_view script, std::ostream& output);
+
+    /// <summary>
+    /// Run the script of the input file and append its log to the output file.
+    /// </summary>
+    /// <returns>[true] Script is run. [false] A file could not be read or written.</returns>
+    bool TryRun(const std::string& inputPath, const std::string& outputPath, std::string& error);
+
+    /// <summary>
+    /// Number of chunks of the last run, up to the one holding an EXIT.
+    /// </summary>
+    size_t ChunkCount() const { return m_chunkCount; }
+
+private:
+    size_t m_threads;
+    LogLevel m_level;
+    bool m_lazy;
+    size_t m_chunkSize;
+    size_t m_chunkCount = 0;
+};
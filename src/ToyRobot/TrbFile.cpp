@@ -0,0 +1,516 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TrbFile.h"
+#include "CommandProgram.h"
+#include "LineScanner.h"
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+    uint64_t ZigZag(int64_t value)
+    {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t UnZigZag(uint64_t value)
+    {
+        return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+    }
+
+    const char* FacingDirectionName(FacingDirection facingDirection)
+    {
+        switch (facingDirection)
+        {
+        case fdNORTH: return "NORTH";
+        case fdSOUTH: return "SOUTH";
+        case fdEAST: return "EAST";
+        case fdWEST: return "WEST";
+        default: return "UNKNOWN";
+        }
+    }
+
+    /// <summary>
+    /// Map the whole file, or read it into the buffer when it can not be mapped.
+    /// </summary>
+    bool TryLoadFile(const std::string& path, MappedFile& mappedFile, std::string& buffer, const char*& begin, const char*& end)
+    {
+        if (mappedFile.TryOpen(path))
+        {
+            begin = mappedFile.Data();
+            end = begin + mappedFile.Size();
+            return true;
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        begin = buffer.data();
+        end = begin + buffer.size();
+        return true;
+    }
+
+    bool TryWriteFile(const std::string& path, const std::string& data)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        return file.good();
+    }
+}
+
+TrbWriter::TrbWriter(uint64_t maxX, uint64_t maxY)
+{
+    m_data.append(TrbMagic, sizeof(TrbMagic));
+    m_data.push_back(static_cast<char>(TrbVersion));
+    WriteVarint(maxX);
+    WriteVarint(maxY);
+}
+
+void TrbWriter::Write(Command cmd)
+{
+    if (cmd == cmdPLACE)
+    {
+        WriteInvalidPlace({});
+        return;
+    }
+
+    switch (cmd)
+    {
+    case cmdUNKNOWN:
+        WriteCode(TrbExtendedCode);
+        WriteCode(TrbExtendedUnknown);
+        break;
+    case cmdSTATS:
+        WriteCode(TrbExtendedCode);
+        WriteCode(TrbExtendedStats);
+        break;
+    default:
+        WriteCode(static_cast<uint8_t>(cmd));
+        break;
+    }
+
+    m_commandCount++;
+}
+
+void TrbWriter::WritePlace(const PlaceArgs& place)
+{
+    WriteCode(cmdPLACE);
+    FlushBits();
+    m_data.push_back(static_cast<char>(place.facingDirection));
+    WriteVarint(ZigZag(place.x));
+    WriteVarint(ZigZag(place.y));
+    m_commandCount++;
+}
+
+void TrbWriter::WriteInvalidPlace(std::string_view args)
+{
+    WriteCode(cmdPLACE);
+    FlushBits();
+    m_data.push_back(static_cast<char>(TrbInvalidPlace));
+    WriteVarint(args.size());
+    m_data.append(args);
+    m_commandCount++;
+}
+
+void TrbWriter::WriteBlockCommand(Command cmd, std::string_view args)
+{
+    WriteCode(TrbExtendedCode);
+    WriteCode(TrbExtendedBlock);
+    FlushBits();
+    m_data.push_back(static_cast<char>(cmd));
+    WriteVarint(args.size());
+    m_data.append(args);
+    m_commandCount++;
+}
+
+void TrbWriter::WriteLine(std::string_view line)
+{
+    std::string_view args;
+    const auto cmd = CommanderBase::ParseCommand(line, args);
+    if (CommandProgram::IsBlockCommand(cmd))
+    {
+        WriteBlockCommand(cmd, args);
+        return;
+    }
+
+    if (cmd != cmdPLACE)
+    {
+        Write(cmd);
+        return;
+    }
+
+    PlaceArgs place;
+    std::string error;
+    if (CommanderBase::TryParsePlace(args, place, error))
+        WritePlace(place);
+    else
+        WriteInvalidPlace(args);
+}
+
+const std::string& TrbWriter::Finish()
+{
+    // The unused bits of the last byte are zero, which reads back as the end code.
+    FlushBits();
+    return m_data;
+}
+
+void TrbWriter::WriteCode(uint8_t code)
+{
+    m_bits |= static_cast<uint32_t>(code) << m_bitCount;
+    m_bitCount += 3;
+    if (m_bitCount >= 8)
+    {
+        m_data.push_back(static_cast<char>(m_bits & 0xFF));
+        m_bits >>= 8;
+        m_bitCount -= 8;
+    }
+}
+
+void TrbWriter::FlushBits()
+{
+    if (m_bitCount == 0)
+        return;
+
+    m_data.push_back(static_cast<char>(m_bits & 0xFF));
+    m_bits = 0;
+    m_bitCount = 0;
+}
+
+void TrbWriter::WriteVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        m_data.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+
+    m_data.push_back(static_cast<char>(value));
+}
+
+bool TrbReader::TryOpen(const char* begin, const char* end, TrbHeader& header)
+{
+    m_position = reinterpret_cast<const uint8_t*>(begin);
+    m_end = reinterpret_cast<const uint8_t*>(end);
+    m_bits = 0;
+    m_bitCount = 0;
+    m_atEnd = true;
+
+    if (end - begin < static_cast<ptrdiff_t>(sizeof(TrbMagic) + 1) || std::string_view(begin, sizeof(TrbMagic)) != std::string_view(TrbMagic, sizeof(TrbMagic)))
+        return false;
+
+    m_position += sizeof(TrbMagic);
+    header.version = *m_position++;
+    if (header.version < TrbMinVersion || header.version > TrbVersion || !TryReadVarint(header.maxX) || !TryReadVarint(header.maxY))
+        return false;
+
+    m_version = header.version;
+    m_atEnd = false;
+    return true;
+}
+
+Command TrbReader::NextBlockCommand(std::string_view& args)
+{
+    // The payload starts at the next byte. A truncated or damaged one ends the commands.
+    m_bits = 0;
+    m_bitCount = 0;
+    m_atEnd = true;
+    if (m_position == m_end)
+        return cmdEXIT;
+
+    const auto cmd = static_cast<Command>(*m_position++);
+    uint64_t length;
+    if (!CommandProgram::IsBlockCommand(cmd) || !TryReadVarint(length) || length > static_cast<uint64_t>(m_end - m_position))
+        return cmdEXIT;
+
+    args = std::string_view(reinterpret_cast<const char*>(m_position), static_cast<size_t>(length));
+    m_position += length;
+    m_atEnd = false;
+    return cmd;
+}
+
+bool TrbReader::TryReadCode(uint32_t& code)
+{
+    if (m_bitCount < 3)
+    {
+        if (m_position == m_end)
+            return false;
+
+        m_bits |= static_cast<uint32_t>(*m_position++) << m_bitCount;
+        m_bitCount += 8;
+    }
+
+    code = m_bits & 7;
+    m_bits >>= 3;
+    m_bitCount -= 3;
+    return true;
+}
+
+Command TrbReader::Next(PlaceArgs& place, std::string_view& args, bool& placeIsValid)
+{
+    if (m_atEnd)
+        return cmdEXIT;
+
+    uint32_t code;
+    if (!TryReadCode(code))
+    {
+        m_atEnd = true;
+        return cmdEXIT;
+    }
+
+    switch (code)
+    {
+    case 0:
+        m_atEnd = true;
+        return cmdEXIT;
+    case TrbExtendedCode:
+        if (m_version < 2)
+            return cmdUNKNOWN;
+
+        if (!TryReadCode(code))
+        {
+            m_atEnd = true;
+            return cmdEXIT;
+        }
+
+        if (code == TrbExtendedBlock && m_version >= 3)
+            return NextBlockCommand(args);
+
+        return code == TrbExtendedStats ? cmdSTATS : cmdUNKNOWN;
+    case cmdPLACE:
+        break;
+    default:
+        return static_cast<Command>(code);
+    }
+
+    // The payload starts at the next byte, the rest of the current one is padding.
+    m_bits = 0;
+    m_bitCount = 0;
+
+    // A truncated or damaged payload ends the commands, as a truncated text file would.
+    m_atEnd = true;
+    if (m_position == m_end)
+        return cmdEXIT;
+
+    const auto facingDirection = *m_position++;
+    if (facingDirection == TrbInvalidPlace)
+    {
+        uint64_t length;
+        if (!TryReadVarint(length) || length > static_cast<uint64_t>(m_end - m_position))
+            return cmdEXIT;
+
+        args = std::string_view(reinterpret_cast<const char*>(m_position), static_cast<size_t>(length));
+        m_position += length;
+        placeIsValid = false;
+    }
+    else
+    {
+        uint64_t x;
+        uint64_t y;
+        if (facingDirection > fdWEST || !TryReadVarint(x) || !TryReadVarint(y))
+            return cmdEXIT;
+
+        place.x = UnZigZag(x);
+        place.y = UnZigZag(y);
+        place.facingDirection = static_cast<FacingDirection>(facingDirection);
+        placeIsValid = true;
+    }
+
+    m_atEnd = false;
+    return cmdPLACE;
+}
+
+bool TrbReader::TryReadVarint(uint64_t& value)
+{
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && m_position != m_end; shift += 7)
+    {
+        const auto byte = *m_position++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+bool IsTrbFile(const std::string& path)
+{
+    char magic[sizeof(TrbMagic)];
+    std::ifstream file(path, std::ios::binary);
+    return file.read(magic, sizeof(magic)) && std::string_view(magic, sizeof(magic)) == std::string_view(TrbMagic, sizeof(TrbMagic));
+}
+
+bool TryReadTrbHeader(const std::string& path, TrbHeader& header, std::string& error)
+{
+    // Magic, version and two varints of at most 10 bytes each.
+    char data[sizeof(TrbMagic) + 1 + 2 * 10];
+    std::ifstream file(path, std::ios::binary);
+    file.read(data, sizeof(data));
+
+    TrbReader reader;
+    if (!reader.TryOpen(data, data + file.gcount(), header))
+    {
+        error = "Invalid .trb file: " + path;
+        return false;
+    }
+
+    return true;
+}
+
+bool TryConvertToTrb(const std::string& inputPath, const std::string& outputPath, uint64_t maxX, uint64_t maxY, TrbConversion& conversion, std::string& error)
+{
+    MappedFile mappedFile;
+    std::string buffer;
+    const char* begin;
+    const char* end;
+    if (!TryLoadFile(inputPath, mappedFile, buffer, begin, end))
+    {
+        error = "Unable to open the input file: " + inputPath;
+        return false;
+    }
+
+    TrbWriter writer(maxX, maxY);
+    LineScanner scanner(begin, end);
+    std::string_view line;
+    while (scanner.TryNextLine(line))
+        writer.WriteLine(line);
+
+    const auto& data = writer.Finish();
+    if (!TryWriteFile(outputPath, data))
+    {
+        error = "Unable to write the output file: " + outputPath;
+        return false;
+    }
+
+    conversion.commandCount = writer.CommandCount();
+    conversion.inputBytes = static_cast<uint64_t>(end - begin);
+    conversion.outputBytes = data.size();
+    return true;
+}
+
+bool TryConvertFromTrb(const std::string& inputPath, const std::string& outputPath, TrbConversion& conversion, std::string& error)
+{
+    MappedFile mappedFile;
+    std::string buffer;
+    const char* begin;
+    const char* end;
+    if (!TryLoadFile(inputPath, mappedFile, buffer, begin, end))
+    {
+        error = "Unable to open the input file: " + inputPath;
+        return false;
+    }
+
+    TrbReader reader;
+    TrbHeader header;
+    if (!reader.TryOpen(begin, end, header))
+    {
+        error = "Invalid .trb file: " + inputPath;
+        return false;
+    }
+
+    std::string text;
+    conversion.commandCount = 0;
+    for (;;)
+    {
+        PlaceArgs place;
+        std::string_view args;
+        bool placeIsValid;
+        const auto cmd = reader.Next(place, args, placeIsValid);
+        if (reader.AtEnd())
+            break;
+
+        switch (cmd)
+        {
+        case cmdPLACE:
+            if (placeIsValid)
+                text += "PLACE " + std::to_string(place.x) + "," + std::to_string(place.y) + "," + FacingDirectionName(place.facingDirection);
+            else
+                text.append("PLACE").append(args);
+            break;
+        case cmdMOVE:
+            text += "MOVE";
+            break;
+        case cmdTURN_LEFT:
+            text += "LEFT";
+            break;
+        case cmdTURN_RIGHT:
+            text += "RIGHT";
+            break;
+        case cmdREPORT:
+            text += "REPORT";
+            break;
+        case cmdEXIT:
+            text += "EXIT";
+            break;
+        case cmdSTATS:
+            text += "STATS";
+            break;
+        case cmdDEFINE:
+            text.append("DEFINE").append(args);
+            break;
+        case cmdCALL:
+            text.append("CALL").append(args);
+            break;
+        case cmdREPEAT:
+            text.append("REPEAT").append(args);
+            break;
+        case cmdEND_BLOCK:
+            text.append("}").append(args);
+            break;
+        default:
+            text += "UNKNOWN";
+            break;
+        }
+
+        text += '\n';
+        conversion.commandCount++;
+    }
+
+    if (!TryWriteFile(outputPath, text))
+    {
+        error = "Unable to write the output file: " + outputPath;
+        return false;
+    }
+
+    conversion.inputBytes = static_cast<uint64_t>(end - begin);
+    conversion.outputBytes = text.size();
+    return true;
+}
+
+TrbCommander::TrbCommander(const std::string& path, RobotRef robot, LoggerBase& logger)
+    : CommanderBase(robot, logger)
+{
+    const char* begin;
+    const char* end;
+    m_open = TryLoadFile(path, m_mappedFile, m_buffer, begin, end) && m_reader.TryOpen(begin, end, m_header);
+}
+
+bool TrbCommander::TryReadLine(std::string_view& /*input*/)
+{
+    return false;
+}
+
+Command TrbCommander::GetCommand(std::string_view& args)
+{
+    return m_reader.Next(m_place, args, m_placeIsValid);
+}
\ No newline at end of file
@@ -0,0 +1,235 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include "Commander.h"
+#include "Commands.h"
+#include "MappedFile.h"
+
+/// <summary>
+/// Compact binary command file (.trb).
+///
+/// The file starts with the "TRB" magic, a version byte and the largest x and y of the board as varints.
+/// Commands follow as 3 bit codes packed into bytes, least significant bits first. A code is the value of
+/// the Command enum, TrbExtendedCode followed by a second 3 bit code for the commands that do not fit
+/// (TrbExtendedUnknown for a line that is not a command, TrbExtendedStats for STATS), and zero for the end
+/// of the commands. Version 1 files have no second code, TrbExtendedCode alone is an unknown line there.
+/// A PLACE code is followed by its payload starting at the next byte: the facing direction byte, then the
+/// x and y coordinates as zigzag varints. A PLACE line whose arguments do not parse is kept as the
+/// TrbInvalidPlace direction byte followed by the varint length and the raw text of the arguments, so the
+/// reader reports the same error as the text file would.
+/// Since version 3 a block command (DEFINE, CALL, REPEAT or a closing brace) is TrbExtendedCode followed by
+/// TrbExtendedBlock, with a payload starting at the next byte: the Command value as one byte, then the varint
+/// length and the raw text of the arguments. Blocks are compiled when the file is read, as in a text file.
+/// </summary>
+const char TrbMagic[3] = { 'T', 'R', 'B' };
+const uint8_t TrbVersion = 3;
+const uint8_t TrbMinVersion = 1;
+const uint8_t TrbExtendedCode = 7;
+const uint8_t TrbExtendedUnknown = 0;
+const uint8_t TrbExtendedStats = 1;
+const uint8_t TrbExtendedBlock = 2;
+const uint8_t TrbInvalidPlace = 0xFF;
+
+/// <summary>
+/// Header of a .trb file.
+/// </summary>
+struct TrbHeader
+{
+    uint8_t version = TrbVersion;
+    uint64_t maxX = 0;
+    uint64_t maxY = 0;
+};
+
+/// <summary>
+/// Encodes commands into the .trb format in memory.
+/// </summary>
+class TrbWriter
+{
+public:
+    TrbWriter(uint64_t maxX, uint64_t maxY);
+
+    /// <summary>
+    /// Append a command without arguments. cmdUNKNOWN is kept as an unrecognised line.
+    /// </summary>
+    void Write(Command cmd);
+
+    /// <summary>
+    /// Append a PLACE command with parsed arguments.
+    /// </summary>
+    void WritePlace(const PlaceArgs& place);
+
+    /// <summary>
+    /// Append a PLACE command whose arguments do not parse, keeping their text.
+    /// </summary>
+    void WriteInvalidPlace(std::string_view args);
+
+    /// <summary>
+    /// Append a block command, keeping the text of its arguments.
+    /// </summary>
+    void WriteBlockCommand(Command cmd, std::string_view args);
+
+    /// <summary>
+    /// Parse a text line the same way the file commander does, and append it.
+    /// </summary>
+    void WriteLine(std::string_view line);
+
+    /// <summary>
+    /// Terminate the commands and get the encoded file. No command can be written after it.
+    /// </summary>
+    const std::string& Finish();
+
+    uint64_t CommandCount() const { return m_commandCount; }
+
+private:
+    void WriteCode(uint8_t code);
+    void FlushBits();
+    void WriteVarint(uint64_t value);
+
+    std::string m_data;
+    uint32_t m_bits = 0;
+    unsigned m_bitCount = 0;
+    uint64_t m_commandCount = 0;
+};
+
+/// <summary>
+/// Decodes the commands of a .trb file held in memory.
+/// </summary>
+class TrbReader
+{
+public:
+    /// <summary>
+    /// Try to read the header at the start of the buffer. The buffer must outlive the reader.
+    /// </summary>
+    /// <returns>[true] Header is valid. [false] Buffer is not a .trb file of a supported version.</returns>
+    bool TryOpen(const char* begin, const char* end, TrbHeader& header);
+
+    /// <summary>
+    /// Decode the next command. cmdEXIT is returned at the end of the commands.
+    /// </summary>
+    /// <param name="place">Arguments of a PLACE command when placeIsValid is set</param>
+    /// <param name="args">Raw text of the arguments of a block command, or of a PLACE command when placeIsValid is not set</param>
+    /// <param name="placeIsValid">Whether the PLACE arguments were parsed when the file was written</param>
+    /// <returns>The command</returns>
+    Command Next(PlaceArgs& place, std::string_view& args, bool& placeIsValid);
+
+    /// <summary>
+    /// Whether the end of the commands was reached.
+    /// </summary>
+    bool AtEnd() const { return m_atEnd; }
+
+private:
+    bool TryReadCode(uint32_t& code);
+    bool TryReadVarint(uint64_t& value);
+
+    /// <summary>
+    /// Decode the payload of a block command.
+    /// </summary>
+    Command NextBlockCommand(std::string_view& args);
+
+    const uint8_t* m_position = nullptr;
+    const uint8_t* m_end = nullptr;
+    uint32_t m_bits = 0;
+    unsigned m_bitCount = 0;
+    uint8_t m_version = TrbVersion;
+    bool m_atEnd = true;
+};
+
+/// <summary>
+/// Sizes of a converted file.
+/// </summary>
+struct TrbConversion
+{
+    uint64_t commandCount = 0;
+    uint64_t inputBytes = 0;
+    uint64_t outputBytes = 0;
+};
+
+/// <summary>
+/// Whether the file starts with the .trb magic.
+/// </summary>
+bool IsTrbFile(const std::string& path);
+
+/// <summary>
+/// Try to read the header of a .trb file.
+/// </summary>
+bool TryReadTrbHeader(const std::string& path, TrbHeader& header, std::string& error);
+
+/// <summary>
+/// Convert a text command file into a .trb file.
+/// </summary>
+/// <param name="inputPath">Path of the text file</param>
+/// <param name="outputPath">Path of the .trb file</param>
+/// <param name="maxX">Largest x coordinate of the board, stored in the header</param>
+/// <param name="maxY">Largest y coordinate of the board, stored in the header</param>
+/// <param name="conversion">Number of commands and sizes of both files</param>
+/// <param name="error">Error message if the conversion failed</param>
+/// <returns>[true] File is converted. [false] A file could not be read or written.</returns>
+bool TryConvertToTrb(const std::string& inputPath, const std::string& outputPath, uint64_t maxX, uint64_t maxY, TrbConversion& conversion, std::string& error);
+
+/// <summary>
+/// Convert a .trb file back into a text command file, one command per line in upper case.
+/// </summary>
+/// <returns>[true] File is converted. [false] A file could not be read or written, or the input is not a .trb file.</returns>
+bool TryConvertFromTrb(const std::string& inputPath, const std::string& outputPath, TrbConversion& conversion, std::string& error);
+
+/// <summary>
+/// Commander reading a .trb file. Commands are decoded straight from the memory mapping, without any
+/// text parsing. Files which can not be mapped are read into memory first.
+/// </summary>
+class TrbCommander : public CommanderBase
+{
+public:
+    TrbCommander(const std::string& path, RobotRef robot, LoggerBase& logger);
+
+    /// <summary>
+    /// Copy constructor is not allowed
+    /// </summary>
+    TrbCommander(const TrbCommander&) = delete;
+
+    /// <summary>
+    /// Whether the file could be read and has a valid header.
+    /// </summary>
+    bool IsOpen() const { return m_open; }
+
+    const TrbHeader& Header() const { return m_header; }
+
+protected:
+    /// <summary>
+    /// Lines are never read, the commands are decoded by GetCommand.
+    /// </summary>
+    bool TryReadLine(std::string_view& input) override;
+    Command GetCommand(std::string_view& args) override;
+    const PlaceArgs* ParsedPlace() const override { return m_placeIsValid ? &m_place : nullptr; }
+
+private:
+    MappedFile m_mappedFile;
+    std::string m_buffer;
+    TrbReader m_reader;
+    TrbHeader m_header;
+    bool m_open = false;
+
+    PlaceArgs m_place;
+    bool m_placeIsValid = false;
+};
\ No newline at end of file
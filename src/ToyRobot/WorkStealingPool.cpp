@@ -0,0 +1,147 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "WorkStealingPool.h"
+
+namespace
+{
+    /// <summary>
+    /// Pool and index of the worker running on this thread. The pool is null outside of any worker.
+    /// </summary>
+    thread_local const WorkStealingPool* t_pool = nullptr;
+    thread_local size_t t_workerIndex = 0;
+}
+
+WorkStealingPool::WorkStealingPool(size_t threads)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+
+    if (threads == 0)
+        threads = 1;
+
+    for (size_t idx = 0; idx < threads; idx++)
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+
+    for (size_t idx = 0; idx < threads; idx++)
+        m_workers.emplace_back(&WorkStealingPool::WorkerLoop, this, idx);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    Wait();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_workAvailable.notify_all();
+
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+void WorkStealingPool::Submit(Task task)
+{
+    const auto index = t_pool == this
+        ? t_workerIndex
+        : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    // The counter is updated under the pool mutex, so a worker going to sleep can not miss it.
+    // It is raised before the task is queued, so it never drops below the number of queued tasks.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queued.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    {
+        auto& queue = *m_queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    m_workAvailable.notify_one();
+}
+
+void WorkStealingPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_allDone.wait(lock, [this]() { return m_pending.load(std::memory_order_acquire) == 0; });
+}
+
+bool WorkStealingPool::TryPopLocal(size_t index, Task& task)
+{
+    auto& queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::TrySteal(size_t thief, Task& task)
+{
+    const auto count = m_queues.size();
+    for (size_t offset = 1; offset < count; offset++)
+    {
+        auto& queue = *m_queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            continue;
+
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        m_stolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
+
+void WorkStealingPool::WorkerLoop(size_t index)
+{
+    t_pool = this;
+    t_workerIndex = index;
+
+    for (;;)
+    {
+        Task task;
+        if (TryPopLocal(index, task) || TrySteal(index, task))
+        {
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+            task();
+
+            if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_workAvailable.wait(lock, [this]() { return m_stop || m_queued.load(std::memory_order_relaxed) > 0; });
+        if (m_stop && m_queued.load(std::memory_order_relaxed) == 0)
+            return;
+    }
+}
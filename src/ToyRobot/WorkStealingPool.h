@@ -0,0 +1,100 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Thread pool where every worker has its own task queue and idle workers steal from the others.
+/// A worker takes its own tasks from the front, in the order they were submitted, and steals from the
+/// back of another worker's queue. When tasks are submitted largest first, every worker runs its largest
+/// work first and only the smallest tasks are left to balance the end of the run.
+/// </summary>
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    /// <summary>
+    /// Start the workers.
+    /// </summary>
+    /// <param name="threads">Number of workers. Zero uses the number of hardware threads</param>
+    explicit WorkStealingPool(size_t threads = 0);
+
+    /// <summary>
+    /// Copy constructor is not allowed
+    /// </summary>
+    WorkStealingPool(const WorkStealingPool&) = delete;
+
+    /// <summary>
+    /// Wait for the queued tasks and stop the workers.
+    /// </summary>
+    ~WorkStealingPool();
+
+    /// <summary>
+    /// Queue a task. From a worker the task goes to that worker's queue, otherwise the queues are
+    /// filled in turn.
+    /// </summary>
+    void Submit(Task task);
+
+    /// <summary>
+    /// Wait until every submitted task has finished.
+    /// </summary>
+    void Wait();
+
+    size_t ThreadCount() const { return m_queues.size(); }
+
+    /// <summary>
+    /// Number of tasks that were run by a worker other than the one they were queued on.
+    /// </summary>
+    size_t StolenCount() const { return m_stolen.load(std::memory_order_relaxed); }
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(size_t index);
+    bool TryPopLocal(size_t index, Task& task);
+    bool TrySteal(size_t thief, Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_allDone;
+
+    std::atomic<size_t> m_pending{ 0 };
+    std::atomic<size_t> m_queued{ 0 };
+    std::atomic<size_t> m_stolen{ 0 };
+    std::atomic<size_t> m_nextQueue{ 0 };
+    bool m_stop = false;
+};
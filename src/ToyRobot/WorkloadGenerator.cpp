@@ -0,0 +1,266 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "WorkloadGenerator.h"
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+    const char* const KindNames[wlCOUNT] = { "move", "left", "right", "report", "place", "unknown" };
+
+    /// <summary>
+    /// Fixed lines, padded to 8 bytes so that they are copied as a single word.
+    /// </summary>
+    struct FixedLine
+    {
+        char text[8];
+        size_t length;
+    };
+
+    const FixedLine FixedLines[wlCOUNT] = {
+        { { 'M', 'O', 'V', 'E', '\n' }, 5 },
+        { { 'L', 'E', 'F', 'T', '\n' }, 5 },
+        { { 'R', 'I', 'G', 'H', 'T', '\n' }, 6 },
+        { { 'R', 'E', 'P', 'O', 'R', 'T', '\n' }, 7 },
+        { {}, 0 },
+        { { 'J', 'U', 'M', 'P', '\n' }, 5 }
+    };
+
+    const FixedLine PlacePrefix = { { 'P', 'L', 'A', 'C', 'E', ' ' }, 6 };
+
+    /// <summary>
+    /// Facing directions closing a PLACE line, in the order of the direction draw.
+    /// </summary>
+    const FixedLine Directions[4] = {
+        { { ',', 'N', 'O', 'R', 'T', 'H', '\n' }, 7 },
+        { { ',', 'S', 'O', 'U', 'T', 'H', '\n' }, 7 },
+        { { ',', 'E', 'A', 'S', 'T', '\n' }, 6 },
+        { { ',', 'W', 'E', 'S', 'T', '\n' }, 6 }
+    };
+
+    /// <summary>
+    /// Malformed PLACE commands, one per error message of CommanderBase::TryParsePlace.
+    /// </summary>
+    const char* const InvalidPlaces[] = {
+        "PLACE\n",
+        "PLACE 1,2\n",
+        "PLACE x,2,NORTH\n",
+        "PLACE 1,99999999999999999999,EAST\n",
+        "PLACE 1,2,UP\n",
+        "PLACE -1,0,WEST\n"
+    };
+
+    char* Append(char* out, const FixedLine& line)
+    {
+        std::memcpy(out, line.text, sizeof(line.text));
+        return out + line.length;
+    }
+
+    char* Append(char* out, const char* text)
+    {
+        const auto length = std::strlen(text);
+        std::memcpy(out, text, length);
+        return out + length;
+    }
+}
+
+bool TryParseWorkloadMix(const std::string& mix, unsigned (&weights)[wlCOUNT], std::string& error)
+{
+    for (auto& weight : weights)
+        weight = 0;
+
+    size_t position = 0;
+    while (position < mix.size())
+    {
+        auto end = mix.find(',', position);
+        if (end == std::string::npos)
+            end = mix.size();
+
+        const auto item = mix.substr(position, end - position);
+        const auto separator = item.find('=');
+        auto found = false;
+        for (auto kind = 0; kind < wlCOUNT && separator != std::string::npos; kind++)
+        {
+            if (item.compare(0, separator, KindNames[kind]) != 0)
+                continue;
+
+            const auto value = item.data() + separator + 1;
+            const auto result = std::from_chars(value, item.data() + item.size(), weights[kind]);
+            found = result.ec == std::errc() && result.ptr == item.data() + item.size() && result.ptr != value;
+        }
+
+        if (!found)
+        {
+            error = "Invalid mix entry: " + item + ". Expected kind=weight, where kind is move, left, right, report, place or unknown.";
+            return false;
+        }
+
+        position = end + 1;
+    }
+
+    unsigned total = 0;
+    for (const auto weight : weights)
+        total += weight;
+
+    if (total == 0)
+    {
+        error = "At least one line kind needs a weight above zero.";
+        return false;
+    }
+
+    return true;
+}
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadOptions& options)
+    : m_options(options),
+    m_kinds(65536),
+    m_state(options.seed),
+    m_placeNext(options.initialPlace)
+{
+    // Give every kind a share of the table in proportion to its weight, the rounding left over goes to the
+    // heaviest kind.
+    uint64_t total = 0;
+    auto heaviest = 0;
+    for (auto kind = 0; kind < wlCOUNT; kind++)
+    {
+        total += options.weights[kind];
+        if (options.weights[kind] > options.weights[heaviest])
+            heaviest = kind;
+    }
+
+    size_t filled = 0;
+    for (auto kind = 0; kind < wlCOUNT && total != 0; kind++)
+    {
+        const auto share = static_cast<size_t>(options.weights[kind] * m_kinds.size() / total);
+        std::memset(m_kinds.data() + filled, kind, share);
+        filled += share;
+    }
+
+    std::memset(m_kinds.data() + filled, heaviest, m_kinds.size() - filled);
+}
+
+uint64_t WorkloadGenerator::NextRandom()
+{
+    // splitmix64: tiny state, passes BigCrush, and gives the same numbers on every platform.
+    auto value = (m_state += 0x9E3779B97F4A7C15ull);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+uint64_t WorkloadGenerator::Below(uint64_t range)
+{
+    // Multiply and shift instead of a 64 bit division, which would cost more than the rest of the line.
+    const auto random = NextRandom();
+    return range <= UINT32_MAX ? ((random >> 32) * range) >> 32 : random % range;
+}
+
+size_t WorkloadGenerator::Fill(char* buffer, size_t capacity, uint64_t& lines)
+{
+    // The loop state is kept in locals: the lines are written through a char pointer, which may alias any member.
+    auto out = buffer;
+    const auto last = capacity >= MaxLineLength ? buffer + capacity - MaxLineLength : buffer;
+    auto remaining = lines;
+    auto kindBits = m_kindBits;
+    auto kindDraws = m_kindDraws;
+    uint64_t counts[wlCOUNT] = {};
+
+    if (m_placeNext && out < last && remaining > 0)
+    {
+        m_placeNext = false;
+        remaining--;
+        counts[wlPLACE]++;
+        out = WritePlace(out);
+    }
+
+    const auto kinds = m_kinds.data();
+    while (out < last && remaining > 0)
+    {
+        remaining--;
+        if (kindDraws == 0)
+        {
+            kindBits = NextRandom();
+            kindDraws = 4;
+        }
+
+        const auto kind = kinds[kindBits & 0xFFFF];
+        kindBits >>= 16;
+        kindDraws--;
+        counts[kind]++;
+
+        if (kind != wlPLACE)
+        {
+            std::memcpy(out, FixedLines[kind].text, sizeof(FixedLines[kind].text));
+            out += FixedLines[kind].length;
+        }
+        else
+        {
+            out = Chance(m_options.invalidPlaceRate) ? WriteInvalidPlace(out) : WritePlace(out);
+        }
+    }
+
+    lines = remaining;
+    m_kindBits = kindBits;
+    m_kindDraws = kindDraws;
+    for (auto kind = 0; kind < wlCOUNT; kind++)
+        m_counts[kind] += counts[kind];
+
+    return static_cast<size_t>(out - buffer);
+}
+
+char* WorkloadGenerator::WritePlace(char* out)
+{
+    uint64_t x;
+    uint64_t y;
+    unsigned direction;
+    if (Chance(m_options.edgeRate))
+    {
+        // Facing off the board from a cell of that edge.
+        direction = static_cast<unsigned>(NextRandom() & 3);
+        x = direction == 2 ? m_options.maxX : direction == 3 ? 0 : Below(m_options.maxX + 1);
+        y = direction == 0 ? m_options.maxY : direction == 1 ? 0 : Below(m_options.maxY + 1);
+    }
+    else
+    {
+        x = Below(m_options.maxX + 1);
+        y = Below(m_options.maxY + 1);
+        direction = static_cast<unsigned>(NextRandom() & 3);
+    }
+
+    out = Append(out, PlacePrefix);
+    out = std::to_chars(out, out + 20, x).ptr;
+    *out++ = ',';
+    out = std::to_chars(out, out + 20, y).ptr;
+    return Append(out, Directions[direction]);
+}
+
+char* WorkloadGenerator::WriteInvalidPlace(char* out)
+{
+    const auto count = sizeof(InvalidPlaces) / sizeof(InvalidPlaces[0]);
+    const auto variant = Below(count + 1);
+    if (variant < count)
+        return Append(out, InvalidPlaces[variant]);
+
+    // Well formed, one past the edge of the board.
+    out = Append(out, PlacePrefix);
+    out = std::to_chars(out, out + 20, m_options.maxX + 1).ptr;
+    return Append(out, ",0,NORTH\n");
+}
@@ -0,0 +1,126 @@
+/*
+ *	The MIT License (MIT)
+ *	Copyright  2021 Kushan Fernando (info@kushan.me)
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the Software),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is furnished
+ *  to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *  INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *  PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ *  FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Kinds of lines written by the workload generator.
+/// </summary>
+enum WorkloadLine
+{
+    wlMOVE = 0,
+    wlLEFT = 1,
+    wlRIGHT = 2,
+    wlREPORT = 3,
+    wlPLACE = 4,
+    wlUNKNOWN = 5,
+    wlCOUNT = 6
+};
+
+/// <summary>
+/// Shape of a generated workload. The same options always generate the same lines.
+/// </summary>
+struct WorkloadOptions
+{
+    uint64_t seed = 1;
+
+    /// <summary>
+    /// Largest coordinates of the board the PLACE commands aim at.
+    /// </summary>
+    uint64_t maxX = 5;
+    uint64_t maxY = 5;
+
+    /// <summary>
+    /// Relative weights of the line kinds, indexed by WorkloadLine.
+    /// </summary>
+    unsigned weights[wlCOUNT] = { 60, 10, 10, 5, 5, 0 };
+
+    /// <summary>
+    /// Fraction of the valid PLACE commands put on a random edge, facing off the board,
+    /// so that the following MOVEs are refused with the edge warnings.
+    /// </summary>
+    double edgeRate = 0;
+
+    /// <summary>
+    /// Fraction of the PLACE commands that are malformed or off the board, which exercise the PLACE error paths.
+    /// </summary>
+    double invalidPlaceRate = 0;
+
+    /// <summary>
+    /// Whether the first line is a valid PLACE, so that the robot is on the board from the start.
+    /// </summary>
+    bool initialPlace = true;
+};
+
+/// <summary>
+/// Try to read line weights in the form of "move=60,left=10,report=5". Kinds that are not named get no lines.
+/// </summary>
+/// <returns>[true] Weights are read. [false] A kind or a weight is invalid, or every weight is zero.</returns>
+bool TryParseWorkloadMix(const std::string& mix, unsigned (&weights)[wlCOUNT], std::string& error);
+
+/// <summary>
+/// Deterministic generator of command scripts for load tests.
+/// Line kinds are drawn from a 64K entry table built from the weights, four draws per 64 bit random number,
+/// and fixed lines are copied as whole words, so a script is produced at close to memory speed.
+/// </summary>
+class WorkloadGenerator
+{
+public:
+    /// <summary>
+    /// Longest line the generator writes, line terminator included.
+    /// </summary>
+    static const size_t MaxLineLength = 64;
+
+    explicit WorkloadGenerator(const WorkloadOptions& options);
+
+    /// <summary>
+    /// Write lines into the buffer until it is full or no line is left. The output does not depend on how it is
+    /// split into calls.
+    /// </summary>
+    /// <param name="buffer">Buffer receiving the lines</param>
+    /// <param name="capacity">Size of the buffer. Lines are written while at least MaxLineLength bytes are free</param>
+    /// <param name="lines">Number of lines left to write, decreased by the lines written</param>
+    /// <returns>Number of bytes written</returns>
+    size_t Fill(char* buffer, size_t capacity, uint64_t& lines);
+
+    /// <summary>
+    /// Number of lines written so far, per kind.
+    /// </summary>
+    const uint64_t* Counts() const { return m_counts; }
+
+private:
+    uint64_t NextRandom();
+    uint64_t Below(uint64_t range);
+    bool Chance(double rate) { return rate > 0 && static_cast<double>(NextRandom() >> 11) * 0x1.0p-53 < rate; }
+    char* WritePlace(char* out);
+    char* WriteInvalidPlace(char* out);
+
+    WorkloadOptions m_options;
+    std::vector<uint8_t> m_kinds;
+    uint64_t m_state;
+    uint64_t m_kindBits = 0;
+    unsigned m_kindDraws = 0;
+    bool m_placeNext;
+    uint64_t m_counts[wlCOUNT] = {};
+};
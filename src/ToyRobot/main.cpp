@@ -18,38 +18,394 @@
  *  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include "ToyRobot.h"
 #include "Logger.h"
 #include "Commander.h"
+#include "CommandProgram.h"
+#include "Journal.h"
+#include "LockstepRunner.h"
+#include "Options.h"
+#include "ParallelRunner.h"
+#include "PipelinedCommander.h"
+#include "ResultSink.h"
+#include "RobotServer.h"
+#include "TransitionRunner.h"
+#include "TrbFile.h"
+
+namespace
+{
+    /// <summary>
+    /// Run the input file, or the console when there is no input file, on a robot of the given type.
+    /// </summary>
+    template <typename TRobot>
+    int RunRobot(const ProgramOptions& options, const typename TRobot::Board& board, const typename TRobot::Occupancy& occupancy)
+    {
+        // A resumed run continues its outputs from the checkpoint, before anything opens them.
+        if (options.resume)
+        {
+            std::string error;
+            if (!JournalWriter::TryRewindOutputs(options.journal, options.files[1], options.results, error))
+            {
+                std::cout << error << std::endl;
+                return -1;
+            }
+        }
+
+        // The REPORT results go to a file of their own, the log keeps the diagnostics.
+        std::unique_ptr<ResultSink> resultSink;
+        if (!options.results.empty())
+        {
+            resultSink = std::make_unique<ResultSink>(options.results, options.resultFormat, options.resume ? roCONTINUE : roREPLACE);
+            if (!resultSink->IsOpen())
+            {
+                std::cout << "Unable to create the result file: " << options.results << std::endl;
+                return -1;
+            }
+        }
+
+        if (!options.files.empty())
+        {
+            std::string inputFile(options.files[0]);
+            std::string outputFile(options.files[1]);
+
+            FileLogger fileLogger(outputFile, options.logOptions);
+            fileLogger.SetLevel(options.logLevel);
+            TRobot robot(fileLogger, board, occupancy);
+            StatementRunner<TRobot> statementRunner(robot);
+
+            if (options.compile)
+            {
+                CommandProgram program;
+                if (!program.TryCompileFile(inputFile))
+                {
+                    fileLogger.Error("Unable to open the input file: " + inputFile);
+                    return -1;
+                }
+
+                fileLogger.Info("Toy robot starting..");
+                BasicProgramRunner<TRobot> runner(robot, fileLogger);
+                runner.SetResultSink(resultSink.get());
+                if (options.lazy)
+                    runner.RunLazy(program);
+                else
+                    runner.Run(program);
+                fileLogger.Info("Toy robot quitting..");
+            }
+            else if (options.pipeline)
+            {
+                PipelinedCommander commander(inputFile, robot, fileLogger);
+                commander.SetResultSink(resultSink.get());
+                commander.SetStatementRunner(&statementRunner);
+                commander.Launch();
+            }
+            else if (IsTrbFile(inputFile))
+            {
+                TrbCommander commander(inputFile, robot, fileLogger);
+                commander.SetResultSink(resultSink.get());
+                commander.SetStatementRunner(&statementRunner);
+                commander.Launch();
+            }
+            else
+            {
+                FileCommander commander(inputFile, robot, fileLogger);
+                commander.SetResultSink(resultSink.get());
+                commander.SetStatementRunner(&statementRunner);
+                if (options.journal.empty())
+                {
+                    commander.Launch();
+                    return 0;
+                }
+
+                JournalWriter journal(options.journal, robot, options.journalOptions);
+                journal.SetOutputs(&fileLogger, resultSink.get());
+                auto finished = false;
+                std::string error;
+                if (!journal.TryOpen(commander, inputFile, options.resume, finished, error))
+                {
+                    fileLogger.Error(error);
+                    return -1;
+                }
+
+                if (finished)
+                {
+                    fileLogger.Info("The journaled run already finished. Nothing to resume.");
+                    return 0;
+                }
+
+                commander.SetJournal(&journal);
+                commander.Launch();
+            }
+        }
+        else if (options.pipeline)
+        {
+            // The file logger writes stdout on its own thread, next to the reader and the parser.
+            FileLogger streamLogger(std::cout, options.logOptions);
+            streamLogger.SetLevel(options.logLevel);
+            TRobot robot(streamLogger, board, occupancy);
+            StatementRunner<TRobot> statementRunner(robot);
+
+            PipelinedCommander commander(std::cin, robot, streamLogger);
+            commander.SetResultSink(resultSink.get());
+            commander.SetStatementRunner(&statementRunner);
+            commander.Launch();
+        }
+        else
+        {
+            ConsoleLogger logger;
+            logger.SetLevel(options.logLevel);
+            TRobot robot(logger, board, occupancy);
+            StatementRunner<TRobot> statementRunner(robot);
+
+            if (options.pipe)
+            {
+                PipeCommander commander(std::cin, robot, logger);
+                commander.SetResultSink(resultSink.get());
+                commander.SetStatementRunner(&statementRunner);
+                commander.Launch();
+            }
+            else
+            {
+                ConsoleCommander commander(robot, logger);
+                commander.SetResultSink(resultSink.get());
+                commander.SetStatementRunner(&statementRunner);
+                commander.Launch();
+            }
+        }
+
+        return 0;
+    }
+
+    /// <summary>
+    /// Convert the input file between the text and the binary command formats.
+    /// </summary>
+    int Convert(const ProgramOptions& options)
+    {
+        const auto& inputFile = options.files[0];
+        const auto& outputFile = options.files[1];
+        const auto toBinary = outputFile.size() >= 4 && outputFile.compare(outputFile.size() - 4, 4, ".trb") == 0;
+
+        TrbConversion conversion;
+        std::string error;
+        const auto converted = toBinary
+            ? TryConvertToTrb(inputFile, outputFile, options.boardMaxX, options.boardMaxY, conversion, error)
+            : TryConvertFromTrb(inputFile, outputFile, conversion, error);
+        if (!converted)
+        {
+            std::cout << error << std::endl;
+            return -1;
+        }
+
+        std::cout << "Converted " << conversion.commandCount << " commands: " << conversion.inputBytes << " bytes -> "
+            << conversion.outputBytes << " bytes." << std::endl;
+        return 0;
+    }
+
+    /// <summary>
+    /// Take the board of a .trb input file from its header. An explicit --board must match it.
+    /// </summary>
+    bool TryApplyTrbBoard(ProgramOptions& options, std::string& error)
+    {
+        TrbHeader header;
+        if (!TryReadTrbHeader(options.files[0], header, error))
+            return false;
+
+        if (options.compile || options.compose || options.pipeline || !options.journal.empty())
+        {
+            error = "The --compile, --lazy, --compose, --pipeline and --journal options can not be used with a .trb input file.";
+            return false;
+        }
+
+        if (header.maxX == 0 || header.maxY == 0 || header.maxX > (uint64_t(1) << 32) || header.maxY > (uint64_t(1) << 32)
+            || (!options.IsDefaultBoard() && (header.maxX != options.boardMaxX || header.maxY != options.boardMaxY)))
+        {
+            error = "The board of the input file is " + std::to_string(header.maxX) + "x" + std::to_string(header.maxY) + ".";
+            return false;
+        }
+
+        options.boardMaxX = header.maxX;
+        options.boardMaxY = header.maxY;
+        return true;
+    }
+
+    /// <summary>
+    /// Serve robot sessions until SIGINT or SIGTERM.
+    /// </summary>
+    int Serve(const ProgramOptions& options)
+    {
+        auto serverOptions = options.server;
+        serverOptions.logLevel = options.logLevel;
+
+        RobotServer::BlockShutdownSignals();
+        RobotServer server(serverOptions);
+        std::string error;
+        if (!server.TryStart(error))
+        {
+            std::cout << error << std::endl;
+            return -1;
+        }
+
+        std::cout << "Toy robot server listening on " << serverOptions.address << ". Press Ctrl+C to stop." << std::endl;
+        RobotServer::WaitForShutdownSignal();
+        server.Stop();
+
+        const auto stats = server.Stats();
+        std::cout << "Served " << stats.sessions << " sessions, " << stats.commands << " commands, "
+            << stats.bytesIn << " bytes in, " << stats.bytesOut << " bytes out." << std::endl;
+        return 0;
+    }
+
+    /// <summary>
+    /// Largest bitset used for the obstacles. Larger boards keep the obstacles in a hash set.
+    /// </summary>
+    const uint64_t MaxDenseOccupancyBytes = 64 * 1024 * 1024;
+
+    /// <summary>
+    /// Run the robot on a board with the obstacles of the map file.
+    /// </summary>
+    int RunWithObstacles(const ProgramOptions& options)
+    {
+        std::vector<std::pair<uint64_t, uint64_t>> obstacles;
+        std::string error;
+        if (!TryReadObstacleMap(options.obstacleMap, options.boardMaxX, options.boardMaxY, obstacles, error))
+        {
+            std::cout << error << std::endl;
+            return -1;
+        }
+
+        const RuntimeBoard board(options.boardMaxX, options.boardMaxY);
+        if (DenseOccupancy::Fits(options.boardMaxX, options.boardMaxY, MaxDenseOccupancyBytes))
+        {
+            DenseOccupancy index(options.boardMaxX, options.boardMaxY);
+            for (const auto& cell : obstacles)
+                index.Occupy(cell.first, cell.second);
+
+            return RunRobot<DenseSharedToyRobot>(options, board, SharedOccupancy<DenseOccupancy>(index));
+        }
+
+        SparseOccupancy index;
+        index.Reserve(obstacles.size() + 1);
+        for (const auto& cell : obstacles)
+            index.Occupy(cell.first, cell.second);
+
+        return RunRobot<SparseSharedToyRobot>(options, board, SharedOccupancy<SparseOccupancy>(index));
+    }
+}
 
 int main(int argc, char** argv)
 {
-    if (argc > 1)
+    ProgramOptions options;
+    std::string error;
+    if (!TryParseOptions(argc, argv, options, error))
+    {
+        std::cout << error << std::endl;
+        return -1;
+    }
+
+    if (options.pipe)
+    {
+        // Nothing is printed yet, so the standard streams can still be unsynced from stdio.
+        std::ios::sync_with_stdio(false);
+        std::cin.tie(nullptr);
+    }
+
+    if (options.parallel)
     {
-        if (argc != 3)
+        std::vector<std::string> inputs(options.files.begin(), options.files.end() - 1);
+        std::vector<std::string> files;
+        if (!TryExpandInputs(inputs, files, error))
         {
-            std::cout << "Invalid number of arguments. Console aruments should be in the form of '>toyrobot.exe inputfile.txt outputfile.txt'" << std::endl;
+            std::cout << error << std::endl;
             return -1;
         }
 
-        std::string inputFile(argv[1]);
-        std::string outputFile(argv[2]);
+        const auto start = std::chrono::steady_clock::now();
+        ParallelRunner runner(options.threads, options.compile, options.logLevel);
+        const auto results = runner.Run(files, options.files.back());
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        size_t failed = 0;
+        uintmax_t bytes = 0;
+        double busySeconds = 0;
+        for (const auto& result : results)
+        {
+            if (result.succeeded)
+                std::cout << "OK     " << result.inputFile << " -> " << result.outputFile << " (" << result.seconds * 1000 << " ms)\n";
+            else
+                std::cout << "FAILED " << result.inputFile << ": " << result.error << "\n";
+
+            failed += result.succeeded ? 0 : 1;
+            bytes += result.size;
+            busySeconds += result.seconds;
+        }
+
+        std::cout << "Processed " << results.size() << " files (" << failed << " failed, " << bytes << " bytes) in "
+            << seconds << " s. " << (seconds > 0 ? results.size() / seconds : 0) << " files/s, "
+            << busySeconds << " s of work, " << runner.StolenCount() << " stolen." << std::endl;
+
+        return failed == 0 ? 0 : -1;
+    }
+
+    if (options.batch)
+    {
+        const auto inputCount = options.files.size() - 1;
+        FileLogger fileLogger(options.files.back(), options.logOptions);
+        fileLogger.SetLevel(options.logLevel);
+
+        std::vector<CommandProgram> programs(inputCount);
+        for (size_t idx = 0; idx < inputCount; idx++)
+        {
+            if (!programs[idx].TryCompileFile(options.files[idx]))
+            {
+                fileLogger.Error("Unable to open the input file: " + options.files[idx]);
+                return -1;
+            }
+        }
+
+        LockstepRunner runner;
+        std::vector<std::vector<std::string>> reports;
+        runner.Run(programs, reports);
+
+        for (size_t idx = 0; idx < inputCount; idx++)
+        {
+            for (const auto& report : reports[idx])
+                fileLogger.Output(options.files[idx] + " " + report);
+        }
+
+        return 0;
+    }
+
+    if (!options.server.address.empty())
+        return Serve(options);
 
-        FileLogger fileLogger(outputFile);
-        ToyRobot robot(fileLogger);
+    if (options.convert)
+        return Convert(options);
 
-        FileCommander commander(inputFile, robot, fileLogger);
-        commander.Launch();
+    if (!options.files.empty() && IsTrbFile(options.files[0]) && !TryApplyTrbBoard(options, error))
+    {
+        std::cout << error << std::endl;
+        return -1;
     }
-    else
+
+    if (options.compose)
     {
-        ConsoleLogger logger;
-        ToyRobot robot(logger);
+        TransitionRunner runner(options.threads, options.logLevel, options.lazy);
+        if (!runner.TryRun(options.files[0], options.files[1], error))
+        {
+            std::cout << error << std::endl;
+            return -1;
+        }
 
-        ConsoleCommander commander(robot, logger);
-        commander.Launch();
+        return 0;
     }
 
-    return 0;
+    if (!options.obstacleMap.empty())
+        return RunWithObstacles(options);
+
+    if (options.IsDefaultBoard())
+        return RunRobot<ToyRobot>(options, DefaultBoard(), NoOccupancy());
+
+    return RunRobot<RuntimeToyRobot>(options, RuntimeBoard(options.boardMaxX, options.boardMaxY), NoOccupancy());
 }
\ No newline at end of file